@@ -0,0 +1,683 @@
+/*
+ * Micro-benchmarks for DynArray and IntList
+ *
+ * Measures push throughput, pop, random access and full traversal for
+ * DynArray (several element sizes, including User), the typed UserArray and
+ * the compact UserTable with arena-backed names,
+ * push/traversal for IntList with malloc'd and pooled nodes and for the
+ * delta-compressed PackedIntList, sorting a
+ * User table by id with qsort versus the sorts in sort.h, building and
+ * probing a HashIndex, ordered inserts and lookups in a SkipList, pushes
+ * and snapshot-then-write rounds on a CowDynArray, and loading a file of
+ * Users one fread at a time versus with the streaming loader.
+ * Results are written as CSV to stdout:
+ *
+ *   container,op,elem_size,n,ns_per_op,bytes_per_elem,allocs
+ *
+ * bytes_per_elem is the live heap footprint requested by the container divided
+ * by n; allocs counts alloc/realloc calls made by the container during the
+ * operation. Both come from a CountingAllocator plugged into every container.
+ *
+ * Build and run:
+ *   cc -O2 -pthread -o bench/bench bench/bench.c
+ *   ./bench/bench [max_n] [max_mib]
+ *
+ * Sizes go from 1e3 up to max_n (default 1e8) in powers of ten; any case whose
+ * data would exceed max_mib MiB (default 2048) is skipped.
+ *
+ * Key concepts demonstrated:
+ * - Counting allocations through the pluggable Allocator interface
+ * - Monotonic clock timing
+ * - Defeating dead-code elimination with a volatile sink
+ */
+
+#define _POSIX_C_SOURCE 200112L
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "../ds/allocator.h"
+#include "../ds/cow_array.h"
+#include "../ds/dyn_array.h"
+#include "../ds/hash_index.h"
+#include "../ds/linked_list.h"
+#include "../ds/packed_list.h"
+#include "../ds/serialize.h"
+#include "../ds/skip_list.h"
+#include "../ds/sort.h"
+#include "../ds/stream_loader.h"
+#include "../ds/user.h"
+#include "../ds/user_table.h"
+
+/* Every container allocates through this, so its stats attribute all memory */
+static CountingAllocator counting;
+
+/* Allocation calls of any kind made so far */
+#define ALLOC_CALLS (counting.stats.allocs + counting.stats.reallocs)
+
+/* Sink for computed values so the compiler cannot drop the measured loops */
+static volatile uint64_t sink;
+
+/* Largest element size benchmarked for the generic DynArray */
+#define MAX_ELEM_SIZE 256
+
+/**
+ * Returns a monotonic timestamp in nanoseconds.
+ */
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * Small, fast PRNG for random access patterns (xorshift64).
+ */
+static uint64_t next_random(uint64_t* state) {
+    uint64_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    *state = x;
+    return x;
+}
+
+/**
+ * Prints one CSV result row.
+ */
+static void report(const char* container, const char* op, size_t elem_size, size_t n,
+                   uint64_t elapsed_ns, size_t live_bytes, size_t allocs) {
+    printf("%s,%s,%zu,%zu,%.3f,%.2f,%zu\n", container, op, elem_size, n,
+           (double)elapsed_ns / (double)n, (double)live_bytes / (double)n, allocs);
+    fflush(stdout);
+}
+
+/**
+ * Benchmarks the generic DynArray for one element size and count.
+ */
+static void bench_dyn_array(size_t elem_size, size_t n) {
+    unsigned char elem[MAX_ELEM_SIZE];
+    memset(elem, 0xab, sizeof(elem));
+
+    DynArrayOptions options = DYN_ARRAY_DEFAULT_OPTIONS;
+    options.allocator = &counting.base;
+    DynArray array;
+    init_dyn_array(elem_size, &options, &array);
+
+    /* push: grow from the default capacity */
+    size_t allocs_before = ALLOC_CALLS;
+    uint64_t start = now_ns();
+    for (size_t i = 0; i < n; ++i) {
+        memcpy(elem, &i, sizeof(uint32_t) < elem_size ? sizeof(uint32_t) : elem_size);
+        push_dyn_array(&array, elem);
+    }
+    uint64_t elapsed = now_ns() - start;
+    report("DynArray", "push", elem_size, n, elapsed, counting.stats.live_bytes, ALLOC_CALLS - allocs_before);
+
+    /* random_access: read the first byte of n randomly chosen elements */
+    uint64_t rng = 0x9e3779b97f4a7c15u;
+    uint64_t sum = 0;
+    start = now_ns();
+    for (size_t i = 0; i < n; ++i) {
+        size_t idx = (size_t)(next_random(&rng) % n);
+        sum += *((unsigned char*)array.items + array.size * idx);
+    }
+    elapsed = now_ns() - start;
+    sink += sum;
+    report("DynArray", "random_access", elem_size, n, elapsed, counting.stats.live_bytes, 0);
+
+    /* traverse: sequential scan in index order */
+    sum = 0;
+    start = now_ns();
+    for (size_t i = 0; i < array.count; ++i) {
+        sum += *((unsigned char*)array.items + array.size * i);
+    }
+    elapsed = now_ns() - start;
+    sink += sum;
+    report("DynArray", "traverse", elem_size, n, elapsed, counting.stats.live_bytes, 0);
+
+    /* pop: drain the array, copying each element out */
+    start = now_ns();
+    while (pop_dyn_array(&array, elem)) {
+    }
+    elapsed = now_ns() - start;
+    sink += elem[0];
+    report("DynArray", "pop", elem_size, n, elapsed, counting.stats.live_bytes, 0);
+
+    free_dyn_array(&array);
+}
+
+/**
+ * Benchmarks the typed UserArray, for comparison with DynArray of User.
+ */
+static void bench_user_array(size_t n) {
+    UserArray array;
+    UserArray_init(&array);
+    array.allocator = &counting.base;
+    User user = {"user", 0};
+
+    size_t allocs_before = ALLOC_CALLS;
+    uint64_t start = now_ns();
+    for (size_t i = 0; i < n; ++i) {
+        user.id = (short)i;
+        UserArray_push(&array, user);
+    }
+    uint64_t elapsed = now_ns() - start;
+    report("UserArray", "push", sizeof(User), n, elapsed, counting.stats.live_bytes, ALLOC_CALLS - allocs_before);
+
+    uint64_t rng = 0x9e3779b97f4a7c15u;
+    uint64_t sum = 0;
+    start = now_ns();
+    for (size_t i = 0; i < n; ++i) {
+        sum += (uint64_t)UserArray_at(&array, (size_t)(next_random(&rng) % n))->id;
+    }
+    elapsed = now_ns() - start;
+    sink += sum;
+    report("UserArray", "random_access", sizeof(User), n, elapsed, counting.stats.live_bytes, 0);
+
+    sum = 0;
+    start = now_ns();
+    for (size_t i = 0; i < array.count; ++i) {
+        sum += (uint64_t)array.items[i].id;
+    }
+    elapsed = now_ns() - start;
+    sink += sum;
+    report("UserArray", "traverse", sizeof(User), n, elapsed, counting.stats.live_bytes, 0);
+
+    start = now_ns();
+    while (UserArray_pop(&array, &user)) {
+    }
+    elapsed = now_ns() - start;
+    sink += (uint64_t)user.id;
+    report("UserArray", "pop", sizeof(User), n, elapsed, counting.stats.live_bytes, 0);
+
+    UserArray_free(&array);
+}
+
+/**
+ * Benchmarks UserTable (12-byte records, interned names), for comparison with UserArray.
+ */
+static void bench_user_table(size_t n) {
+    UserTable table;
+    init_user_table(&table, 1, &counting.base);
+    /* A few thousand distinct names, as in a table of real first names */
+    static char names[4096][16];
+    static size_t lens[4096];
+    for (size_t i = 0; i < 4096; ++i) {
+        lens[i] = (size_t)snprintf(names[i], sizeof(names[i]), "user%zu", i);
+    }
+
+    size_t allocs_before = ALLOC_CALLS;
+    uint64_t start = now_ns();
+    for (size_t i = 0; i < n; ++i) {
+        push_user_table(&table, names[i % 4096], lens[i % 4096], (short)i);
+    }
+    uint64_t elapsed = now_ns() - start;
+    report("UserTable", "push", sizeof(CompactUser), n, elapsed, counting.stats.live_bytes, ALLOC_CALLS - allocs_before);
+
+    uint64_t sum = 0;
+    start = now_ns();
+    for (size_t i = 0; i < count_user_table(&table); ++i) {
+        sum += (uint64_t)at_user_table(&table, i)->id;
+    }
+    elapsed = now_ns() - start;
+    sink += sum;
+    report("UserTable", "traverse", sizeof(CompactUser), n, elapsed, counting.stats.live_bytes, 0);
+
+    free_user_table(&table);
+}
+
+static int sum_user_ids(DynArray* chunk, void* ctx) {
+    const User* users = chunk->items;
+    uint64_t sum = 0;
+    for (size_t i = 0; i < chunk->count; ++i) {
+        sum += (uint64_t)users[i].id;
+    }
+    *(uint64_t*)ctx += sum;
+    return 1;
+}
+
+/**
+ * Benchmarks loading n Users written by write_dyn_array: fread and
+ * push_dyn_array per record, then the streaming loader collecting everything,
+ * then the streaming loader handing chunks to a callback. The file has just
+ * been written, so all three read from a warm page cache.
+ */
+static void bench_stream_loader(size_t n) {
+    const char* path = "/tmp/ds_bench_stream.bin";
+    DynArrayOptions options = DYN_ARRAY_DEFAULT_OPTIONS;
+    options.allocator = &counting.base;
+    DynArray users;
+    init_dyn_array(sizeof(User), &options, &users);
+    reserve_dyn_array(&users, n);
+    for (size_t i = 0; i < n; ++i) {
+        User user = {"user", (short)i};
+        push_dyn_array(&users, &user);
+    }
+    FILE* file = fopen(path, "wb");
+    if (file == NULL || !write_dyn_array(file, &users)) {
+        if (file != NULL) {
+            fclose(file);
+        }
+        free_dyn_array(&users);
+        return;
+    }
+    fclose(file);
+    free_dyn_array(&users);
+
+    init_dyn_array(sizeof(User), &options, &users);
+    file = fopen(path, "rb");
+    SerialHeader header;
+    User user;
+    size_t allocs_before = ALLOC_CALLS;
+    uint64_t start = now_ns();
+    if (fread(&header, sizeof(header), 1, file) == 1) {
+        while (fread(&user, sizeof(user), 1, file) == 1) {
+            push_dyn_array(&users, &user);
+        }
+    }
+    uint64_t elapsed = now_ns() - start;
+    fclose(file);
+    sink += users.count;
+    report("StreamLoader", "fread_push", sizeof(User), n, elapsed, counting.stats.live_bytes, ALLOC_CALLS - allocs_before);
+    users.count = 0;
+    free_dyn_array(&users);
+
+    init_dyn_array(sizeof(User), &options, &users);
+    int fd = open(path, O_RDONLY);
+    allocs_before = ALLOC_CALLS;
+    start = now_ns();
+    stream_serialized_dyn_array(fd, &users, 0, NULL, NULL);
+    elapsed = now_ns() - start;
+    close(fd);
+    sink += users.count;
+    report("StreamLoader", "stream", sizeof(User), n, elapsed, counting.stats.live_bytes, ALLOC_CALLS - allocs_before);
+    free_dyn_array(&users);
+
+    /* Only one block's worth of records is ever held, whatever n is */
+    init_dyn_array(sizeof(User), &options, &users);
+    uint64_t sum = 0;
+    fd = open(path, O_RDONLY);
+    allocs_before = ALLOC_CALLS;
+    start = now_ns();
+    stream_serialized_dyn_array(fd, &users, 0, sum_user_ids, &sum);
+    elapsed = now_ns() - start;
+    close(fd);
+    sink += sum;
+    report("StreamLoader", "stream_chunks", sizeof(User), n, elapsed, counting.stats.live_bytes, ALLOC_CALLS - allocs_before);
+    free_dyn_array(&users);
+    remove(path);
+}
+
+static int compare_user_ids(const void* a, const void* b) {
+    short x = ((const User*)a)->id;
+    short y = ((const User*)b)->id;
+    return (x > y) - (x < y);
+}
+
+static inline int user_id_less(const User* a, const User* b) {
+    return a->id < b->id;
+}
+
+DEFINE_DYN_ARRAY_SORT(User, user_id_less)
+
+/**
+ * Benchmarks sorting n shuffled Users by id: qsort, sort_dyn_array with the
+ * same comparator, radix sort on the id field, and the typed UserArray sort.
+ * Every run starts from the same shuffled copy.
+ */
+static void bench_sort_users(size_t n) {
+    DynArray shuffled;
+    new_dyn_array(sizeof(User), &shuffled);
+    reserve_dyn_array(&shuffled, n);
+    uint64_t rng = 0x9e3779b97f4a7c15u;
+    for (size_t i = 0; i < n; ++i) {
+        User user = {"user", (short)next_random(&rng)};
+        push_dyn_array(&shuffled, &user);
+    }
+
+    DynArray work;
+    new_dyn_array(sizeof(User), &work);
+    reserve_dyn_array(&work, n);
+    work.count = n;
+
+    memcpy(work.items, shuffled.items, n * sizeof(User));
+    uint64_t start = now_ns();
+    qsort(work.items, n, sizeof(User), compare_user_ids);
+    report("DynArray", "sort_qsort", sizeof(User), n, now_ns() - start, 0, 0);
+
+    memcpy(work.items, shuffled.items, n * sizeof(User));
+    start = now_ns();
+    sort_dyn_array(&work, compare_user_ids);
+    report("DynArray", "sort_introsort", sizeof(User), n, now_ns() - start, 0, 0);
+
+    memcpy(work.items, shuffled.items, n * sizeof(User));
+    start = now_ns();
+    RADIX_SORT_DYN_ARRAY_BY(&work, User, id);
+    report("DynArray", "sort_radix", sizeof(User), n, now_ns() - start, 0, 0);
+
+    /* Borrow the buffer as a UserArray; it is still owned (and freed) by work */
+    memcpy(work.items, shuffled.items, n * sizeof(User));
+    UserArray typed = {work.items, n, work.cap, NULL};
+    start = now_ns();
+    UserArray_sort(&typed);
+    report("UserArray", "sort_introsort", sizeof(User), n, now_ns() - start, 0, 0);
+    sink += (uint64_t)typed.items[n / 2].id;
+
+    free_dyn_array(&work);
+    free_dyn_array(&shuffled);
+}
+
+/**
+ * Benchmarks a HashIndex over n 16-byte elements keyed by their first 8 bytes:
+ * bulk build, then n random successful and n unsuccessful lookups.
+ */
+static void bench_hash_index(size_t n) {
+    DynArray array;
+    new_dyn_array(16, &array);
+    reserve_dyn_array(&array, n);
+    for (uint64_t i = 0; i < n; ++i) {
+        uint64_t elem[2] = {i * 2, i};   /* Even keys, so odd keys miss */
+        push_dyn_array(&array, elem);
+    }
+
+    HashIndex index;
+    init_hash_index(&index, &array, 0, sizeof(uint64_t), &counting.base);
+    size_t allocs_before = ALLOC_CALLS;
+    uint64_t start = now_ns();
+    build_hash_index(&index);
+    uint64_t elapsed = now_ns() - start;
+    report("HashIndex", "build", 16, n, elapsed, counting.stats.live_bytes, ALLOC_CALLS - allocs_before);
+
+    uint64_t rng = 0x9e3779b97f4a7c15u;
+    uint64_t sum = 0;
+    start = now_ns();
+    for (size_t i = 0; i < n; ++i) {
+        sum += find_hash_index(&index, (next_random(&rng) % n) * 2);
+    }
+    elapsed = now_ns() - start;
+    report("HashIndex", "lookup_hit", 16, n, elapsed, counting.stats.live_bytes, 0);
+
+    start = now_ns();
+    for (size_t i = 0; i < n; ++i) {
+        sum += find_hash_index(&index, (next_random(&rng) % n) * 2 + 1);
+    }
+    elapsed = now_ns() - start;
+    sink += sum;
+    report("HashIndex", "lookup_miss", 16, n, elapsed, counting.stats.live_bytes, 0);
+
+    free_hash_index(&index);
+    free_dyn_array(&array);
+}
+
+/**
+ * Benchmarks CowDynArray of ints: plain pushes, then rounds of taking a
+ * snapshot and overwriting one random element (which copies its chunk and path).
+ */
+static void bench_cow_array(size_t n) {
+    CowDynArray array;
+    init_cow_array(&array, sizeof(int), 0, &counting.base);
+
+    size_t allocs_before = ALLOC_CALLS;
+    uint64_t start = now_ns();
+    for (size_t i = 0; i < n; ++i) {
+        int v = (int)i;
+        push_cow_array(&array, &v);
+    }
+    uint64_t elapsed = now_ns() - start;
+    report("CowDynArray", "push", sizeof(int), n, elapsed, counting.stats.live_bytes, ALLOC_CALLS - allocs_before);
+
+    /* Each round copies a 4 KiB chunk, so only run it up to 1e6 rounds */
+    if (n <= 1000000) {
+        uint64_t rng = 0x9e3779b97f4a7c15u;
+        allocs_before = ALLOC_CALLS;
+        start = now_ns();
+        for (size_t i = 0; i < n; ++i) {
+            CowDynArray snapshot;
+            snapshot_cow_array(&array, &snapshot);
+            int v = -(int)i;
+            set_cow_array(&array, (size_t)(next_random(&rng) % n), &v);
+            free_cow_array(&snapshot);
+        }
+        elapsed = now_ns() - start;
+        report("CowDynArray", "snapshot_set", sizeof(int), n, elapsed, counting.stats.live_bytes, ALLOC_CALLS - allocs_before);
+    }
+
+    free_cow_array(&array);
+}
+
+/**
+ * Benchmarks SkipList with random ordered inserts, lookups and removals.
+ */
+static void bench_skip_list(size_t n) {
+    IntNodePool pool;
+    init_int_node_pool(&pool, 0);
+    pool.allocator = &counting.base;
+    SkipList list;
+    if (!init_skip_list(&list, &pool, 1)) {
+        return;
+    }
+
+    /* Even values in a random order, so odd values miss */
+    uint64_t rng = 0x9e3779b97f4a7c15u;
+    size_t allocs_before = ALLOC_CALLS;
+    uint64_t start = now_ns();
+    for (size_t i = 0; i < n; ++i) {
+        insert_skip_list(&list, (int)(next_random(&rng) % n) * 2);
+    }
+    uint64_t elapsed = now_ns() - start;
+    report("SkipList", "insert", sizeof(IntNode), n, elapsed, counting.stats.live_bytes, ALLOC_CALLS - allocs_before);
+
+    size_t found = 0;
+    start = now_ns();
+    for (size_t i = 0; i < n; ++i) {
+        found += find_skip_list(&list, (int)(next_random(&rng) % n) * 2) != NULL;
+    }
+    elapsed = now_ns() - start;
+    report("SkipList", "find", sizeof(IntNode), n, elapsed, counting.stats.live_bytes, 0);
+
+    start = now_ns();
+    for (size_t i = 0; i < n; ++i) {
+        found += (size_t)remove_skip_list(&list, (int)(next_random(&rng) % n) * 2);
+    }
+    elapsed = now_ns() - start;
+    sink += found;
+    report("SkipList", "remove", sizeof(IntNode), n, elapsed, counting.stats.live_bytes, 0);
+
+    free_skip_list(&list);
+    free_int_node_pool(&pool);
+}
+
+/* Accumulator for the process_list callback (NodeFn carries no context) */
+static uint64_t node_sum;
+
+static void sum_node(IntNode* node) {
+    node_sum += (uint64_t)node->value;
+}
+
+static int sum_node_ctx(IntNode* node, void* ctx) {
+    *(uint64_t*)ctx += (uint64_t)node->value;
+    return NODE_VISIT_CONTINUE;
+}
+
+/* Batch callback for process_list_values */
+static void sum_values(const int* values, size_t n, void* ctx) {
+    long long sum = 0;
+    for (size_t i = 0; i < n; ++i) {
+        sum += values[i];
+    }
+    *(long long*)ctx += sum;
+}
+
+/**
+ * Times process_list, visit_list, batched traversal and linearize_list over an
+ * already built list.
+ */
+static void bench_list_traversal(const char* container, IntList* list, size_t n) {
+    node_sum = 0;
+    uint64_t start = now_ns();
+    process_list(list->head, sum_node);
+    uint64_t elapsed = now_ns() - start;
+    sink += node_sum;
+    report(container, "process_list", sizeof(IntNode), n, elapsed, counting.stats.live_bytes, 0);
+
+    uint64_t sum = 0;
+    start = now_ns();
+    visit_list(list->head, sum_node_ctx, &sum);
+    elapsed = now_ns() - start;
+    sink += sum;
+    report(container, "visit_list", sizeof(IntNode), n, elapsed, counting.stats.live_bytes, 0);
+
+    long long batch_sum = 0;
+    start = now_ns();
+    process_list_values(list->head, sum_values, &batch_sum);
+    elapsed = now_ns() - start;
+    sink += (uint64_t)batch_sum;
+    report(container, "process_list_values", sizeof(IntNode), n, elapsed, counting.stats.live_bytes, 0);
+
+    DynArray values;
+    new_dyn_array(sizeof(int), &values);
+    start = now_ns();
+    linearize_list(list, &values);
+    elapsed = now_ns() - start;
+    sink += values.count;
+    report(container, "linearize", sizeof(IntNode), n, elapsed, counting.stats.live_bytes, 0);
+    free_dyn_array(&values);
+}
+
+/**
+ * Benchmarks IntList with one malloc per node.
+ */
+static void bench_int_list(size_t n) {
+    IntList list = {NULL, NULL, &counting.base};
+
+    size_t allocs_before = ALLOC_CALLS;
+    uint64_t start = now_ns();
+    for (size_t i = 0; i < n; ++i) {
+        push_node(&list, (int)i);
+    }
+    uint64_t elapsed = now_ns() - start;
+    report("IntList", "push", sizeof(IntNode), n, elapsed, counting.stats.live_bytes, ALLOC_CALLS - allocs_before);
+
+    bench_list_traversal("IntList", &list, n);
+
+    start = now_ns();
+    free_list(&list);
+    elapsed = now_ns() - start;
+    report("IntList", "free", sizeof(IntNode), n, elapsed, counting.stats.live_bytes, 0);
+}
+
+/**
+ * Benchmarks IntList with nodes from an IntNodePool, including reuse after release.
+ */
+static void bench_pooled_list(size_t n) {
+    IntNodePool pool;
+    init_int_node_pool(&pool, 0);
+    pool.allocator = &counting.base;
+    IntList list = {NULL, NULL, NULL};
+
+    size_t allocs_before = ALLOC_CALLS;
+    uint64_t start = now_ns();
+    for (size_t i = 0; i < n; ++i) {
+        push_node_pooled(&pool, &list, (int)i);
+    }
+    uint64_t elapsed = now_ns() - start;
+    report("PooledIntList", "push", sizeof(IntNode), n, elapsed, counting.stats.live_bytes, ALLOC_CALLS - allocs_before);
+
+    bench_list_traversal("PooledIntList", &list, n);
+
+    /* Release and rebuild: the second build is served from the free list */
+    release_list_pooled(&pool, &list);
+    allocs_before = ALLOC_CALLS;
+    start = now_ns();
+    for (size_t i = 0; i < n; ++i) {
+        push_node_pooled(&pool, &list, (int)i);
+    }
+    elapsed = now_ns() - start;
+    report("PooledIntList", "push_reuse", sizeof(IntNode), n, elapsed, counting.stats.live_bytes, ALLOC_CALLS - allocs_before);
+
+    release_list_pooled(&pool, &list);
+    free_int_node_pool(&pool);
+}
+
+/**
+ * Benchmarks PackedIntList on a sorted id list with small gaps.
+ */
+static void bench_packed_list(size_t n) {
+    PackedIntList list;
+    init_packed_list(&list, &counting.base);
+
+    size_t allocs_before = ALLOC_CALLS;
+    uint64_t start = now_ns();
+    for (size_t i = 0; i < n; ++i) {
+        push_packed_list(&list, (int)i * 4);
+    }
+    uint64_t elapsed = now_ns() - start;
+    report("PackedIntList", "push", sizeof(int), n, elapsed, counting.stats.live_bytes, ALLOC_CALLS - allocs_before);
+
+    long long sum = 0;
+    start = now_ns();
+    process_packed_list(&list, sum_values, &sum);
+    elapsed = now_ns() - start;
+    sink += (uint64_t)sum;
+    report("PackedIntList", "process_values", sizeof(int), n, elapsed, counting.stats.live_bytes, 0);
+
+    uint64_t rng = 0x9e3779b97f4a7c15u;
+    start = now_ns();
+    for (size_t i = 0; i < n; ++i) {
+        PackedIntIter it;
+        int value;
+        sum += seek_packed_iter(&list, &it, (int)(next_random(&rng) % n) * 4, &value) ? value : 0;
+    }
+    elapsed = now_ns() - start;
+    sink += (uint64_t)sum;
+    report("PackedIntList", "seek", sizeof(int), n, elapsed, counting.stats.live_bytes, 0);
+
+    free_packed_list(&list);
+}
+
+int main(int argc, char** argv) {
+    size_t max_n = argc > 1 ? (size_t)strtoull(argv[1], NULL, 10) : 100000000u;
+    size_t max_bytes = (argc > 2 ? (size_t)strtoull(argv[2], NULL, 10) : 2048u) * 1024 * 1024;
+    const size_t elem_sizes[] = {4, 16, sizeof(User), 128, MAX_ELEM_SIZE};
+
+    init_counting_allocator(&counting, NULL);
+
+    printf("container,op,elem_size,n,ns_per_op,bytes_per_elem,allocs\n");
+    for (size_t n = 1000; n <= max_n; n *= 10) {
+        for (size_t i = 0; i < sizeof(elem_sizes) / sizeof(elem_sizes[0]); ++i) {
+            /* Worst case during growth is old + new buffer at 2x: ~3x the data */
+            if (elem_sizes[i] * n * 3 <= max_bytes) {
+                bench_dyn_array(elem_sizes[i], n);
+            }
+        }
+        if (sizeof(User) * n * 3 <= max_bytes) {
+            bench_user_array(n);
+            bench_user_table(n);
+            bench_sort_users(n);
+        }
+        /* The file is as large as the data, so keep it to a few hundred MiB */
+        if (sizeof(User) * n * 3 <= max_bytes && n <= 10000000u) {
+            bench_stream_loader(n);
+        }
+        /* Elements plus a table of up to 2 slots of 16 bytes per element */
+        if (48 * n <= max_bytes) {
+            bench_hash_index(n);
+        }
+        if (sizeof(int) * n * 2 <= max_bytes) {
+            bench_cow_array(n);
+        }
+        /* malloc'd nodes cost at least 32 bytes each including allocator overhead */
+        if (32 * n <= max_bytes) {
+            bench_int_list(n);
+            bench_pooled_list(n);
+            bench_skip_list(n);
+            bench_packed_list(n);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,196 @@
+/*
+ * Pluggable Allocator Interface
+ *
+ * Every container in ds/ allocates through an Allocator: a set of function
+ * pointers plus a context pointer. A NULL Allocator* means the C library
+ * (malloc/realloc/free), so containers that never set one behave as before.
+ *
+ * Custom allocators (e.g. jemalloc arenas via mallocx/MALLOCX_ARENA stored in
+ * ctx) can be plugged in per container without recompiling, and the
+ * CountingAllocator wraps any allocator to attribute memory to a container.
+ *
+ * Key concepts demonstrated:
+ * - Function pointer tables with a context pointer (C-style interfaces)
+ * - Sized deallocation, so wrappers can account bytes without allocator queries
+ * - Decorating one allocator with another
+ */
+
+#ifndef DS_ALLOCATOR_H
+#define DS_ALLOCATOR_H
+
+#include <stdlib.h>
+
+/**
+ * Allocator interface.
+ * Sizes are passed back on realloc and free so implementations need not track them.
+ */
+typedef struct {
+    /* Allocates size bytes aligned to align (0 = default malloc alignment) */
+    void* (*alloc)(void* ctx, size_t size, size_t align);
+    /* Resizes a block allocated with default alignment, keeping it on failure */
+    void* (*realloc)(void* ctx, void* ptr, size_t old_size, size_t new_size);
+    /* Releases a block; size is the size it was allocated or last resized with */
+    void (*free)(void* ctx, void* ptr, size_t size);
+    void* ctx;  /* Opaque state passed to every call */
+} Allocator;
+
+/**
+ * Allocates memory through an allocator, or malloc/aligned_alloc if it is NULL.
+ *
+ * @param allocator Allocator to use, or NULL for the C library
+ * @param size Number of bytes to allocate
+ * @param align Required alignment, a power of two (0 = default)
+ * @return Pointer to the block, or NULL on failure
+ */
+static inline void* allocate(const Allocator* allocator, size_t size, size_t align) {
+    if (allocator != NULL) {
+        return allocator->alloc(allocator->ctx, size, align);
+    }
+    if (align == 0) {
+        return malloc(size);
+    }
+    /* aligned_alloc requires the size to be a multiple of the alignment */
+    return aligned_alloc(align, (size + align - 1) / align * align);
+}
+
+/**
+ * Resizes memory through an allocator, or realloc if it is NULL.
+ *
+ * @param allocator Allocator to use, or NULL for the C library
+ * @param ptr Block to resize (NULL allocates a new one)
+ * @param old_size Current size of the block in bytes
+ * @param new_size Requested size in bytes
+ * @return Pointer to the resized block, or NULL on failure (ptr stays valid)
+ */
+static inline void* reallocate(const Allocator* allocator, void* ptr, size_t old_size, size_t new_size) {
+    if (allocator != NULL) {
+        return allocator->realloc(allocator->ctx, ptr, old_size, new_size);
+    }
+    return realloc(ptr, new_size);
+}
+
+/**
+ * Resizes memory like reallocate and reports whether the block moved, i.e.
+ * whether its contents were copied to a new address rather than resized in
+ * place. The only use of ptr after the call is an equality test, so callers
+ * never touch the old block themselves.
+ *
+ * @param allocator Allocator to use, or NULL for the C library
+ * @param ptr Block to resize (NULL allocates a new one, which counts as not moved)
+ * @param old_size Current size of the block in bytes
+ * @param new_size Requested size in bytes
+ * @param moved Set to 1 if the block moved, 0 otherwise; untouched on failure
+ * @return Pointer to the resized block, or NULL on failure (ptr stays valid)
+ */
+static inline void* reallocate_moved(const Allocator* allocator, void* ptr, size_t old_size, size_t new_size,
+                                     int* moved) {
+    int had_block = ptr != NULL;
+    void* new_ptr = reallocate(allocator, ptr, old_size, new_size);
+    if (new_ptr != NULL) {
+        *moved = had_block && new_ptr != ptr;
+    }
+    return new_ptr;
+}
+
+/**
+ * Releases memory through an allocator, or free if it is NULL.
+ *
+ * @param allocator Allocator the block came from, or NULL for the C library
+ * @param ptr Block to release (NULL is ignored)
+ * @param size Size of the block in bytes
+ */
+static inline void deallocate(const Allocator* allocator, void* ptr, size_t size) {
+    if (ptr == NULL) {
+        return;
+    }
+    if (allocator != NULL) {
+        allocator->free(allocator->ctx, ptr, size);
+        return;
+    }
+    free(ptr);
+}
+
+/**
+ * Counters maintained by a CountingAllocator.
+ */
+typedef struct {
+    size_t bytes_allocated;  /* Total bytes ever requested (allocs + realloc growth) */
+    size_t live_bytes;       /* Bytes currently allocated */
+    size_t peak_bytes;       /* Highest value live_bytes has reached */
+    size_t allocs;           /* Number of alloc calls */
+    size_t reallocs;         /* Number of realloc calls */
+    size_t frees;            /* Number of free calls */
+    size_t bytes_copied;     /* Bytes moved by reallocs that could not resize in place */
+} AllocStats;
+
+/**
+ * Allocator decorator that forwards to a parent allocator and keeps AllocStats.
+ * Use &counting.base wherever an Allocator* is expected.
+ */
+typedef struct {
+    Allocator base;           /* Interface handed to containers, ctx points back here */
+    const Allocator* parent;  /* Allocator doing the actual work, NULL for the C library */
+    AllocStats stats;         /* Counters, updated on every call */
+} CountingAllocator;
+
+static inline void note_live_bytes(AllocStats* stats) {
+    if (stats->live_bytes > stats->peak_bytes) {
+        stats->peak_bytes = stats->live_bytes;
+    }
+}
+
+static inline void* counting_alloc(void* ctx, size_t size, size_t align) {
+    CountingAllocator* counting = ctx;
+    void* ptr = allocate(counting->parent, size, align);
+    if (ptr != NULL) {
+        counting->stats.allocs++;
+        counting->stats.bytes_allocated += size;
+        counting->stats.live_bytes += size;
+        note_live_bytes(&counting->stats);
+    }
+    return ptr;
+}
+
+static inline void* counting_realloc(void* ctx, void* ptr, size_t old_size, size_t new_size) {
+    CountingAllocator* counting = ctx;
+    int moved = 0;
+    void* new_ptr = reallocate_moved(counting->parent, ptr, old_size, new_size, &moved);
+    if (new_ptr != NULL) {
+        counting->stats.reallocs++;
+        if (new_size > old_size) {
+            counting->stats.bytes_allocated += new_size - old_size;
+        }
+        /* A moved block means the old contents were copied over */
+        if (moved) {
+            counting->stats.bytes_copied += old_size < new_size ? old_size : new_size;
+        }
+        counting->stats.live_bytes += new_size;
+        counting->stats.live_bytes -= old_size;
+        note_live_bytes(&counting->stats);
+    }
+    return new_ptr;
+}
+
+static inline void counting_free(void* ctx, void* ptr, size_t size) {
+    CountingAllocator* counting = ctx;
+    counting->stats.frees++;
+    counting->stats.live_bytes -= size;
+    deallocate(counting->parent, ptr, size);
+}
+
+/**
+ * Initializes a counting allocator with zeroed stats.
+ *
+ * @param counting Pointer to caller-allocated CountingAllocator
+ * @param parent Allocator to forward to, or NULL for the C library
+ */
+static inline void init_counting_allocator(CountingAllocator* counting, const Allocator* parent) {
+    counting->base.alloc = counting_alloc;
+    counting->base.realloc = counting_realloc;
+    counting->base.free = counting_free;
+    counting->base.ctx = counting;
+    counting->parent = parent;
+    counting->stats = (AllocStats){0, 0, 0, 0, 0, 0, 0};
+}
+
+#endif /* DS_ALLOCATOR_H */
@@ -0,0 +1,101 @@
+/*
+ * Concurrent Append-Only Array Example
+ *
+ * This file demonstrates several writer threads appending log records to one
+ * shared array while a reader thread scans what has been published so far.
+ * The implementation supports:
+ *
+ * - Lock-free push from many threads via atomic slot reservation
+ * - Segmented growth, so element pointers never move
+ * - Reading the published prefix while writers are still running
+ *
+ * Key concepts demonstrated:
+ * - fetch-add as a slot allocator
+ * - Per-slot ready flags with release/acquire, prefix computed by readers
+ * - Geometric segments addressed with bit tricks
+ *
+ * Build with: cc -pthread ds/concurrent_array.c
+ */
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <threads.h>
+
+#include "concurrent_array.h"
+
+#define WRITERS 4
+#define RECORDS_PER_WRITER 200000
+
+/**
+ * Example log record.
+ */
+typedef struct {
+    int writer;   /* Id of the writing thread */
+    int seq;      /* Sequence number within that writer */
+} LogRecord;
+
+static ConcurrentDynArray records;
+static atomic_int writers_done;
+
+static void* write_records(void* arg) {
+    int writer = *(int*)arg;
+    for (int i = 0; i < RECORDS_PER_WRITER; ++i) {
+        LogRecord record = {writer, i};
+        push_concurrent_array(&records, &record);
+    }
+    atomic_fetch_add(&writers_done, 1);
+    return NULL;
+}
+
+static void count_record(void* elem, size_t idx, void* ctx) {
+    (void)idx;
+    long long* seq_sum = ctx;
+    *seq_sum += ((LogRecord*)elem)->seq;
+}
+
+int main(void) {
+    init_concurrent_array(&records, sizeof(LogRecord), 0, NULL);
+
+    pthread_t threads[WRITERS];
+    int ids[WRITERS];
+    for (int w = 0; w < WRITERS; ++w) {
+        ids[w] = w;
+        pthread_create(&threads[w], NULL, write_records, &ids[w]);
+    }
+
+    /* Follow the published prefix while the writers are still pushing,
+     * reading only what was published since the previous pass */
+    size_t seen = 0;
+    long long live_seq_sum = 0;
+    while (atomic_load(&writers_done) < WRITERS) {
+        size_t published = published_concurrent_array(&records);
+        for (; seen < published; ++seen) {
+            live_seq_sum += ((LogRecord*)at_concurrent_array(&records, seen))->seq;
+        }
+        thrd_yield();
+    }
+
+    for (int w = 0; w < WRITERS; ++w) {
+        pthread_join(threads[w], NULL);
+    }
+
+    /* Catch up on the tail, then check against a full pass */
+    size_t read_while_writing = seen;
+    size_t count = published_concurrent_array(&records);
+    for (; seen < count; ++seen) {
+        live_seq_sum += ((LogRecord*)at_concurrent_array(&records, seen))->seq;
+    }
+    long long seq_sum = 0;
+    for_each_concurrent_array(&records, count_record, &seq_sum);
+    long long expected = (long long)WRITERS * RECORDS_PER_WRITER * (RECORDS_PER_WRITER - 1) / 2;
+    printf("Published %zu records (%zu read while writing)\n", count, read_while_writing);
+    printf("Sequence sum - live reader: %lld, full pass: %lld, expected: %lld\n",
+           live_seq_sum, seq_sum, expected);
+
+    LogRecord* last = at_concurrent_array(&records, count - 1);
+    printf("Last record - writer: %d, seq: %d\n", last->writer, last->seq);
+
+    free_concurrent_array(&records);
+    return 0;
+}
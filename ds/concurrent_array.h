@@ -0,0 +1,262 @@
+/*
+ * Concurrent Append-Only Dynamic Array
+ *
+ * A DynArray variant that many threads can push to at once while readers
+ * iterate the published prefix. Writers reserve a slot with one atomic
+ * fetch-add on the reservation counter, copy their element in, and set the
+ * slot's ready flag, so a writer never waits for another one: a writer
+ * preempted mid-copy only holds back readers, not other pushes. Readers
+ * extend the published prefix themselves by scanning ready flags from the
+ * last known prefix and record the result for the next reader.
+ *
+ * Storage grows by adding segments (each twice the size of the previous
+ * one) rather than by moving the buffer, so a pointer to an element stays
+ * valid for the life of the array and readers never see a buffer being
+ * freed underneath them.
+ *
+ * Element i lives in segment k = floor(log2(i / first_cap + 1)), so
+ * addressing is a count-leading-zeros, a shift and a subtraction. Each
+ * segment ends with one ready byte per element. The allocator, if any,
+ * must be thread-safe. Requires C11 atomics and GCC/Clang builtins.
+ */
+
+#ifndef DS_CONCURRENT_ARRAY_H
+#define DS_CONCURRENT_ARRAY_H
+
+#include <stdatomic.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "allocator.h"
+
+/* Enough segments to address every size_t index for any first_cap >= 1 */
+#define CONCURRENT_ARRAY_MAX_SEGMENTS 64
+#define CONCURRENT_ARRAY_DEFAULT_FIRST_CAP 64
+#define CONCURRENT_ARRAY_PUSH_FAILED ((size_t)-1)
+
+/**
+ * Concurrent append-only array. reserved and published sit on their own
+ * cache lines: every writer touches reserved, readers touch published.
+ */
+typedef struct {
+    _Atomic(void*) segments[CONCURRENT_ARRAY_MAX_SEGMENTS];  /* Segment k holds first_cap << k elements */
+    size_t size;                 /* Size of each element in bytes */
+    unsigned first_shift;        /* log2 of the first segment's capacity */
+    const Allocator* allocator;  /* Thread-safe allocator for segments, NULL for the C library */
+    _Alignas(64) atomic_size_t reserved;   /* Slots handed out to writers */
+    _Alignas(64) atomic_size_t published;  /* Slots [0, published) are known to be ready; grows as readers scan */
+    atomic_int failed;           /* Set once a segment allocation failed, pushes then fail fast */
+} ConcurrentDynArray;
+
+/**
+ * Initializes an empty concurrent array. Not thread-safe; call before sharing.
+ *
+ * @param array Pointer to caller-allocated array
+ * @param size Size of each element in bytes (use sizeof())
+ * @param first_cap Capacity of the first segment, rounded up to a power of two
+ *                  (0 = CONCURRENT_ARRAY_DEFAULT_FIRST_CAP)
+ * @param allocator Thread-safe allocator for segments, or NULL for the C library
+ */
+static inline void init_concurrent_array(ConcurrentDynArray* array, size_t size, size_t first_cap,
+                                         const Allocator* allocator) {
+    if (first_cap == 0) {
+        first_cap = CONCURRENT_ARRAY_DEFAULT_FIRST_CAP;
+    }
+    unsigned shift = 0;
+    while (((size_t)1 << shift) < first_cap) {
+        shift++;
+    }
+
+    for (size_t k = 0; k < CONCURRENT_ARRAY_MAX_SEGMENTS; ++k) {
+        atomic_init(&array->segments[k], NULL);
+    }
+    array->size = size;
+    array->first_shift = shift;
+    array->allocator = allocator;
+    atomic_init(&array->reserved, 0);
+    atomic_init(&array->published, 0);
+    atomic_init(&array->failed, 0);
+}
+
+/**
+ * Maps an element index to its segment and the index within that segment.
+ */
+static inline size_t locate_concurrent_array(const ConcurrentDynArray* array, size_t idx, size_t* offset) {
+    size_t pos = idx + ((size_t)1 << array->first_shift);
+    unsigned top = (unsigned)(sizeof(unsigned long long) * 8 - 1) - (unsigned)__builtin_clzll(pos);
+    size_t segment = top - array->first_shift;
+    *offset = pos - ((size_t)1 << top);
+    return segment;
+}
+
+/**
+ * Returns the number of bytes of segment k: its elements followed by their ready flags.
+ */
+static inline size_t segment_bytes_concurrent_array(const ConcurrentDynArray* array, size_t segment) {
+    return ((array->size + sizeof(atomic_uchar)) << array->first_shift) << segment;
+}
+
+/**
+ * Returns the ready flags of a segment, which follow its elements.
+ */
+static inline atomic_uchar* flags_concurrent_array(const ConcurrentDynArray* array, void* memory, size_t segment) {
+    return (atomic_uchar*)((char*)memory + ((array->size << array->first_shift) << segment));
+}
+
+/**
+ * Returns segment k, allocating it if no thread has yet.
+ * Concurrent allocators race with a compare-and-swap; losers free their copy.
+ *
+ * @return Segment memory, or NULL if the allocation failed
+ */
+static inline void* get_segment_concurrent_array(ConcurrentDynArray* array, size_t segment) {
+    void* memory = atomic_load_explicit(&array->segments[segment], memory_order_acquire);
+    if (memory != NULL) {
+        return memory;
+    }
+
+    size_t bytes = segment_bytes_concurrent_array(array, segment);
+    void* fresh = allocate(array->allocator, bytes, 0);
+    if (fresh == NULL) {
+        return NULL;
+    }
+    /* No slot is ready yet; the release in the CAS below publishes the cleared flags */
+    atomic_uchar* flags = flags_concurrent_array(array, fresh, segment);
+    for (size_t i = 0; i < ((size_t)1 << array->first_shift) << segment; ++i) {
+        atomic_init(&flags[i], 0);
+    }
+    if (!atomic_compare_exchange_strong_explicit(&array->segments[segment], &memory, fresh,
+                                                 memory_order_acq_rel, memory_order_acquire)) {
+        /* Another thread installed the segment first */
+        deallocate(array->allocator, fresh, bytes);
+        return memory;
+    }
+    return fresh;
+}
+
+/**
+ * Appends an element. Safe to call from any number of threads concurrently,
+ * and lock-free: it never waits for another writer. The element becomes part
+ * of the published prefix once every earlier slot is ready too.
+ *
+ * @param array Pointer to the array
+ * @param val Pointer to the element to add
+ * @return Index of the element, or CONCURRENT_ARRAY_PUSH_FAILED if a segment
+ *         could not be allocated (the array then rejects all further pushes)
+ */
+static inline size_t push_concurrent_array(ConcurrentDynArray* array, const void* val) {
+    if (atomic_load_explicit(&array->failed, memory_order_relaxed)) {
+        return CONCURRENT_ARRAY_PUSH_FAILED;
+    }
+
+    /* Claim a slot; nobody else will ever write it */
+    size_t idx = atomic_fetch_add_explicit(&array->reserved, 1, memory_order_relaxed);
+
+    size_t offset;
+    size_t segment = locate_concurrent_array(array, idx, &offset);
+    char* memory = get_segment_concurrent_array(array, segment);
+    if (memory == NULL) {
+        atomic_store_explicit(&array->failed, 1, memory_order_relaxed);
+        return CONCURRENT_ARRAY_PUSH_FAILED;
+    }
+    memcpy(memory + offset * array->size, val, array->size);
+
+    /* Release: a reader that sees the flag also sees the element */
+    atomic_store_explicit(&flags_concurrent_array(array, memory, segment)[offset], 1, memory_order_release);
+    return idx;
+}
+
+/**
+ * Returns the number of published elements: the longest prefix of slots
+ * that are all ready. Elements below it can be read while writers keep
+ * pushing. Scans the ready flags past the last prefix any reader found and
+ * records the new length, so each slot is scanned about once overall.
+ *
+ * @param array Pointer to the array
+ * @return Length of the published prefix
+ */
+static inline size_t published_concurrent_array(ConcurrentDynArray* array) {
+    size_t known = atomic_load_explicit(&array->published, memory_order_acquire);
+    size_t reserved = atomic_load_explicit(&array->reserved, memory_order_relaxed);
+    size_t count = known;
+    while (count < reserved) {
+        size_t offset;
+        size_t segment = locate_concurrent_array(array, count, &offset);
+        void* memory = atomic_load_explicit(&array->segments[segment], memory_order_acquire);
+        if (memory == NULL) {
+            break;
+        }
+        /* Acquire pairs with the writer's release, making the element visible to this thread */
+        atomic_uchar* flags = flags_concurrent_array(array, memory, segment);
+        size_t cap = ((size_t)1 << array->first_shift) << segment;
+        while (offset < cap && count < reserved && atomic_load_explicit(&flags[offset], memory_order_acquire)) {
+            offset++;
+            count++;
+        }
+        if (offset < cap) {
+            break;
+        }
+    }
+    /* Record the longer prefix; release so readers trusting it also see the elements */
+    while (count > known && !atomic_compare_exchange_weak_explicit(&array->published, &known, count,
+                                                                   memory_order_release, memory_order_acquire)) {
+    }
+    return count > known ? count : known;
+}
+
+/**
+ * Returns a stable pointer to element idx.
+ *
+ * @param array Pointer to the array
+ * @param idx Index, must be below a value returned by published_concurrent_array
+ * @return Pointer to the element, valid until the array is freed
+ */
+static inline void* at_concurrent_array(ConcurrentDynArray* array, size_t idx) {
+    size_t offset;
+    size_t segment = locate_concurrent_array(array, idx, &offset);
+    char* memory = atomic_load_explicit(&array->segments[segment], memory_order_relaxed);
+    return memory + offset * array->size;
+}
+
+/**
+ * Calls fn on every element of the published prefix as of the call, walking
+ * whole segments so the inner loop is plain pointer arithmetic.
+ *
+ * @param array Pointer to the array
+ * @param fn Callback receiving each element, its index and ctx
+ * @param ctx Opaque caller state passed to every call
+ * @return Number of elements visited
+ */
+static inline size_t for_each_concurrent_array(ConcurrentDynArray* array,
+                                               void (*fn)(void* elem, size_t idx, void* ctx), void* ctx) {
+    size_t count = published_concurrent_array(array);
+    size_t idx = 0;
+    for (size_t segment = 0; idx < count; ++segment) {
+        char* memory = atomic_load_explicit(&array->segments[segment], memory_order_relaxed);
+        size_t cap = (size_t)1 << (array->first_shift + segment);
+        for (size_t i = 0; i < cap && idx < count; ++i, ++idx) {
+            fn(memory + i * array->size, idx, ctx);
+        }
+    }
+    return count;
+}
+
+/**
+ * Frees every segment. No thread may be using the array.
+ *
+ * @param array Pointer to the array
+ */
+static inline void free_concurrent_array(ConcurrentDynArray* array) {
+    for (size_t k = 0; k < CONCURRENT_ARRAY_MAX_SEGMENTS; ++k) {
+        void* memory = atomic_load_explicit(&array->segments[k], memory_order_relaxed);
+        if (memory != NULL) {
+            deallocate(array->allocator, memory, segment_bytes_concurrent_array(array, k));
+            atomic_store_explicit(&array->segments[k], NULL, memory_order_relaxed);
+        }
+    }
+    atomic_store(&array->reserved, 0);
+    atomic_store(&array->published, 0);
+    atomic_store(&array->failed, 0);
+}
+
+#endif /* DS_CONCURRENT_ARRAY_H */
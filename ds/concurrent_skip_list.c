@@ -0,0 +1,98 @@
+/*
+ * Concurrent Skip List Example
+ *
+ * This file demonstrates several writer threads inserting timestamps into one
+ * shared ordered index while a reader thread runs range queries over it.
+ * The implementation supports:
+ *
+ * - Lock-free ordered insert from many threads
+ * - Lookups and range queries concurrent with the inserts
+ * - Rejecting values that are already present
+ *
+ * Key concepts demonstrated:
+ * - Publishing a fully built node with a single compare-and-swap
+ * - Linking index levels bottom-up and re-searching on contention
+ * - Per-thread random state for node heights
+ *
+ * Build with: cc -pthread ds/concurrent_skip_list.c
+ */
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <threads.h>
+
+#include "concurrent_skip_list.h"
+
+#define WRITERS 4
+#define STAMPS_PER_WRITER 100000
+
+static ConcurrentSkipList index_list;
+static atomic_int writers_done;
+
+/**
+ * Writer: inserts every WRITERS-th timestamp, so the writers interleave
+ * across the whole key range, plus one value another writer also inserts.
+ */
+static void* write_stamps(void* arg) {
+    int writer = *(int*)arg;
+    for (int i = 0; i < STAMPS_PER_WRITER; ++i) {
+        insert_concurrent_skip_list(&index_list, i * WRITERS + writer);
+    }
+    insert_concurrent_skip_list(&index_list, -1);
+    atomic_fetch_add(&writers_done, 1);
+    return NULL;
+}
+
+/**
+ * Example range visitor: counts nodes and checks they arrive in ascending order.
+ * Can be passed as a ConcurrentSkipVisitFn function pointer.
+ */
+static int count_ordered(const ConcurrentSkipNode* node, void* ctx) {
+    long long* state = ctx;   /* state[0] = count, state[1] = previous value, state[2] = order errors */
+    if (state[0] > 0 && node->value <= state[1]) {
+        state[2]++;
+    }
+    state[0]++;
+    state[1] = node->value;
+    return NODE_VISIT_CONTINUE;
+}
+
+int main(void) {
+    if (!init_concurrent_skip_list(&index_list, NULL)) {
+        return 1;
+    }
+
+    pthread_t threads[WRITERS];
+    int ids[WRITERS];
+    for (int w = 0; w < WRITERS; ++w) {
+        ids[w] = w;
+        pthread_create(&threads[w], NULL, write_stamps, &ids[w]);
+    }
+
+    /* Query a window while the writers are still inserting */
+    int queries = 0;
+    long long order_errors = 0;
+    while (atomic_load(&writers_done) < WRITERS) {
+        long long state[3] = {0, 0, 0};
+        range_concurrent_skip_list(&index_list, 1000, 2000, count_ordered, state);
+        order_errors += state[2];
+        queries++;
+        thrd_yield();
+    }
+
+    for (int w = 0; w < WRITERS; ++w) {
+        pthread_join(threads[w], NULL);
+    }
+
+    long long state[3] = {0, 0, 0};
+    range_concurrent_skip_list(&index_list, -1, WRITERS * STAMPS_PER_WRITER, count_ordered, state);
+    order_errors += state[2];
+    printf("Indexed %lld timestamps (expected %d), %d range queries while writing, %lld order errors\n",
+           state[0], WRITERS * STAMPS_PER_WRITER + 1, queries, order_errors);
+    printf("contains 123456: %d, contains %d: %d\n", contains_concurrent_skip_list(&index_list, 123456),
+           WRITERS * STAMPS_PER_WRITER, contains_concurrent_skip_list(&index_list, WRITERS * STAMPS_PER_WRITER));
+
+    free_concurrent_skip_list(&index_list);
+    return 0;
+}
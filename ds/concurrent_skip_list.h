@@ -0,0 +1,262 @@
+/*
+ * Lock-Free Concurrent Skip List of Integers
+ *
+ * Ordered set of ints that any number of threads can insert into and search
+ * at the same time, e.g. an index of timestamps fed by several writers.
+ * A node is fully built before it is published with a compare-and-swap at
+ * level 0, which is the moment the value becomes visible; the higher levels
+ * are then linked bottom-up with one CAS each, re-searching on contention.
+ *
+ * Values cannot be removed while the list is shared: freeing a node that a
+ * concurrent reader may still be standing on needs a reclamation scheme
+ * (hazard pointers, epochs) that this module does not have. Nodes live until
+ * free_concurrent_skip_list. Use SkipList (skip_list.h) when one thread owns
+ * the index and removal is needed.
+ *
+ * The allocator, if any, must be thread-safe. Requires C11 atomics.
+ */
+
+#ifndef DS_CONCURRENT_SKIP_LIST_H
+#define DS_CONCURRENT_SKIP_LIST_H
+
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "allocator.h"
+#include "linked_list.h"
+
+#define CONCURRENT_SKIP_LIST_MAX_LEVEL 32
+
+/**
+ * Concurrent skip list node. Immutable once published except for its links.
+ */
+typedef struct ConcurrentSkipNode {
+    int value;                                  /* Value stored in this node */
+    unsigned height;                            /* Number of levels the node is linked into */
+    _Atomic(struct ConcurrentSkipNode*) next[]; /* next[i] is the following node at level i */
+} ConcurrentSkipNode;
+
+/**
+ * Callback for range_concurrent_skip_list, shaped like NodeVisitFn.
+ * Returns NODE_VISIT_CONTINUE or NODE_VISIT_STOP.
+ */
+typedef int (*ConcurrentSkipVisitFn)(const ConcurrentSkipNode* node, void* ctx);
+
+/**
+ * Concurrent skip list control structure.
+ */
+typedef struct {
+    ConcurrentSkipNode* head;    /* Sentinel of full height, holds no value */
+    atomic_uint level;           /* Number of levels in use, at least 1; only grows */
+    const Allocator* allocator;  /* Thread-safe allocator for nodes, NULL for the C library */
+} ConcurrentSkipList;
+
+/**
+ * Returns the size in bytes of a node of the given height.
+ */
+static inline size_t size_concurrent_skip_node(unsigned height) {
+    return sizeof(ConcurrentSkipNode) + height * sizeof(_Atomic(ConcurrentSkipNode*));
+}
+
+/**
+ * Draws the height of a new node (each level kept with probability 1/4) from
+ * a per-thread generator, so writers never share random state.
+ */
+static inline unsigned random_height_concurrent_skip_list(void) {
+    static _Thread_local uint64_t state;
+    if (state == 0) {
+        /* Seed from the address of this thread's state, which differs per thread */
+        state = (uint64_t)(uintptr_t)&state | 1;
+    }
+    /* splitmix64 */
+    uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    z ^= z >> 31;
+
+    unsigned height = 1;
+    while ((z & 3) == 0 && height < CONCURRENT_SKIP_LIST_MAX_LEVEL) {
+        height++;
+        z >>= 2;
+    }
+    return height;
+}
+
+/**
+ * Initializes an empty list. Not thread-safe; call before sharing.
+ *
+ * @param list Pointer to caller-allocated list
+ * @param allocator Thread-safe allocator for nodes, or NULL for the C library
+ * @return 1 on success, 0 if the sentinel could not be allocated
+ */
+static inline int init_concurrent_skip_list(ConcurrentSkipList* list, const Allocator* allocator) {
+    list->allocator = allocator;
+    list->head = allocate(allocator, size_concurrent_skip_node(CONCURRENT_SKIP_LIST_MAX_LEVEL), 0);
+    if (list->head == NULL) {
+        return 0;
+    }
+    list->head->height = CONCURRENT_SKIP_LIST_MAX_LEVEL;
+    for (unsigned level = 0; level < CONCURRENT_SKIP_LIST_MAX_LEVEL; ++level) {
+        atomic_init(&list->head->next[level], NULL);
+    }
+    atomic_init(&list->level, 1);
+    return 1;
+}
+
+/**
+ * Finds, at every level up to top, the last node < value and the node after it.
+ *
+ * @param list Pointer to the list
+ * @param value Value to search for
+ * @param top Number of levels to fill
+ * @param preds Filled with the predecessor at each level
+ * @param succs Filled with the first node >= value at each level (or NULL)
+ */
+static inline void find_path_concurrent_skip_list(ConcurrentSkipList* list, int value, unsigned top,
+                                                  ConcurrentSkipNode** preds, ConcurrentSkipNode** succs) {
+    ConcurrentSkipNode* node = list->head;
+    for (unsigned level = top; level-- > 0;) {
+        ConcurrentSkipNode* next = atomic_load_explicit(&node->next[level], memory_order_acquire);
+        while (next != NULL && next->value < value) {
+            node = next;
+            next = atomic_load_explicit(&node->next[level], memory_order_acquire);
+        }
+        preds[level] = node;
+        succs[level] = next;
+    }
+}
+
+/**
+ * Inserts a value. Lock-free; safe to call from any number of threads.
+ *
+ * @param list Pointer to the list
+ * @param value Value to insert
+ * @return 1 if the value was inserted, 0 if it was already present or the node
+ *         could not be allocated
+ */
+static inline int insert_concurrent_skip_list(ConcurrentSkipList* list, int value) {
+    ConcurrentSkipNode* preds[CONCURRENT_SKIP_LIST_MAX_LEVEL];
+    ConcurrentSkipNode* succs[CONCURRENT_SKIP_LIST_MAX_LEVEL];
+
+    unsigned height = random_height_concurrent_skip_list();
+    unsigned level = atomic_load_explicit(&list->level, memory_order_relaxed);
+    while (level < height &&
+           !atomic_compare_exchange_weak_explicit(&list->level, &level, height,
+                                                  memory_order_relaxed, memory_order_relaxed)) {
+    }
+    /* Search every level the node will occupy, even ones still empty */
+    unsigned top = level > height ? level : height;
+
+    find_path_concurrent_skip_list(list, value, top, preds, succs);
+    if (succs[0] != NULL && succs[0]->value == value) {
+        return 0;
+    }
+
+    ConcurrentSkipNode* node = allocate(list->allocator, size_concurrent_skip_node(height), 0);
+    if (node == NULL) {
+        return 0;
+    }
+    node->value = value;
+    node->height = height;
+    for (unsigned i = 0; i < height; ++i) {
+        atomic_init(&node->next[i], succs[i]);
+    }
+
+    /* Publish at level 0; a failed CAS means a neighbour changed, so search again */
+    while (!atomic_compare_exchange_strong_explicit(&preds[0]->next[0], &succs[0], node,
+                                                    memory_order_release, memory_order_relaxed)) {
+        find_path_concurrent_skip_list(list, value, top, preds, succs);
+        if (succs[0] != NULL && succs[0]->value == value) {
+            /* Lost the race to an equal value; the node was never visible */
+            deallocate(list->allocator, node, size_concurrent_skip_node(height));
+            return 0;
+        }
+        for (unsigned i = 0; i < height; ++i) {
+            atomic_store_explicit(&node->next[i], succs[i], memory_order_relaxed);
+        }
+    }
+
+    /* Link the express lanes; readers only reach level i through level i links */
+    for (unsigned i = 1; i < height; ++i) {
+        while (!atomic_compare_exchange_strong_explicit(&preds[i]->next[i], &succs[i], node,
+                                                        memory_order_release, memory_order_relaxed)) {
+            find_path_concurrent_skip_list(list, value, top, preds, succs);
+            atomic_store_explicit(&node->next[i], succs[i], memory_order_relaxed);
+        }
+    }
+    return 1;
+}
+
+/**
+ * Returns the first node whose value is >= value. Safe during inserts.
+ *
+ * @param list Pointer to the list
+ * @param value Value to search for
+ * @return Node, or NULL if every value is smaller
+ */
+static inline const ConcurrentSkipNode* lower_bound_concurrent_skip_list(ConcurrentSkipList* list, int value) {
+    ConcurrentSkipNode* node = list->head;
+    ConcurrentSkipNode* next = NULL;
+    for (unsigned level = atomic_load_explicit(&list->level, memory_order_relaxed); level-- > 0;) {
+        next = atomic_load_explicit(&node->next[level], memory_order_acquire);
+        while (next != NULL && next->value < value) {
+            node = next;
+            next = atomic_load_explicit(&node->next[level], memory_order_acquire);
+        }
+    }
+    return next;
+}
+
+/**
+ * Reports whether a value is present. Safe during inserts.
+ *
+ * @param list Pointer to the list
+ * @param value Value to look up
+ * @return 1 if the value is present, 0 otherwise
+ */
+static inline int contains_concurrent_skip_list(ConcurrentSkipList* list, int value) {
+    const ConcurrentSkipNode* node = lower_bound_concurrent_skip_list(list, value);
+    return node != NULL && node->value == value;
+}
+
+/**
+ * Visits, in ascending order, every node whose value is in [lo, hi]. Safe
+ * during inserts: values published before the call are seen, values
+ * published during it may or may not be.
+ *
+ * @param list Pointer to the list
+ * @param lo Smallest value to visit
+ * @param hi Largest value to visit
+ * @param vfn Callback invoked per node; return NODE_VISIT_STOP to end early
+ * @param ctx Opaque caller state passed through to every call
+ * @return The node the visit stopped at, or NULL if the range was exhausted
+ */
+static inline const ConcurrentSkipNode* range_concurrent_skip_list(ConcurrentSkipList* list, int lo, int hi,
+                                                                   ConcurrentSkipVisitFn vfn, void* ctx) {
+    const ConcurrentSkipNode* node = lower_bound_concurrent_skip_list(list, lo);
+    while (node != NULL && node->value <= hi) {
+        if (vfn(node, ctx) == NODE_VISIT_STOP) {
+            return node;
+        }
+        node = atomic_load_explicit(&node->next[0], memory_order_acquire);
+    }
+    return NULL;
+}
+
+/**
+ * Frees every node. No other thread may be using the list.
+ *
+ * @param list Pointer to the list
+ */
+static inline void free_concurrent_skip_list(ConcurrentSkipList* list) {
+    ConcurrentSkipNode* node = list->head;
+    while (node != NULL) {
+        ConcurrentSkipNode* next = atomic_load_explicit(&node->next[0], memory_order_relaxed);
+        deallocate(list->allocator, node, size_concurrent_skip_node(node->height));
+        node = next;
+    }
+    list->head = NULL;
+}
+
+#endif /* DS_CONCURRENT_SKIP_LIST_H */
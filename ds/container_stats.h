@@ -0,0 +1,192 @@
+/*
+ * Compile-Time Toggled Container Instrumentation
+ *
+ * Build with -DDS_CONTAINER_STATS to have DynArray and IntList record:
+ *
+ * - growth events of DynArray buffers (old and new capacity in bytes, bytes
+ *   moved when the buffer changed address, time spent resizing),
+ * - a log2 histogram of element counts when arrays are freed,
+ * - the number and length of process_list / visit_list traversals,
+ * - IntNodePool allocations served from the free list, from the current
+ *   slab, or by allocating a new slab.
+ *
+ * container_stats_snapshot() copies the counters out. They are process-wide
+ * (one weak definition shared by every translation unit) and updated with
+ * relaxed atomics, so containers on different threads can be instrumented
+ * at once.
+ *
+ * Add -DDS_CONTAINER_STATS_USDT (needs <sys/sdt.h> from systemtap) to also
+ * emit USDT probes under the "ds" provider for perf, bpftrace and friends:
+ * dyn_array_resize(old_bytes, new_bytes, moved_bytes), dyn_array_free(count)
+ * and list_traversal(nodes).
+ *
+ * Without DS_CONTAINER_STATS every hook expands to nothing, so the containers
+ * compile to exactly the code they had before; the push fast paths
+ * (push_dyn_array, push_node) have no hooks at all either way.
+ */
+
+#ifndef DS_CONTAINER_STATS_H
+#define DS_CONTAINER_STATS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+/* Bucket 0 counts empty arrays, bucket b counts 2^(b-1) <= count < 2^b, the last one the rest */
+#define CONTAINER_STATS_SIZE_BUCKETS 48
+
+/**
+ * Snapshot of the counters. Every field is a uint64_t so the live counters
+ * can be kept as one array of atomics.
+ */
+typedef struct {
+    uint64_t grow_events;        /* DynArray buffer resizes to a larger capacity */
+    uint64_t shrink_events;      /* DynArray buffer resizes to a smaller capacity */
+    uint64_t resize_bytes_moved; /* Bytes copied because a resize moved the buffer */
+    uint64_t resize_ns;          /* Time spent in resizes */
+    uint64_t peak_buffer_bytes;  /* Largest single buffer a resize produced */
+    uint64_t arrays_freed;       /* free_dyn_array calls */
+    uint64_t freed_size_histogram[CONTAINER_STATS_SIZE_BUCKETS];  /* Element counts at free_dyn_array */
+    uint64_t traversals;         /* process_list / visit_list calls */
+    uint64_t traversal_nodes;    /* Nodes visited by those calls */
+    uint64_t traversal_max;      /* Longest single traversal */
+    uint64_t pool_free_list_hits;  /* Pool nodes recycled from the free list */
+    uint64_t pool_slab_hits;       /* Pool nodes bump-allocated from the current slab */
+    uint64_t pool_new_slabs;       /* Slabs allocated because neither had room */
+} ContainerStats;
+
+#define CONTAINER_STATS_WORDS (sizeof(ContainerStats) / sizeof(uint64_t))
+
+#ifdef DS_CONTAINER_STATS
+
+#include <stdatomic.h>
+#include <time.h>
+
+#ifdef DS_CONTAINER_STATS_USDT
+#include <sys/sdt.h>
+#define CONTAINER_PROBE1(name, a) DTRACE_PROBE1(ds, name, a)
+#define CONTAINER_PROBE3(name, a, b, c) DTRACE_PROBE3(ds, name, a, b, c)
+#else
+#define CONTAINER_PROBE1(name, a) ((void)0)
+#define CONTAINER_PROBE3(name, a, b, c) ((void)0)
+#endif
+
+/* Live counters, indexed by field offset / 8. Weak, so all translation units share one copy. */
+__attribute__((weak)) _Atomic uint64_t ds_container_stats_words[CONTAINER_STATS_WORDS];
+
+/**
+ * Adds delta to the counter at the given ContainerStats field offset.
+ */
+static inline void container_stats_add(size_t field_offset, uint64_t delta) {
+    atomic_fetch_add_explicit(&ds_container_stats_words[field_offset / sizeof(uint64_t)], delta,
+                              memory_order_relaxed);
+}
+
+/**
+ * Raises the counter at the given field offset to value if it is lower.
+ */
+static inline void container_stats_max(size_t field_offset, uint64_t value) {
+    _Atomic uint64_t* word = &ds_container_stats_words[field_offset / sizeof(uint64_t)];
+    uint64_t seen = atomic_load_explicit(word, memory_order_relaxed);
+    while (seen < value &&
+           !atomic_compare_exchange_weak_explicit(word, &seen, value, memory_order_relaxed, memory_order_relaxed)) {
+    }
+}
+
+/**
+ * Returns a timestamp in nanoseconds for measuring durations.
+ */
+static inline uint64_t container_stats_now_ns(void) {
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * Records one buffer resize that started at start_ns.
+ */
+static inline void container_stats_resize(size_t old_bytes, size_t new_bytes, size_t moved_bytes, uint64_t start_ns) {
+    CONTAINER_PROBE3(dyn_array_resize, old_bytes, new_bytes, moved_bytes);
+    container_stats_add(new_bytes > old_bytes ? offsetof(ContainerStats, grow_events)
+                                              : offsetof(ContainerStats, shrink_events), 1);
+    container_stats_add(offsetof(ContainerStats, resize_bytes_moved), moved_bytes);
+    container_stats_add(offsetof(ContainerStats, resize_ns), container_stats_now_ns() - start_ns);
+    container_stats_max(offsetof(ContainerStats, peak_buffer_bytes), new_bytes);
+}
+
+/**
+ * Records the element count of an array being freed.
+ */
+static inline void container_stats_free(size_t count) {
+    CONTAINER_PROBE1(dyn_array_free, count);
+    size_t bucket = 0;
+    while (count >> bucket != 0 && bucket < CONTAINER_STATS_SIZE_BUCKETS - 1) {
+        bucket++;
+    }
+    container_stats_add(offsetof(ContainerStats, arrays_freed), 1);
+    container_stats_add(offsetof(ContainerStats, freed_size_histogram) + bucket * sizeof(uint64_t), 1);
+}
+
+/**
+ * Records one list traversal of the given length.
+ */
+static inline void container_stats_traversal(size_t nodes) {
+    CONTAINER_PROBE1(list_traversal, nodes);
+    container_stats_add(offsetof(ContainerStats, traversals), 1);
+    container_stats_add(offsetof(ContainerStats, traversal_nodes), nodes);
+    container_stats_max(offsetof(ContainerStats, traversal_max), nodes);
+}
+
+#define CONTAINER_STATS_TIMER(var) uint64_t var = container_stats_now_ns()
+#define CONTAINER_STATS_RESIZE(old_bytes, new_bytes, moved_bytes, start) \
+    container_stats_resize((old_bytes), (new_bytes), (moved_bytes), (start))
+#define CONTAINER_STATS_FREE(count) container_stats_free(count)
+#define CONTAINER_STATS_COUNTER(var) size_t var = 0
+#define CONTAINER_STATS_INC(var) ((void)++(var))
+#define CONTAINER_STATS_TRAVERSAL(nodes) container_stats_traversal(nodes)
+#define CONTAINER_STATS_POOL(field) container_stats_add(offsetof(ContainerStats, field), 1)
+
+#else
+
+#define CONTAINER_STATS_TIMER(var) ((void)0)
+#define CONTAINER_STATS_RESIZE(old_bytes, new_bytes, moved_bytes, start) ((void)0)
+#define CONTAINER_STATS_FREE(count) ((void)0)
+#define CONTAINER_STATS_COUNTER(var) ((void)0)
+#define CONTAINER_STATS_INC(var) ((void)0)
+#define CONTAINER_STATS_TRAVERSAL(nodes) ((void)0)
+#define CONTAINER_STATS_POOL(field) ((void)0)
+
+#endif /* DS_CONTAINER_STATS */
+
+/**
+ * Copies the current counters.
+ *
+ * @param out Where the counters are written (all zero when stats are compiled out)
+ * @return 1 if stats are compiled in (DS_CONTAINER_STATS), 0 otherwise
+ */
+static inline int container_stats_snapshot(ContainerStats* out) {
+#ifdef DS_CONTAINER_STATS
+    uint64_t words[CONTAINER_STATS_WORDS];
+    for (size_t i = 0; i < CONTAINER_STATS_WORDS; ++i) {
+        words[i] = atomic_load_explicit(&ds_container_stats_words[i], memory_order_relaxed);
+    }
+    memcpy(out, words, sizeof(*out));
+    return 1;
+#else
+    memset(out, 0, sizeof(*out));
+    return 0;
+#endif
+}
+
+/**
+ * Resets every counter to zero (a no-op when stats are compiled out).
+ */
+static inline void container_stats_reset(void) {
+#ifdef DS_CONTAINER_STATS
+    for (size_t i = 0; i < CONTAINER_STATS_WORDS; ++i) {
+        atomic_store_explicit(&ds_container_stats_words[i], 0, memory_order_relaxed);
+    }
+#endif
+}
+
+#endif /* DS_CONTAINER_STATS_H */
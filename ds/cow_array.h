@@ -0,0 +1,412 @@
+/*
+ * Copy-on-Write Chunked Array with O(1) Snapshots
+ *
+ * CowDynArray stores its elements in fixed-size chunks (about 4 KiB each by
+ * default) hung off a tree of interior nodes with COW_ARRAY_FANOUT children,
+ * like a persistent vector. Every node is reference counted, so a snapshot
+ * is only the root pointer, the count and a reference-count increment.
+ *
+ * A write goes through the path from the root to the target chunk and copies
+ * each node on it that is still shared with a snapshot: one chunk plus
+ * log64(n / chunk) small interior nodes, however large the array is. Nodes
+ * the writer owns alone are updated in place, so between snapshots pushes
+ * cost about what they cost in a DynArray.
+ *
+ * Threading: the owner of an array (one thread at a time) pushes, sets and
+ * takes snapshots. A snapshot can then be handed to any thread and read
+ * there without locks while the owner keeps writing, because no node that a
+ * snapshot can reach is ever modified. Snapshots are released from whichever
+ * thread holds them. Reference counts use C11 atomics.
+ */
+
+#ifndef DS_COW_ARRAY_H
+#define DS_COW_ARRAY_H
+
+#include <stdatomic.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "allocator.h"
+#include "dyn_array.h"
+
+#define COW_ARRAY_FANOUT_SHIFT 6
+#define COW_ARRAY_FANOUT (1u << COW_ARRAY_FANOUT_SHIFT)
+/* Chunk size used when init_cow_array is given 0 elements per chunk */
+#define COW_ARRAY_DEFAULT_CHUNK_BYTES 4096
+
+/**
+ * Tree node: a chunk of elements (level 0) or COW_ARRAY_FANOUT child pointers.
+ */
+typedef struct CowNode {
+    atomic_size_t refs;                 /* Arrays and parent nodes referring to this node */
+    _Alignas(16) unsigned char payload[];  /* Elements, or CowNode* children (NULL = not allocated) */
+} CowNode;
+
+/**
+ * Copy-on-write array. Copying the struct by hand does not take a reference;
+ * use snapshot_cow_array.
+ */
+typedef struct {
+    CowNode* root;               /* Root node (a chunk if depth is 0), NULL while empty */
+    size_t count;                /* Number of elements */
+    size_t size;                 /* Size of each element in bytes */
+    unsigned chunk_shift;        /* log2 of the elements per chunk */
+    unsigned depth;              /* Number of interior levels above the chunks */
+    const Allocator* allocator;  /* Thread-safe allocator for nodes, NULL for the C library */
+} CowDynArray;
+
+/**
+ * Callback for for_each_chunk_cow_array: receives one contiguous run of
+ * elements, the index of its first element, and the caller's context.
+ */
+typedef void (*CowChunkFn)(const void* items, size_t n, size_t first, void* ctx);
+
+/**
+ * Initializes an empty array. No memory is allocated until the first push.
+ *
+ * @param array Pointer to caller-allocated array
+ * @param size Size of each element in bytes (use sizeof())
+ * @param chunk_elems Elements per chunk, rounded up to a power of two
+ *                    (0 = as many as fit in COW_ARRAY_DEFAULT_CHUNK_BYTES)
+ * @param allocator Thread-safe allocator for nodes, or NULL for the C library
+ */
+static inline void init_cow_array(CowDynArray* array, size_t size, size_t chunk_elems, const Allocator* allocator) {
+    unsigned shift = 0;
+    if (chunk_elems == 0) {
+        /* Largest power of two that fits the default chunk, at least 1 */
+        while (size != 0 && ((size_t)2 << shift) * size <= COW_ARRAY_DEFAULT_CHUNK_BYTES) {
+            shift++;
+        }
+    } else {
+        while (((size_t)1 << shift) < chunk_elems) {
+            shift++;
+        }
+    }
+    array->root = NULL;
+    array->count = 0;
+    array->size = size;
+    array->chunk_shift = shift;
+    array->depth = 0;
+    array->allocator = allocator;
+}
+
+/**
+ * Returns the number of elements a tree of the given depth can hold.
+ */
+static inline size_t capacity_cow_array(const CowDynArray* array, unsigned depth) {
+    size_t shift = array->chunk_shift + (size_t)depth * COW_ARRAY_FANOUT_SHIFT;
+    return shift >= sizeof(size_t) * 8 ? (size_t)-1 : (size_t)1 << shift;
+}
+
+/**
+ * Returns the size in bytes of a node at the given level (0 = chunk).
+ */
+static inline size_t node_bytes_cow_array(const CowDynArray* array, unsigned level) {
+    if (level == 0) {
+        return sizeof(CowNode) + ((size_t)1 << array->chunk_shift) * array->size;
+    }
+    return sizeof(CowNode) + COW_ARRAY_FANOUT * sizeof(CowNode*);
+}
+
+/**
+ * Returns the child pointers of an interior node.
+ */
+static inline CowNode** children_cow_node(CowNode* node) {
+    return (CowNode**)(void*)node->payload;
+}
+
+/**
+ * Allocates an unshared node at the given level; interior nodes start with no children.
+ *
+ * @return The node, or NULL if the allocation failed
+ */
+static inline CowNode* alloc_cow_node(const CowDynArray* array, unsigned level) {
+    CowNode* node = allocate(array->allocator, node_bytes_cow_array(array, level), 0);
+    if (node == NULL) {
+        return NULL;
+    }
+    atomic_init(&node->refs, 1);
+    if (level > 0) {
+        for (unsigned i = 0; i < COW_ARRAY_FANOUT; ++i) {
+            children_cow_node(node)[i] = NULL;
+        }
+    }
+    return node;
+}
+
+/**
+ * Takes a reference to a node.
+ */
+static inline void retain_cow_node(CowNode* node) {
+    atomic_fetch_add_explicit(&node->refs, 1, memory_order_relaxed);
+}
+
+/**
+ * Drops a reference to a node; the last reference frees it and releases its children.
+ */
+static inline void release_cow_node(const CowDynArray* array, CowNode* node, unsigned level) {
+    /* acq_rel: the last holder must see every other holder's reads as finished */
+    if (atomic_fetch_sub_explicit(&node->refs, 1, memory_order_acq_rel) != 1) {
+        return;
+    }
+    if (level > 0) {
+        for (unsigned i = 0; i < COW_ARRAY_FANOUT; ++i) {
+            CowNode* child = children_cow_node(node)[i];
+            if (child != NULL) {
+                release_cow_node(array, child, level - 1);
+            }
+        }
+    }
+    deallocate(array->allocator, node, node_bytes_cow_array(array, level));
+}
+
+/**
+ * Makes the node in *slot one the array owns alone: kept if unshared,
+ * copied if shared with a snapshot, created if missing.
+ *
+ * @return The owned node, or NULL if an allocation failed (*slot is unchanged)
+ */
+static inline CowNode* own_cow_node(CowDynArray* array, CowNode** slot, unsigned level) {
+    CowNode* node = *slot;
+    if (node != NULL && atomic_load_explicit(&node->refs, memory_order_acquire) == 1) {
+        return node;
+    }
+    CowNode* owned = alloc_cow_node(array, level);
+    if (owned == NULL) {
+        return NULL;
+    }
+    if (node != NULL) {
+        if (level == 0) {
+            memcpy(owned->payload, node->payload, node_bytes_cow_array(array, 0) - sizeof(CowNode));
+        } else {
+            for (unsigned i = 0; i < COW_ARRAY_FANOUT; ++i) {
+                CowNode* child = children_cow_node(node)[i];
+                if (child != NULL) {
+                    retain_cow_node(child);
+                }
+                children_cow_node(owned)[i] = child;
+            }
+        }
+        release_cow_node(array, node, level);
+    }
+    *slot = owned;
+    return owned;
+}
+
+/**
+ * Returns a writable pointer to slot idx, unsharing (or creating) every node
+ * on its path. idx must be below capacity_cow_array(array, array->depth).
+ *
+ * @return Pointer to the element slot, or NULL if an allocation failed
+ */
+static inline void* mut_slot_cow_array(CowDynArray* array, size_t idx) {
+    CowNode** slot = &array->root;
+    for (unsigned level = array->depth;; --level) {
+        CowNode* node = own_cow_node(array, slot, level);
+        if (node == NULL) {
+            return NULL;
+        }
+        if (level == 0) {
+            size_t offset = idx & (((size_t)1 << array->chunk_shift) - 1);
+            return node->payload + offset * array->size;
+        }
+        unsigned shift = array->chunk_shift + (level - 1) * COW_ARRAY_FANOUT_SHIFT;
+        slot = &children_cow_node(node)[(idx >> shift) & (COW_ARRAY_FANOUT - 1)];
+    }
+}
+
+/**
+ * Returns a read-only pointer to element idx.
+ *
+ * @param array Pointer to the array or snapshot
+ * @param idx Index, must be < count
+ * @return Pointer to the element, valid until the next write to this array
+ *         (snapshots never change, so for a snapshot until it is freed)
+ */
+static inline const void* at_cow_array(const CowDynArray* array, size_t idx) {
+    CowNode* node = array->root;
+    for (unsigned level = array->depth; level > 0; --level) {
+        unsigned shift = array->chunk_shift + (level - 1) * COW_ARRAY_FANOUT_SHIFT;
+        node = children_cow_node(node)[(idx >> shift) & (COW_ARRAY_FANOUT - 1)];
+    }
+    size_t offset = idx & (((size_t)1 << array->chunk_shift) - 1);
+    return node->payload + offset * array->size;
+}
+
+/**
+ * Adds a level above the root when the tree is full, so index count fits.
+ *
+ * @return 1 on success, 0 if the new root could not be allocated
+ */
+static inline int grow_depth_cow_array(CowDynArray* array) {
+    if (array->root == NULL || array->count < capacity_cow_array(array, array->depth)) {
+        return 1;
+    }
+    CowNode* root = alloc_cow_node(array, array->depth + 1);
+    if (root == NULL) {
+        return 0;
+    }
+    children_cow_node(root)[0] = array->root;   /* The old root's reference moves to the new root */
+    array->root = root;
+    array->depth++;
+    return 1;
+}
+
+/**
+ * Appends an element, copying only the nodes on its path that snapshots share.
+ *
+ * @param array Pointer to the array (owner only)
+ * @param val Pointer to the element to add
+ * @return 1 on success, 0 if an allocation failed
+ */
+static inline int push_cow_array(CowDynArray* array, const void* val) {
+    if (array->count == (size_t)-1 || !grow_depth_cow_array(array)) {
+        return 0;
+    }
+    void* slot = mut_slot_cow_array(array, array->count);
+    if (slot == NULL) {
+        return 0;
+    }
+    memcpy(slot, val, array->size);
+    array->count++;
+    return 1;
+}
+
+/**
+ * Appends n contiguous elements, one memcpy per chunk.
+ *
+ * @param array Pointer to the array (owner only)
+ * @param src Pointer to the first of n elements
+ * @param n Number of elements to append
+ * @return 1 on success, 0 if an allocation failed (a prefix may have been appended)
+ */
+static inline int push_many_cow_array(CowDynArray* array, const void* src, size_t n) {
+    if (n > (size_t)-1 - array->count) {
+        return 0;
+    }
+    const char* from = src;
+    size_t chunk = (size_t)1 << array->chunk_shift;
+    while (n > 0) {
+        if (!grow_depth_cow_array(array)) {
+            return 0;
+        }
+        void* slot = mut_slot_cow_array(array, array->count);
+        if (slot == NULL) {
+            return 0;
+        }
+        size_t room = chunk - (array->count & (chunk - 1));
+        size_t k = n < room ? n : room;
+        memcpy(slot, from, k * array->size);
+        from += k * array->size;
+        array->count += k;
+        n -= k;
+    }
+    return 1;
+}
+
+/**
+ * Overwrites element idx, copying only the nodes on its path that snapshots share.
+ *
+ * @param array Pointer to the array (owner only)
+ * @param idx Index, must be < count
+ * @param val Pointer to the new value
+ * @return 1 on success, 0 if idx is out of range or an allocation failed
+ */
+static inline int set_cow_array(CowDynArray* array, size_t idx, const void* val) {
+    if (idx >= array->count) {
+        return 0;
+    }
+    void* slot = mut_slot_cow_array(array, idx);
+    if (slot == NULL) {
+        return 0;
+    }
+    memcpy(slot, val, array->size);
+    return 1;
+}
+
+/**
+ * Removes the last element. Its chunk is kept for the next push.
+ *
+ * @param array Pointer to the array (owner only)
+ * @param popped Optional pointer where the removed value will be copied
+ * @return 1 on success, 0 if the array is empty
+ */
+static inline int pop_cow_array(CowDynArray* array, void* popped) {
+    if (array->count == 0) {
+        return 0;
+    }
+    array->count--;
+    if (popped != NULL) {
+        memcpy(popped, at_cow_array(array, array->count), array->size);
+    }
+    return 1;
+}
+
+/**
+ * Takes an O(1) snapshot: a read-only view of the array as it is now, which
+ * later writes to the array do not affect. The snapshot is itself a
+ * CowDynArray; writing to it copies nodes the same way and leaves the
+ * original untouched.
+ *
+ * @param array Pointer to the array (owner only)
+ * @param snapshot Pointer to caller-allocated array receiving the snapshot;
+ *                 release it with free_cow_array
+ */
+static inline void snapshot_cow_array(const CowDynArray* array, CowDynArray* snapshot) {
+    *snapshot = *array;
+    if (array->root != NULL) {
+        retain_cow_node(array->root);
+    }
+}
+
+/**
+ * Calls fn once per chunk with the elements stored in it, in index order.
+ *
+ * @param array Pointer to the array or snapshot
+ * @param fn Callback receiving each run of contiguous elements
+ * @param ctx Opaque caller state passed through to every call
+ */
+static inline void for_each_chunk_cow_array(const CowDynArray* array, CowChunkFn fn, void* ctx) {
+    size_t chunk = (size_t)1 << array->chunk_shift;
+    for (size_t first = 0; first < array->count; first += chunk) {
+        size_t n = array->count - first < chunk ? array->count - first : chunk;
+        fn(at_cow_array(array, first), n, first, ctx);
+    }
+}
+
+/**
+ * Appends every element to a DynArray with the same element size, growing it at most once.
+ *
+ * @param out Pointer to the DynArray
+ * @param array Pointer to the array or snapshot
+ * @return 1 on success, 0 if the element sizes differ or growing failed
+ */
+static inline int append_cow_array_to_dyn_array(DynArray* out, const CowDynArray* array) {
+    if (out->size != array->size || !grow_for_dyn_array(out, array->count)) {
+        return 0;
+    }
+    size_t chunk = (size_t)1 << array->chunk_shift;
+    for (size_t first = 0; first < array->count; first += chunk) {
+        size_t n = array->count - first < chunk ? array->count - first : chunk;
+        memcpy((char*)out->items + (out->count + first) * out->size, at_cow_array(array, first), n * array->size);
+    }
+    out->count += array->count;
+    return 1;
+}
+
+/**
+ * Drops the array's (or snapshot's) reference to its nodes and resets it to
+ * empty. Nodes still shared with other snapshots stay alive.
+ *
+ * @param array Pointer to the array or snapshot
+ */
+static inline void free_cow_array(CowDynArray* array) {
+    if (array->root != NULL) {
+        release_cow_node(array, array->root, array->depth);
+    }
+    array->root = NULL;
+    array->count = 0;
+    array->depth = 0;
+}
+
+#endif /* DS_COW_ARRAY_H */
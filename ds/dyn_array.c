@@ -5,9 +5,10 @@
  * using void pointers and manual memory management. The implementation supports:
  *
  * - Creating arrays that can store any data type
- * - Automatic capacity management with doubling strategy
- * - Adding elements (push)
- * - Removing elements (pop)
+ * - Automatic capacity management with a configurable growth policy
+ * - Adding elements (push), one at a time or in bulk
+ * - Inserting a range of elements at any position
+ * - Removing elements: pop, O(1) swap-remove, range erase and stable compaction (retain)
  * - Accessing elements with proper type casting
  *
  * The example uses a User struct to show how to store complex types in the array.
@@ -15,124 +16,23 @@
  * - Stack allocation of control structures for better efficiency
  * - void pointer usage for type-agnostic storage
  * - Pointer arithmetic with byte-level precision using char* casting
- * - Memory reallocation strategy
+ * - Memory reallocation strategy using realloc
+ * - Pre-sizing (reserve) and trimming (shrink to fit) of capacity
+ * - Small-buffer optimization: inline storage that spills to the heap only when outgrown
  * - Proper struct copying with memcpy
  * - Error handling with status codes
+ * - Macro-generated, type-specialized arrays as a faster alternative to void*
  * - Separation of allocation and initialization
+ * - Pluggable allocators (see allocator.h) for accounting and custom heaps
+ *
+ * The implementation lives in dyn_array.h (header-only) so other programs,
+ * such as the benchmarks in bench/, can reuse it; this file is the demo.
  */
 
-#include <stdlib.h>
 #include <stdio.h>
-#include <string.h>
-
-/**
- * Simple user structure to demonstrate storing complex types.
- * The fixed-size character array avoids dynamic memory allocation
- * for the name, simplifying memory management.
- */
-typedef struct {
-    char name[50];  /* Fixed-size array for name storage */
-    short id;       /* Unique identifier */
-} User;
-
-/**
- * Generic dynamic array structure.
- * Uses void pointer to store elements of any type.
- */
-typedef struct {
-    void* items;    /* Pointer to the contiguous block of memory */
-    size_t count;   /* Number of elements currently stored */
-    size_t cap;     /* Current capacity (in number of elements) */
-    size_t size;    /* Size of each element in bytes */
-} DynArray;
-
-/**
- * Initializes a dynamic array for elements of the specified size.
- * The array struct itself should be allocated by the caller (typically on the stack).
- * 
- * @param size Size of each element in bytes (use sizeof())
- * @param array Pointer to caller-allocated DynArray structure to initialize
- */
-void new_dyn_array(size_t size, DynArray* array) {
-    /* Initialize with default values */
-    array->count = 0;
-    array->cap = 2;         /* Start with small capacity */
-    array->size = size;
-    
-    /* Allocate initial memory block for items */
-    array->items = malloc(array->size * array->cap);
-}
-
-/**
- * Adds an element to the dynamic array, handling resizing if needed.
- * Uses memcpy to properly copy the element's bytes.
- * 
- * @param array Pointer to the dynamic array
- * @param val Pointer to the element to add (can be any type)
- */
-void push_dyn_array(DynArray* array, void* val) {
-    /* Check if we need to resize */
-    if(array->count >= array->cap) {
-        /* Double the capacity */
-        array->cap *= 2;
-        
-        /* Calculate new memory block size in bytes */
-        size_t new_size = array->cap * array->size;
-        
-        /* Allocate new, larger memory block */
-        void* new_items = malloc(new_size);
-        
-        /* Copy existing elements to new memory block */
-        memcpy(new_items, array->items, array->size * array->count);
-        
-        /* Free the old memory block */
-        free(array->items);
-        
-        /* Update items pointer to new memory block */
-        array->items = new_items;
-    }
-    
-    /* Calculate destination address for new element
-     * We cast to char* to get byte-level pointer arithmetic */
-    void* dest = (char*)array->items + array->size * array->count;
-    
-    /* Copy the element's bytes to the array */
-    memcpy(dest, val, array->size);
-    
-    /* Increment element count */
-    array->count++;
-}
-
-/**
- * Removes and returns the last element from the dynamic array.
- * 
- * @param array Pointer to the dynamic array
- * @param out_val Optional pointer where the popped value will be copied
- * @return 1 on success, 0 if array is empty
- */
-/**
- * Removes and returns the last element from the dynamic array.
- * 
- * @param array Pointer to the dynamic array
- * @param out_val Optional pointer where the popped value will be copied
- * @return 1 on success, 0 if array is empty
- */
-int pop_dyn_array(DynArray* array, void* popped) {
-    /* Check if the array is empty */
-    if (array->count == 0) {
-        return 0;
-    }
 
-    if (popped != NULL) {
-        void* src = (char*)array->items + ((array->count - 1) * array->size);
-        memcpy(popped, src, array->size);
-    }
-
-    /* It's sufficient to just decrement the count.
-     * On the next push, the popped item will be overwritten */
-    array->count--;
-    return 1;
-}
+#include "user.h"
+#include "dyn_array.h"
 
 /**
  * Prints all users in the array.
@@ -155,6 +55,29 @@ void print_user_array(DynArray* array) {
     printf("---\n");
 }
 
+/**
+ * Prints all users in a typed UserArray.
+ * Same output as print_user_array, but the element size is a compile-time constant.
+ *
+ * @param array Pointer to typed array of User elements
+ */
+void print_user_typed_array(UserArray* array) {
+    printf("Array state:\n");
+    for (size_t i = 0; i < array->count; ++i) {
+        User* user = UserArray_at(array, i);
+        printf("Index: [%zu], name: %s, id: %d\n", i, user->name, user->id);
+    }
+    printf("---\n");
+}
+
+/**
+ * Predicate for retain_dyn_array: keeps users with an odd id.
+ */
+static int has_odd_id(const void* elem, void* ctx) {
+    (void)ctx;
+    return ((const User*)elem)->id % 2 != 0;
+}
+
 /**
  * Example usage of the generic dynamic array with User elements.
  */
@@ -186,8 +109,84 @@ int main(void) {
     /* Pop without providing the optional pointer */
     pop_dyn_array(&array, NULL);
     print_user_array(&array);
-    
-    
-    /* Clean-up would go here (free array) */ 
+
+    /* Append a whole batch with one copy, then insert a range at the front */
+    User batch[] = {{"mordecai", 4}, {"benson", 5}};
+    push_many_dyn_array(&array, batch, 2);
+    User front[] = {{"pops", 6}};
+    insert_range_dyn_array(&array, 0, front, 1);
+    print_user_array(&array);
+
+    /* Remove from the middle: O(1) when order does not matter, one memmove when it does */
+    push_dyn_array(&array, &user3);
+    swap_remove_dyn_array(&array, 0, NULL);
+    print_user_array(&array);
+    erase_range_dyn_array(&array, 1, 2);
+    print_user_array(&array);
+
+    /* Keep only users with an odd id, compacting in place */
+    push_many_dyn_array(&array, batch, 2);
+    size_t removed = retain_dyn_array(&array, has_odd_id, NULL);
+    printf("Retain removed %zu users\n", removed);
+    print_user_array(&array);
+
+    /* Pre-size for a known batch, then trim the unused capacity */
+    reserve_dyn_array(&array, 16);
+    printf("Reserved capacity: %zu\n", array.cap);
+    shrink_to_fit_dyn_array(&array);
+    printf("Capacity after shrink to fit: %zu\n", array.cap);
+
+    /* Release the buffer owned by the array */
+    free_dyn_array(&array);
+
+    /* A big-array policy: 1.5x growth, rounded to 2 MiB once past 1 MiB,
+     * allocating through a counting allocator to see what growth costs */
+    CountingAllocator counting;
+    init_counting_allocator(&counting, NULL);
+    DynArrayOptions big_opts = {1024, 1.5, 1024 * 1024, DYN_ARRAY_HUGE_PAGE_SIZE, &counting.base, 1};
+    DynArray big;
+    init_dyn_array(sizeof(User), &big_opts, &big);
+    for (short i = 0; i < 30000; ++i) {
+        User user = {"user", i};
+        push_dyn_array(&big, &user);
+    }
+    printf("Big array - count: %zu, capacity: %zu\n", big.count, big.cap);
+    printf("Big array - peak bytes: %zu, reallocs: %zu, bytes copied: %zu\n",
+           counting.stats.peak_bytes, counting.stats.reallocs, counting.stats.bytes_copied);
+
+    /* shrink_on_remove gives memory back as the array drains */
+    while (big.count > 100) {
+        pop_dyn_array(&big, NULL);
+    }
+    printf("Big array after draining - count: %zu, capacity: %zu, live bytes: %zu\n",
+           big.count, big.cap, counting.stats.live_bytes);
+    free_dyn_array(&big);
+
+    /* Small arrays live in inline storage; the heap is only used once they outgrow it */
+    SMALL_DYN_ARRAY(User, 4) small;
+    INIT_SMALL_DYN_ARRAY(small);
+    push_dyn_array(&small.array, &user1);
+    push_dyn_array(&small.array, &user2);
+    printf("Small array - inline: %s, capacity: %zu\n",
+           small.array.items == small.storage ? "yes" : "no", small.array.cap);
+    push_many_dyn_array(&small.array, batch, 2);
+    push_dyn_array(&small.array, &user3);
+    printf("Small array - inline: %s, capacity: %zu\n",
+           small.array.items == small.storage ? "yes" : "no", small.array.cap);
+    pop_dyn_array(&small.array, NULL);
+    shrink_to_fit_dyn_array(&small.array);
+    printf("Small array after shrink - inline: %s, capacity: %zu\n",
+           small.array.items == small.storage ? "yes" : "no", small.array.cap);
+    print_user_array(&small.array);
+    free_dyn_array(&small.array);
+
+    /* The typed variant stores by value, no void* or runtime element size */
+    UserArray typed;
+    UserArray_init(&typed);
+    UserArray_push(&typed, user1);
+    UserArray_push(&typed, user2);
+    UserArray_push(&typed, user3);
+    print_user_typed_array(&typed);
+    UserArray_free(&typed);
     return 0;
 }
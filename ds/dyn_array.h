@@ -0,0 +1,630 @@
+/*
+ * Generic Dynamic Array
+ *
+ * Header-only implementation of the void* DynArray and the DEFINE_DYN_ARRAY
+ * typed variant. All functions are static inline so that any program can
+ * include this header directly; see dyn_array.c for a walkthrough and demo.
+ */
+
+#ifndef DS_DYN_ARRAY_H
+#define DS_DYN_ARRAY_H
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "allocator.h"
+#include "container_stats.h"
+
+/**
+ * Growth policy for a dynamic array.
+ * Lets each workload pick its own trade-off between wasted memory
+ * (large factor, large chunks) and reallocation/copy cost (small factor).
+ */
+typedef struct {
+    size_t initial_cap;      /* Capacity allocated up front (0 = allocate on first push) */
+    double growth_factor;    /* Capacity multiplier on growth, e.g. 1.5 or 2.0 (must be > 1) */
+    size_t chunk_threshold;  /* Buffer size in bytes above which growth is rounded to chunk_size */
+    size_t chunk_size;       /* Rounding granularity in bytes, e.g. 4096 or 2 MiB (0 = disabled) */
+    const Allocator* allocator;  /* Where the buffer comes from, NULL for malloc/realloc/free */
+    int shrink_on_remove;    /* Halve capacity when removals leave count < cap / 4 (0 = keep peak capacity) */
+} DynArrayOptions;
+
+/* Page size and huge page size, convenient values for chunk_size */
+#define DYN_ARRAY_PAGE_SIZE ((size_t)4096)
+#define DYN_ARRAY_HUGE_PAGE_SIZE ((size_t)2 * 1024 * 1024)
+
+/* Policy used by new_dyn_array: start small and double, no chunking, C library allocator */
+static const DynArrayOptions DYN_ARRAY_DEFAULT_OPTIONS = {2, 2.0, 0, 0, NULL, 0};
+
+/**
+ * Generic dynamic array structure.
+ * Uses void pointer to store elements of any type.
+ */
+typedef struct {
+    void* items;    /* Pointer to the contiguous block of memory */
+    size_t count;   /* Number of elements currently stored */
+    size_t cap;     /* Current capacity (in number of elements) */
+    size_t size;    /* Size of each element in bytes */
+    DynArrayOptions options;  /* Growth policy */
+    void* inline_items;  /* Caller-provided inline storage, NULL if none (see SMALL_DYN_ARRAY) */
+    size_t inline_cap;   /* Capacity of inline_items (in number of elements) */
+} DynArray;
+
+/**
+ * Initializes a dynamic array with a custom growth policy.
+ * The array struct itself should be allocated by the caller (typically on the stack).
+ *
+ * @param size Size of each element in bytes (use sizeof())
+ * @param options Growth policy, or NULL for the defaults
+ * @param array Pointer to caller-allocated DynArray structure to initialize
+ * @return 1 on success, 0 if the initial allocation failed
+ */
+static inline int init_dyn_array(size_t size, const DynArrayOptions* options, DynArray* array) {
+    array->count = 0;
+    array->cap = 0;
+    array->size = size;
+    array->items = NULL;
+    array->inline_items = NULL;
+    array->inline_cap = 0;
+    array->options = options != NULL ? *options : DYN_ARRAY_DEFAULT_OPTIONS;
+
+    /* A factor <= 1 would never grow, fall back to doubling */
+    if (!(array->options.growth_factor > 1.0)) {
+        array->options.growth_factor = DYN_ARRAY_DEFAULT_OPTIONS.growth_factor;
+    }
+
+    /* Allocate initial memory block for items, unless allocation is deferred */
+    if (array->options.initial_cap > 0) {
+        /* Guard against size_t overflow when computing the byte size */
+        if (array->size != 0 && array->options.initial_cap > (size_t)-1 / array->size) {
+            return 0;
+        }
+        array->items = allocate(array->options.allocator, array->size * array->options.initial_cap, 0);
+        if (array->items == NULL) {
+            return 0;
+        }
+        array->cap = array->options.initial_cap;
+    }
+    return 1;
+}
+
+/**
+ * Initializes a dynamic array for elements of the specified size.
+ * The array struct itself should be allocated by the caller (typically on the stack).
+ * Uses the default growth policy (start at 2, double on growth).
+ * 
+ * @param size Size of each element in bytes (use sizeof())
+ * @param array Pointer to caller-allocated DynArray structure to initialize
+ */
+static inline void new_dyn_array(size_t size, DynArray* array) {
+    init_dyn_array(size, NULL, array);
+}
+
+/**
+ * Computes the capacity to grow to so that at least min_cap elements fit,
+ * following the array's growth policy.
+ *
+ * @param array Pointer to the dynamic array
+ * @param min_cap Minimum capacity required (in number of elements)
+ * @return New capacity, >= min_cap
+ */
+static inline size_t next_cap_dyn_array(const DynArray* array, size_t min_cap) {
+    const DynArrayOptions* opts = &array->options;
+
+    /* Largest capacity whose byte size fits in size_t; resize_dyn_array rejects anything above */
+    size_t limit = array->size ? (size_t)-1 / array->size : (size_t)-1;
+
+    /* An empty or shrunk array starts over at the initial capacity. A double
+       beyond size_t's range cannot be converted, so the product is clamped first. */
+    size_t new_cap = opts->initial_cap;
+    if (array->cap) {
+        double grown = (double)array->cap * opts->growth_factor;
+        new_cap = grown < (double)limit ? (size_t)grown : limit;
+    }
+    if (new_cap <= array->cap && array->cap < limit) {
+        new_cap = array->cap + 1;   /* Small caps with factor 1.5 would otherwise stall */
+    }
+    if (new_cap < min_cap) {
+        new_cap = min_cap;
+    }
+
+    /* Large buffers grow in whole chunks so they stay page/huge-page aligned in size */
+    if (opts->chunk_size > 0 && array->size > 0 && new_cap <= limit) {
+        size_t bytes = new_cap * array->size;
+        if (bytes > opts->chunk_threshold && bytes <= (size_t)-1 - (opts->chunk_size - 1)) {
+            bytes = (bytes + opts->chunk_size - 1) / opts->chunk_size * opts->chunk_size;
+            new_cap = bytes / array->size;
+        }
+    }
+    return new_cap;
+}
+
+/**
+ * Resizes the backing buffer to hold exactly new_cap elements.
+ * Uses reallocate so the allocator can extend the block in place instead of
+ * always copying the whole buffer. On failure the old buffer is kept intact.
+ *
+ * @param array Pointer to the dynamic array
+ * @param new_cap New capacity (in number of elements), must be >= count
+ * @return 1 on success, 0 if the allocation failed
+ */
+static inline int resize_dyn_array(DynArray* array, size_t new_cap) {
+    /* Guard against size_t overflow when computing the byte size */
+    if (array->size != 0 && new_cap > (size_t)-1 / array->size) {
+        return 0;
+    }
+
+    CONTAINER_STATS_TIMER(start);
+
+    /* Inline storage cannot be reallocated: spill to the heap with one copy */
+    if (array->items != NULL && array->items == array->inline_items) {
+        void* heap_items = allocate(array->options.allocator, new_cap * array->size, 0);
+        if (heap_items == NULL) {
+            return 0;
+        }
+        memcpy(heap_items, array->items, array->count * array->size);
+        CONTAINER_STATS_RESIZE(array->cap * array->size, new_cap * array->size, array->count * array->size, start);
+        array->items = heap_items;
+        array->cap = new_cap;
+        return 1;
+    }
+
+    /* realloc keeps the original block valid if it fails, so assign through a temporary */
+    int moved = 0;
+    void* new_items = reallocate_moved(array->options.allocator, array->items,
+                                       array->cap * array->size, new_cap * array->size, &moved);
+    if (new_items == NULL) {
+        return 0;
+    }
+
+    /* A block extended in place moved nothing; one that changed address was copied */
+    CONTAINER_STATS_RESIZE(array->cap * array->size, new_cap * array->size, moved ? array->count * array->size : 0,
+                           start);
+    array->items = new_items;
+    array->cap = new_cap;
+    return 1;
+}
+
+/**
+ * Ensures the array can hold at least min_cap elements without regrowing.
+ * Useful to pre-size the array when the number of elements is known up front.
+ *
+ * @param array Pointer to the dynamic array
+ * @param min_cap Minimum capacity (in number of elements)
+ * @return 1 on success, 0 if the allocation failed
+ */
+static inline int reserve_dyn_array(DynArray* array, size_t min_cap) {
+    /* Nothing to do if we already have enough room */
+    if (min_cap <= array->cap) {
+        return 1;
+    }
+    return resize_dyn_array(array, min_cap);
+}
+
+/**
+ * Releases unused capacity so that cap == count.
+ * An empty array gives its buffer back entirely and starts over on the next push.
+ * An array with inline storage moves back into it once its elements fit again.
+ *
+ * @param array Pointer to the dynamic array
+ * @return 1 on success, 0 if the allocation failed
+ */
+static inline int shrink_to_fit_dyn_array(DynArray* array) {
+    if (array->count == array->cap || array->items == array->inline_items) {
+        return 1;
+    }
+
+    /* Heap buffer no longer needed if the elements fit inline */
+    if (array->inline_items != NULL && array->count <= array->inline_cap) {
+        memcpy(array->inline_items, array->items, array->count * array->size);
+        deallocate(array->options.allocator, array->items, array->cap * array->size);
+        array->items = array->inline_items;
+        array->cap = array->inline_cap;
+        return 1;
+    }
+
+    /* realloc(ptr, 0) is implementation-defined, so free explicitly */
+    if (array->count == 0) {
+        deallocate(array->options.allocator, array->items, array->cap * array->size);
+        array->items = NULL;
+        array->cap = 0;
+        return 1;
+    }
+    return resize_dyn_array(array, array->count);
+}
+
+/**
+ * Adds an element to the dynamic array, handling resizing if needed.
+ * Uses memcpy to properly copy the element's bytes.
+ * 
+ * @param array Pointer to the dynamic array
+ * @param val Pointer to the element to add (can be any type)
+ * @return 1 on success, 0 if growing the array failed
+ */
+static inline int push_dyn_array(DynArray* array, void* val) {
+    /* Check if we need to resize */
+    if(array->count >= array->cap) {
+        /* Grow according to the array's policy */
+        size_t new_cap = next_cap_dyn_array(array, array->count + 1);
+
+        /* Grow the memory block, letting realloc extend it in place when possible */
+        if (!resize_dyn_array(array, new_cap)) {
+            return 0;
+        }
+    }
+    
+    /* Calculate destination address for new element
+     * We cast to char* to get byte-level pointer arithmetic */
+    void* dest = (char*)array->items + array->size * array->count;
+    
+    /* Copy the element's bytes to the array */
+    memcpy(dest, val, array->size);
+    
+    /* Increment element count */
+    array->count++;
+    return 1;
+}
+
+/**
+ * Makes room for n more elements, growing the buffer at most once.
+ *
+ * @param array Pointer to the dynamic array
+ * @param n Number of elements about to be added
+ * @return 1 on success, 0 on overflow or if growing the array failed
+ */
+static inline int grow_for_dyn_array(DynArray* array, size_t n) {
+    /* Guard against count + n wrapping around */
+    if (n > (size_t)-1 - array->count) {
+        return 0;
+    }
+    size_t needed = array->count + n;
+    if (needed <= array->cap) {
+        return 1;
+    }
+    return resize_dyn_array(array, next_cap_dyn_array(array, needed));
+}
+
+/**
+ * Appends n contiguous elements to the end of the array.
+ * Grows the buffer at most once and copies all elements with a single memcpy.
+ *
+ * @param array Pointer to the dynamic array
+ * @param src Pointer to the first of n elements, laid out like the array's items
+ * @param n Number of elements to append
+ * @return 1 on success, 0 if growing the array failed
+ */
+static inline int push_many_dyn_array(DynArray* array, const void* src, size_t n) {
+    if (n == 0) {
+        return 1;
+    }
+    if (!grow_for_dyn_array(array, n)) {
+        return 0;
+    }
+
+    void* dest = (char*)array->items + array->size * array->count;
+    memcpy(dest, src, array->size * n);
+    array->count += n;
+    return 1;
+}
+
+/**
+ * Inserts n contiguous elements before position idx, preserving order.
+ * Existing elements are shifted with one memmove, then the new ones are copied in.
+ *
+ * @param array Pointer to the dynamic array
+ * @param idx Insert position, 0 <= idx <= count (count appends)
+ * @param src Pointer to the first of n elements, must not point into the array itself
+ * @param n Number of elements to insert
+ * @return 1 on success, 0 if idx is out of range or growing the array failed
+ */
+static inline int insert_range_dyn_array(DynArray* array, size_t idx, const void* src, size_t n) {
+    if (idx > array->count) {
+        return 0;
+    }
+    if (n == 0) {
+        return 1;
+    }
+    if (!grow_for_dyn_array(array, n)) {
+        return 0;
+    }
+
+    /* Shift the tail [idx, count) right by n elements to open the gap */
+    char* gap = (char*)array->items + array->size * idx;
+    memmove(gap + array->size * n, gap, array->size * (array->count - idx));
+
+    memcpy(gap, src, array->size * n);
+    array->count += n;
+    return 1;
+}
+
+/**
+ * Gives back memory after a removal if the array was configured to (shrink_on_remove).
+ * Capacity is halved only once count drops below a quarter of it, so an array
+ * hovering around a size does not resize on every push/pop pair.
+ * Failure to shrink is harmless and ignored.
+ *
+ * @param array Pointer to the dynamic array
+ */
+static inline void maybe_shrink_dyn_array(DynArray* array) {
+    if (!array->options.shrink_on_remove || array->count >= array->cap / 4 ||
+        array->items == array->inline_items) {
+        return;
+    }
+
+    /* Back to inline storage if the elements fit */
+    if (array->inline_items != NULL && array->count <= array->inline_cap) {
+        shrink_to_fit_dyn_array(array);
+        return;
+    }
+
+    /* After a bulk removal, halve as often as the same rule would on single pops */
+    size_t new_cap = array->cap / 2;
+    while (array->count < new_cap / 4) {
+        new_cap /= 2;
+    }
+    if (new_cap < array->options.initial_cap) {
+        new_cap = array->options.initial_cap;
+    }
+    if (new_cap > array->count && new_cap < array->cap) {
+        resize_dyn_array(array, new_cap);
+    }
+}
+
+/**
+ * Removes and returns the last element from the dynamic array.
+ * 
+ * @param array Pointer to the dynamic array
+ * @param popped Optional pointer where the popped value will be copied
+ * @return 1 on success, 0 if array is empty
+ */
+static inline int pop_dyn_array(DynArray* array, void* popped) {
+    /* Check if the array is empty */
+    if (array->count == 0) {
+        return 0;
+    }
+
+    if (popped != NULL) {
+        void* src = (char*)array->items + ((array->count - 1) * array->size);
+        memcpy(popped, src, array->size);
+    }
+
+    /* It's sufficient to just decrement the count.
+     * On the next push, the popped item will be overwritten */
+    array->count--;
+    maybe_shrink_dyn_array(array);
+    return 1;
+}
+
+/**
+ * Removes the element at idx in O(1) by moving the last element into its place.
+ * Does not preserve the order of the remaining elements.
+ *
+ * @param array Pointer to the dynamic array
+ * @param idx Index of the element to remove
+ * @param removed Optional pointer where the removed value will be copied
+ * @return 1 on success, 0 if idx is out of bounds
+ */
+static inline int swap_remove_dyn_array(DynArray* array, size_t idx, void* removed) {
+    if (idx >= array->count) {
+        return 0;
+    }
+
+    char* slot = (char*)array->items + idx * array->size;
+    if (removed != NULL) {
+        memcpy(removed, slot, array->size);
+    }
+    /* Removing the last element needs no move */
+    if (idx != array->count - 1) {
+        memcpy(slot, (char*)array->items + (array->count - 1) * array->size, array->size);
+    }
+    array->count--;
+    maybe_shrink_dyn_array(array);
+    return 1;
+}
+
+/**
+ * Removes n elements starting at first, shifting the tail down with one memmove.
+ * Preserves the order of the remaining elements.
+ *
+ * @param array Pointer to the dynamic array
+ * @param first Index of the first element to remove
+ * @param n Number of elements to remove
+ * @return 1 on success, 0 if the range is out of bounds
+ */
+static inline int erase_range_dyn_array(DynArray* array, size_t first, size_t n) {
+    if (first > array->count || n > array->count - first) {
+        return 0;
+    }
+    if (n == 0) {
+        return 1;
+    }
+
+    char* gap = (char*)array->items + first * array->size;
+    memmove(gap, gap + n * array->size, (array->count - first - n) * array->size);
+    array->count -= n;
+    maybe_shrink_dyn_array(array);
+    return 1;
+}
+
+/**
+ * Keeps only the elements for which pred returns nonzero, in one pass.
+ * The compaction is stable: kept elements stay in their original order.
+ * Runs of kept elements are moved with a single memmove each.
+ *
+ * @param array Pointer to the dynamic array
+ * @param pred Predicate receiving each element and ctx; nonzero keeps the element
+ * @param ctx Opaque caller state passed to every call
+ * @return Number of elements removed
+ */
+static inline size_t retain_dyn_array(DynArray* array, int (*pred)(const void* elem, void* ctx), void* ctx) {
+    char* items = array->items;
+    size_t size = array->size;
+    size_t kept = 0;        /* Elements already compacted to the front */
+    size_t run_start = 0;   /* Start of the current run of kept elements */
+    size_t run_len = 0;
+
+    /* pred is called exactly once per element; i == count flushes the last run */
+    for (size_t i = 0; i <= array->count; ++i) {
+        if (i < array->count && pred(items + i * size, ctx)) {
+            if (run_len++ == 0) {
+                run_start = i;
+            }
+            continue;
+        }
+        if (run_len > 0) {
+            if (kept != run_start) {
+                memmove(items + kept * size, items + run_start * size, run_len * size);
+            }
+            kept += run_len;
+            run_len = 0;
+        }
+    }
+
+    size_t removed = array->count - kept;
+    array->count = kept;
+    if (removed > 0) {
+        maybe_shrink_dyn_array(array);
+    }
+    return removed;
+}
+
+/**
+ * Releases the memory owned by the array and resets it to an empty state.
+ * The DynArray struct itself is owned by the caller and is not freed.
+ *
+ * @param array Pointer to the dynamic array
+ */
+static inline void free_dyn_array(DynArray* array) {
+    CONTAINER_STATS_FREE(array->count);
+    if (array->items != array->inline_items) {
+        deallocate(array->options.allocator, array->items, array->cap * array->size);
+    }
+    /* An array with inline storage stays usable, back on its inline buffer */
+    array->items = array->inline_items;
+    array->count = 0;
+    array->cap = array->inline_cap;
+}
+
+/**
+ * Initializes a dynamic array on caller-provided inline storage.
+ * The first inline_cap elements live in that storage (typically inside the
+ * caller's stack-allocated struct, see SMALL_DYN_ARRAY); the array only
+ * spills to the heap when it grows past it.
+ * The storage must outlive the array and must not move while in use.
+ *
+ * @param size Size of each element in bytes (use sizeof())
+ * @param storage Inline storage for inline_cap elements, suitably aligned
+ * @param inline_cap Capacity of storage (in number of elements)
+ * @param options Growth policy for the heap part, or NULL for the defaults
+ *                (initial_cap is ignored)
+ * @param array Pointer to caller-allocated DynArray structure to initialize
+ */
+static inline void init_inline_dyn_array(size_t size, void* storage, size_t inline_cap,
+                                         const DynArrayOptions* options, DynArray* array) {
+    DynArrayOptions opts = options != NULL ? *options : DYN_ARRAY_DEFAULT_OPTIONS;
+    opts.initial_cap = 0;   /* Nothing to allocate up front */
+    init_dyn_array(size, &opts, array);
+    array->items = storage;
+    array->cap = inline_cap;
+    array->inline_items = storage;
+    array->inline_cap = inline_cap;
+}
+
+/**
+ * Declares a struct holding a DynArray plus inline room for N elements of type T,
+ * for arrays that usually stay small and should not touch the heap.
+ * Initialize with INIT_SMALL_DYN_ARRAY and use the .array member with the
+ * regular API. The struct must not be copied or moved while in use.
+ *
+ *     SMALL_DYN_ARRAY(User, 8) users;
+ *     INIT_SMALL_DYN_ARRAY(users);
+ *     push_dyn_array(&users.array, &user);
+ */
+#define SMALL_DYN_ARRAY(T, N)                                                   \
+    struct {                                                                    \
+        DynArray array;                                                         \
+        T storage[N];                                                           \
+    }
+
+#define INIT_SMALL_DYN_ARRAY(small)                                             \
+    init_inline_dyn_array(sizeof((small).storage[0]), (small).storage,          \
+                          sizeof((small).storage) / sizeof((small).storage[0]), \
+                          NULL, &(small).array)
+
+/**
+ * Type-specialized dynamic array generator.
+ * DEFINE_DYN_ARRAY(T) expands to a TArray struct holding T* items plus
+ * TArray_init/_reserve/_push/_at/_pop/_free functions. Because the element
+ * type is known at compile time, element addressing is plain T* indexing and
+ * push stores by value, which the compiler can inline and vectorize,
+ * instead of going through a runtime size and a generic memcpy.
+ *
+ * T must be a single identifier (use a typedef for pointer or compound types).
+ * All functions are static inline, so the macro can be used in any file
+ * that includes it without link conflicts.
+ */
+#define DEFINE_DYN_ARRAY(T)                                                     \
+    typedef struct {                                                            \
+        T* items;       /* Contiguous, typed storage */                         \
+        size_t count;   /* Number of elements currently stored */               \
+        size_t cap;     /* Current capacity (in number of elements) */          \
+        const Allocator* allocator;  /* NULL for malloc/realloc/free */         \
+    } T##Array;                                                                 \
+                                                                                \
+    static inline void T##Array_init(T##Array* array) {                         \
+        array->items = NULL;                                                    \
+        array->count = 0;                                                       \
+        array->cap = 0;                                                         \
+        array->allocator = NULL;                                                \
+    }                                                                           \
+                                                                                \
+    static inline int T##Array_reserve(T##Array* array, size_t min_cap) {       \
+        if (min_cap <= array->cap) {                                            \
+            return 1;                                                           \
+        }                                                                       \
+        if (min_cap > (size_t)-1 / sizeof(T)) {                                 \
+            return 0;                                                           \
+        }                                                                       \
+        T* new_items = (T*)reallocate(array->allocator, array->items,           \
+                                      array->cap * sizeof(T),                   \
+                                      min_cap * sizeof(T));                     \
+        if (new_items == NULL) {                                                \
+            return 0;                                                           \
+        }                                                                       \
+        array->items = new_items;                                               \
+        array->cap = min_cap;                                                   \
+        return 1;                                                               \
+    }                                                                           \
+                                                                                \
+    static inline int T##Array_push(T##Array* array, T val) {                   \
+        if (array->count >= array->cap &&                                       \
+            !T##Array_reserve(array, array->cap ? array->cap * 2 : 2)) {        \
+            return 0;                                                           \
+        }                                                                       \
+        array->items[array->count++] = val;                                     \
+        return 1;                                                               \
+    }                                                                           \
+                                                                                \
+    static inline T* T##Array_at(T##Array* array, size_t idx) {                 \
+        return &array->items[idx];                                              \
+    }                                                                           \
+                                                                                \
+    static inline int T##Array_pop(T##Array* array, T* popped) {                \
+        if (array->count == 0) {                                                \
+            return 0;                                                           \
+        }                                                                       \
+        array->count--;                                                         \
+        if (popped != NULL) {                                                   \
+            *popped = array->items[array->count];                               \
+        }                                                                       \
+        return 1;                                                               \
+    }                                                                           \
+                                                                                \
+    static inline void T##Array_free(T##Array* array) {                         \
+        deallocate(array->allocator, array->items, array->cap * sizeof(T));     \
+        array->items = NULL;                                                    \
+        array->count = 0;                                                       \
+        array->cap = 0;                                                         \
+    }
+
+#endif /* DS_DYN_ARRAY_H */
@@ -0,0 +1,80 @@
+/*
+ * Hash Index Example
+ *
+ * This file demonstrates looking up User records by id through a hash index
+ * that stores positions in a DynArray instead of copies of the users.
+ * The implementation supports:
+ *
+ * - Bulk-building the index over an existing array in one pass
+ * - O(1) average lookups by an integer key field or by a key callback
+ * - Signed key fields, looked up with negative values directly
+ * - Keeping the index in sync through indexed push, pop and swap-remove
+ *
+ * Key concepts demonstrated:
+ * - Open addressing with linear probing and Robin Hood ordering
+ * - Backward-shift deletion instead of tombstones
+ * - Storing hashes next to indices so probes stay inside the table
+ * - Software prefetching during bulk build
+ */
+
+#include <stdio.h>
+
+#include "hash_index.h"
+#include "user.h"
+
+/**
+ * Key callback: indexes users by the first character of their name
+ * (a deliberately poor key, to show that duplicates are allowed).
+ */
+static uint64_t user_initial(const void* elem, void* ctx) {
+    (void)ctx;
+    return (unsigned char)((const User*)elem)->name[0];
+}
+
+int main(void) {
+    DynArray users;
+    new_dyn_array(sizeof(User), &users);
+    for (short i = 0; i < 1000; ++i) {
+        User user;
+        user.id = (short)(i * 7 + 3);
+        snprintf(user.name, sizeof(user.name), "user-%d", user.id);
+        push_dyn_array(&users, &user);
+    }
+
+    /* Index the existing users by id in one pass */
+    HashIndex by_id;
+    HASH_INDEX_INIT_BY(&by_id, &users, User, id, NULL);
+    build_hash_index(&by_id);
+    User* user = lookup_hash_index(&by_id, 703);
+    printf("Lookup id 703: %s\n", user != NULL ? user->name : "missing");
+    printf("Lookup id 704: %s\n", lookup_hash_index(&by_id, 704) != NULL ? "found" : "missing");
+
+    /* Modify the array through the index so it stays in sync */
+    User newcomer = {"skips", 5000};
+    push_hash_index(&by_id, &newcomer);
+    size_t idx = find_hash_index(&by_id, 3);
+    User removed;
+    swap_remove_hash_index(&by_id, idx, &removed);
+    printf("Removed %s, id 5000 now at index %zu, %zu users indexed\n",
+           removed.name, find_hash_index(&by_id, 5000), by_id.count);
+    pop_hash_index(&by_id, NULL);
+
+    /* Negative ids are found with the plain signed value */
+    User negative = {"below-zero", -5};
+    push_hash_index(&by_id, &negative);
+    user = lookup_hash_index(&by_id, (short)-5);
+    printf("Lookup id -5: %s\n", user != NULL ? user->name : "missing");
+    pop_hash_index(&by_id, NULL);
+
+    /* A second index over the same array, keyed by a callback */
+    HashIndex by_initial;
+    init_hash_index_fn(&by_initial, &users, user_initial, NULL, NULL);
+    build_hash_index(&by_initial);
+    user = lookup_hash_index(&by_initial, 'u');
+    printf("Some user whose name starts with 'u': %s\n", user != NULL ? user->name : "missing");
+
+    free_hash_index(&by_initial);
+    free_hash_index(&by_id);
+    free_dyn_array(&users);
+    return 0;
+}
@@ -0,0 +1,422 @@
+/*
+ * Open-Addressing Hash Index over DynArray Elements
+ *
+ * A HashIndex maps a 64-bit key, read from each element of a DynArray, to the
+ * element's index in that array. The elements themselves are never copied:
+ * every slot holds an element index plus the key's hash, so probing compares
+ * hashes inside the table and only touches the array to confirm a match,
+ * and growing the table rehashes from the stored hashes alone.
+ *
+ * Collisions are resolved with linear probing and Robin Hood ordering (an
+ * entry far from its home slot displaces one closer to home), which keeps
+ * probe sequences short and lets lookups stop early on a miss. Deletion
+ * shifts the following entries back instead of leaving tombstones.
+ *
+ * The key is either an integer field at a fixed offset (1, 2, 4 or 8 bytes,
+ * e.g. User.id) or extracted by a callback. Keys are compared as 64-bit
+ * integers, so a callback must return a value that identifies the element
+ * (not a lossy hash of a longer key). Duplicate keys are allowed; lookups
+ * return one of the matching elements.
+ *
+ * The index stays valid only if the array is modified through the indexed
+ * operations below (push/pop/swap-remove), or rebuilt afterwards.
+ */
+
+#ifndef DS_HASH_INDEX_H
+#define DS_HASH_INDEX_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "allocator.h"
+#include "dyn_array.h"
+
+#define HASH_INDEX_EMPTY ((size_t)-1)
+#define HASH_INDEX_NOT_FOUND ((size_t)-1)
+#define HASH_INDEX_MIN_SLOTS 16
+/* Maximum load, as a fraction of the slots, before the table doubles */
+#define HASH_INDEX_LOAD_NUM 7
+#define HASH_INDEX_LOAD_DEN 8
+/* Elements ahead whose home slot bulk build prefetches */
+#define HASH_INDEX_PREFETCH_DISTANCE 16
+
+/**
+ * Key extraction callback: returns the 64-bit key of an element.
+ */
+typedef uint64_t (*HashKeyFn)(const void* elem, void* ctx);
+
+/**
+ * One table slot: an element index and the hash of its key.
+ */
+typedef struct {
+    size_t idx;     /* Index into the array, HASH_INDEX_EMPTY if the slot is free */
+    uint64_t hash;  /* Hash of the element's key */
+} HashIndexSlot;
+
+/**
+ * Hash index over the elements of one DynArray.
+ */
+typedef struct {
+    HashIndexSlot* slots;        /* Power-of-two table, NULL until the first insert */
+    size_t mask;                 /* Number of slots - 1 (0 while slots is NULL) */
+    size_t count;                /* Number of indexed elements */
+    DynArray* array;             /* Array whose elements are indexed */
+    size_t key_offset;           /* Byte offset of an integer key within each element */
+    size_t key_size;             /* Size of that key: 1, 2, 4 or 8 bytes (0 = use key_fn) */
+    HashKeyFn key_fn;            /* Key callback, used when key_size is 0 */
+    void* key_ctx;               /* Opaque state passed to key_fn */
+    const Allocator* allocator;  /* Where the table comes from, NULL for the C library */
+} HashIndex;
+
+/**
+ * Initializes an empty index keyed by an integer field of each element.
+ * Keys narrower than 8 bytes are read zero-extended, and lookup keys are cut
+ * to the same width, so signed keys work too: find_hash_index(&index, -5)
+ * finds a short id of -5.
+ * See HASH_INDEX_INIT_BY for deriving the key parameters from a struct field.
+ *
+ * @param index Pointer to caller-allocated index
+ * @param array Array to index (elements already in it are indexed by build_hash_index)
+ * @param key_offset Byte offset of the key within each element
+ * @param key_size Size of the key in bytes: 1, 2, 4 or 8
+ * @param allocator Allocator for the table, or NULL for the C library
+ */
+static inline void init_hash_index(HashIndex* index, DynArray* array, size_t key_offset, size_t key_size,
+                                   const Allocator* allocator) {
+    index->slots = NULL;
+    index->mask = 0;
+    index->count = 0;
+    index->array = array;
+    index->key_offset = key_offset;
+    index->key_size = key_size;
+    index->key_fn = NULL;
+    index->key_ctx = NULL;
+    index->allocator = allocator;
+}
+
+/**
+ * Initializes an empty index whose keys are computed by a callback.
+ *
+ * @param index Pointer to caller-allocated index
+ * @param array Array to index
+ * @param key_fn Returns the key of an element
+ * @param ctx Opaque state passed to key_fn
+ * @param allocator Allocator for the table, or NULL for the C library
+ */
+static inline void init_hash_index_fn(HashIndex* index, DynArray* array, HashKeyFn key_fn, void* ctx,
+                                      const Allocator* allocator) {
+    init_hash_index(index, array, 0, 0, allocator);
+    index->key_fn = key_fn;
+    index->key_ctx = ctx;
+}
+
+/**
+ * Indexes a DynArray of T by the integer field T.field, e.g.
+ * HASH_INDEX_INIT_BY(&index, &users, User, id, NULL).
+ */
+#define HASH_INDEX_INIT_BY(index, array, T, field, allocator)                   \
+    init_hash_index((index), (array), offsetof(T, field), sizeof(((T*)0)->field), (allocator))
+
+/**
+ * Returns the key of element idx of the indexed array.
+ */
+static inline uint64_t key_hash_index(const HashIndex* index, size_t idx) {
+    const char* elem = (const char*)index->array->items + idx * index->array->size;
+    if (index->key_size == 0) {
+        return index->key_fn(elem, index->key_ctx);
+    }
+    elem += index->key_offset;
+    switch (index->key_size) {
+    case 1: { uint8_t k; memcpy(&k, elem, 1); return k; }
+    case 2: { uint16_t k; memcpy(&k, elem, 2); return k; }
+    case 4: { uint32_t k; memcpy(&k, elem, 4); return k; }
+    default: { uint64_t k; memcpy(&k, elem, 8); return k; }
+    }
+}
+
+/**
+ * Mixes a key into a well-distributed hash (splitmix64 finalizer), so
+ * sequential ids do not fill neighbouring slots.
+ */
+static inline uint64_t mix_hash_index(uint64_t key) {
+    key ^= key >> 30;
+    key *= 0xbf58476d1ce4e5b9u;
+    key ^= key >> 27;
+    key *= 0x94d049bb133111ebu;
+    key ^= key >> 31;
+    return key;
+}
+
+/**
+ * Distance of the entry in slot pos from its home slot.
+ */
+static inline size_t probe_dist_hash_index(const HashIndex* index, size_t pos) {
+    return (pos - (size_t)(index->slots[pos].hash & index->mask)) & index->mask;
+}
+
+/**
+ * Places an entry with Robin Hood ordering. The table must have a free slot.
+ */
+static inline void place_hash_index(HashIndex* index, HashIndexSlot entry) {
+    size_t pos = (size_t)(entry.hash & index->mask);
+    for (size_t dist = 0;; ++dist, pos = (pos + 1) & index->mask) {
+        HashIndexSlot* slot = &index->slots[pos];
+        if (slot->idx == HASH_INDEX_EMPTY) {
+            *slot = entry;
+            return;
+        }
+        /* Take the slot from an entry closer to its home, and carry that one on */
+        size_t slot_dist = probe_dist_hash_index(index, pos);
+        if (slot_dist < dist) {
+            HashIndexSlot displaced = *slot;
+            *slot = entry;
+            entry = displaced;
+            dist = slot_dist;
+        }
+    }
+}
+
+/**
+ * Resizes the table to nslots (a power of two), rehashing from the stored hashes.
+ *
+ * @return 1 on success, 0 if the allocation failed (the index is unchanged)
+ */
+static inline int rehash_hash_index(HashIndex* index, size_t nslots) {
+    if (nslots > (size_t)-1 / sizeof(HashIndexSlot)) {
+        return 0;
+    }
+    HashIndexSlot* slots = allocate(index->allocator, nslots * sizeof(HashIndexSlot), 0);
+    if (slots == NULL) {
+        return 0;
+    }
+    for (size_t i = 0; i < nslots; ++i) {
+        slots[i].idx = HASH_INDEX_EMPTY;
+    }
+
+    HashIndexSlot* old = index->slots;
+    size_t old_slots = old != NULL ? index->mask + 1 : 0;
+    index->slots = slots;
+    index->mask = nslots - 1;
+    for (size_t i = 0; i < old_slots; ++i) {
+        if (old[i].idx != HASH_INDEX_EMPTY) {
+            place_hash_index(index, old[i]);
+        }
+    }
+    deallocate(index->allocator, old, old_slots * sizeof(HashIndexSlot));
+    return 1;
+}
+
+/**
+ * Ensures the index can hold n entries without growing the table.
+ *
+ * @param index Pointer to the index
+ * @param n Number of entries to make room for
+ * @return 1 on success, 0 if the allocation failed
+ */
+static inline int reserve_hash_index(HashIndex* index, size_t n) {
+    size_t nslots = HASH_INDEX_MIN_SLOTS;
+    while (nslots / HASH_INDEX_LOAD_DEN * HASH_INDEX_LOAD_NUM < n) {
+        if (nslots > ((size_t)-1 >> 1)) {
+            return 0;
+        }
+        nslots <<= 1;
+    }
+    if (index->slots != NULL && nslots <= index->mask + 1) {
+        return 1;
+    }
+    return rehash_hash_index(index, nslots);
+}
+
+/**
+ * Adds element idx of the array to the index.
+ *
+ * @param index Pointer to the index
+ * @param idx Index of an element already in the array
+ * @return 1 on success, 0 if the table could not grow
+ */
+static inline int insert_hash_index(HashIndex* index, size_t idx) {
+    if (!reserve_hash_index(index, index->count + 1)) {
+        return 0;
+    }
+    HashIndexSlot entry = {idx, mix_hash_index(key_hash_index(index, idx))};
+    place_hash_index(index, entry);
+    index->count++;
+    return 1;
+}
+
+/**
+ * Finds the element with the given key.
+ *
+ * @param index Pointer to the index
+ * @param key Key to look up
+ * @return Index of a matching element, or HASH_INDEX_NOT_FOUND
+ */
+static inline size_t find_hash_index(const HashIndex* index, uint64_t key) {
+    if (index->count == 0) {
+        return HASH_INDEX_NOT_FOUND;
+    }
+    /* A negative lookup key arrives sign-extended; stored keys are zero-extended */
+    if (index->key_size != 0 && index->key_size < 8) {
+        key &= ((uint64_t)1 << (index->key_size * 8)) - 1;
+    }
+    uint64_t hash = mix_hash_index(key);
+    size_t pos = (size_t)(hash & index->mask);
+    for (size_t dist = 0;; ++dist, pos = (pos + 1) & index->mask) {
+        const HashIndexSlot* slot = &index->slots[pos];
+        /* Robin Hood order: a key cannot lie beyond an entry closer to its home */
+        if (slot->idx == HASH_INDEX_EMPTY || probe_dist_hash_index(index, pos) < dist) {
+            return HASH_INDEX_NOT_FOUND;
+        }
+        if (slot->hash == hash && key_hash_index(index, slot->idx) == key) {
+            return slot->idx;
+        }
+    }
+}
+
+/**
+ * Finds the element with the given key and returns a pointer to it.
+ *
+ * @param index Pointer to the index
+ * @param key Key to look up
+ * @return Pointer to a matching element in the array, or NULL
+ */
+static inline void* lookup_hash_index(const HashIndex* index, uint64_t key) {
+    size_t idx = find_hash_index(index, key);
+    if (idx == HASH_INDEX_NOT_FOUND) {
+        return NULL;
+    }
+    return (char*)index->array->items + idx * index->array->size;
+}
+
+/**
+ * Returns the slot holding element idx (whose key must be unchanged since it was indexed).
+ */
+static inline size_t slot_of_hash_index(const HashIndex* index, size_t idx) {
+    size_t pos = (size_t)(mix_hash_index(key_hash_index(index, idx)) & index->mask);
+    while (index->slots[pos].idx != idx) {
+        pos = (pos + 1) & index->mask;
+    }
+    return pos;
+}
+
+/**
+ * Removes element idx from the index. Following entries that are away from
+ * their home slot shift back one place, so no tombstones are left behind.
+ *
+ * @param index Pointer to the index
+ * @param idx Index of an element currently in the index
+ */
+static inline void erase_hash_index(HashIndex* index, size_t idx) {
+    size_t pos = slot_of_hash_index(index, idx);
+    for (;;) {
+        size_t next = (pos + 1) & index->mask;
+        if (index->slots[next].idx == HASH_INDEX_EMPTY || probe_dist_hash_index(index, next) == 0) {
+            break;
+        }
+        index->slots[pos] = index->slots[next];
+        pos = next;
+    }
+    index->slots[pos].idx = HASH_INDEX_EMPTY;
+    index->count--;
+}
+
+/**
+ * Re-indexes every element of the array in one pass: the table is sized once
+ * up front, the array is read sequentially, and the home slot of an element
+ * a few positions ahead is prefetched to overlap the table's cache misses.
+ *
+ * @param index Pointer to the index
+ * @return 1 on success, 0 if the table could not be allocated (the index is then empty)
+ */
+static inline int build_hash_index(HashIndex* index) {
+    size_t n = index->array->count;
+    if (index->slots != NULL) {
+        for (size_t i = 0; i <= index->mask; ++i) {
+            index->slots[i].idx = HASH_INDEX_EMPTY;
+        }
+    }
+    index->count = 0;
+    if (!reserve_hash_index(index, n)) {
+        return 0;
+    }
+
+    for (size_t i = 0; i < n; ++i) {
+        if (i + HASH_INDEX_PREFETCH_DISTANCE < n) {
+            uint64_t ahead = mix_hash_index(key_hash_index(index, i + HASH_INDEX_PREFETCH_DISTANCE));
+            __builtin_prefetch(&index->slots[ahead & index->mask], 1);
+        }
+        HashIndexSlot entry = {i, mix_hash_index(key_hash_index(index, i))};
+        place_hash_index(index, entry);
+    }
+    index->count = n;
+    return 1;
+}
+
+/**
+ * Appends an element to the indexed array and indexes it.
+ *
+ * @param index Pointer to the index
+ * @param val Pointer to the element to add
+ * @return 1 on success, 0 if the array or the table could not grow (both are unchanged)
+ */
+static inline int push_hash_index(HashIndex* index, void* val) {
+    /* Grow the table first, so a failure leaves the array untouched */
+    if (!reserve_hash_index(index, index->count + 1) || !push_dyn_array(index->array, val)) {
+        return 0;
+    }
+    return insert_hash_index(index, index->array->count - 1);
+}
+
+/**
+ * Removes the last element of the indexed array and its index entry.
+ *
+ * @param index Pointer to the index
+ * @param popped Optional pointer where the removed value will be copied
+ * @return 1 on success, 0 if the array is empty
+ */
+static inline int pop_hash_index(HashIndex* index, void* popped) {
+    if (index->array->count == 0) {
+        return 0;
+    }
+    erase_hash_index(index, index->array->count - 1);
+    return pop_dyn_array(index->array, popped);
+}
+
+/**
+ * Swap-removes element idx (see swap_remove_dyn_array) and updates the index:
+ * the removed element's entry is erased and the moved last element's entry
+ * is renumbered in place.
+ *
+ * @param index Pointer to the index
+ * @param idx Index of the element to remove
+ * @param removed Optional pointer where the removed value will be copied
+ * @return 1 on success, 0 if idx is out of bounds
+ */
+static inline int swap_remove_hash_index(HashIndex* index, size_t idx, void* removed) {
+    size_t last = index->array->count - 1;
+    if (idx >= index->array->count) {
+        return 0;
+    }
+    erase_hash_index(index, idx);
+    if (idx != last) {
+        index->slots[slot_of_hash_index(index, last)].idx = idx;
+    }
+    return swap_remove_dyn_array(index->array, idx, removed);
+}
+
+/**
+ * Frees the table. The array is not touched.
+ *
+ * @param index Pointer to the index
+ */
+static inline void free_hash_index(HashIndex* index) {
+    if (index->slots != NULL) {
+        deallocate(index->allocator, index->slots, (index->mask + 1) * sizeof(HashIndexSlot));
+    }
+    index->slots = NULL;
+    index->mask = 0;
+    index->count = 0;
+}
+
+#endif /* DS_HASH_INDEX_H */
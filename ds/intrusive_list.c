@@ -0,0 +1,76 @@
+/*
+ * Intrusive Doubly-Linked List Example
+ *
+ * This file demonstrates keeping User records in two lists at once by
+ * embedding the list links in the records themselves. The implementation supports:
+ *
+ * - Pushing at either end and unlinking any element in O(1)
+ * - Moving an element to the front or back in O(1)
+ * - Splicing a whole list onto another in O(1)
+ *
+ * Key concepts demonstrated:
+ * - Intrusive containers: links embedded in the element, no node allocations
+ * - container_of: recovering the element from a pointer to its link
+ * - Circular lists with a sentinel to avoid edge cases
+ */
+
+#include <stdio.h>
+
+#include "intrusive_list.h"
+#include "user.h"
+
+/**
+ * A user that can be in an "online" list and an "admin" list at the same time.
+ */
+typedef struct {
+    User user;
+    ListLink online;   /* Link in the online list */
+    ListLink admins;   /* Link in the admin list */
+} Member;
+
+/**
+ * Prints the users of a list threaded through the online links.
+ */
+static void print_online(const char* title, const IntrusiveList* list) {
+    printf("%s:", title);
+    INTRUSIVE_LIST_FOR_EACH(link, list) {
+        printf(" %s", CONTAINER_OF(link, Member, online)->user.name);
+    }
+    printf("\n");
+}
+
+int main(void) {
+    Member members[] = {
+        {{"meg", 1}, {NULL, NULL}, {NULL, NULL}},
+        {{"bobo", 2}, {NULL, NULL}, {NULL, NULL}},
+        {{"rigby", 3}, {NULL, NULL}, {NULL, NULL}},
+        {{"mordecai", 4}, {NULL, NULL}, {NULL, NULL}},
+    };
+
+    IntrusiveList online;
+    IntrusiveList admins;
+    init_intrusive_list(&online);
+    init_intrusive_list(&admins);
+    for (size_t i = 0; i < 4; ++i) {
+        push_back_intrusive_list(&online, &members[i].online);
+    }
+    push_back_intrusive_list(&admins, &members[3].admins);
+    print_online("Online", &online);
+
+    /* O(1) removal and reordering, no search and no allocation */
+    unlink_intrusive_list(&members[1].online);
+    move_to_front_intrusive_list(&online, &members[2].online);
+    print_online("After unlink and move to front", &online);
+
+    /* The same element is still in the admin list through its other link */
+    Member* admin = CONTAINER_OF(front_intrusive_list(&admins), Member, admins);
+    printf("First admin: %s\n", admin->user.name);
+
+    /* Splice a second list onto the first in O(1) */
+    IntrusiveList later;
+    init_intrusive_list(&later);
+    push_back_intrusive_list(&later, &members[1].online);
+    splice_intrusive_list(&online, &later);
+    print_online("After splice", &online);
+    return 0;
+}
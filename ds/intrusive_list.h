@@ -0,0 +1,178 @@
+/*
+ * Intrusive Doubly-Linked List
+ *
+ * Instead of allocating nodes that point to data, the caller embeds a
+ * ListLink in its own struct and the list chains those links together.
+ * CONTAINER_OF recovers the enclosing struct from a link. The list never
+ * allocates, an element can be in several lists through several links, and
+ * unlinking, moving and splicing are all O(1) pointer updates.
+ *
+ * The list is circular around a sentinel link owned by the IntrusiveList,
+ * so no operation needs a special case for the first or last element.
+ */
+
+#ifndef DS_INTRUSIVE_LIST_H
+#define DS_INTRUSIVE_LIST_H
+
+#include <stddef.h>
+
+/**
+ * Pointer to the struct of type T whose member field member is at ptr.
+ */
+#define CONTAINER_OF(ptr, T, member) ((T*)((char*)(ptr) - offsetof(T, member)))
+
+/**
+ * Link embedded in each element. Both pointers are NULL while unlinked.
+ */
+typedef struct ListLink {
+    struct ListLink* prev;  /* Previous link, or the list's sentinel for the first element */
+    struct ListLink* next;  /* Next link, or the list's sentinel for the last element */
+} ListLink;
+
+/**
+ * List control structure: a sentinel link whose next is the first element
+ * and whose prev is the last. Must not be copied or moved while non-empty.
+ */
+typedef struct {
+    ListLink sentinel;
+} IntrusiveList;
+
+/**
+ * Initializes an empty list.
+ *
+ * @param list Pointer to caller-allocated list
+ */
+static inline void init_intrusive_list(IntrusiveList* list) {
+    list->sentinel.prev = &list->sentinel;
+    list->sentinel.next = &list->sentinel;
+}
+
+/**
+ * Returns nonzero if the list has no elements.
+ */
+static inline int is_empty_intrusive_list(const IntrusiveList* list) {
+    return list->sentinel.next == &list->sentinel;
+}
+
+/**
+ * Inserts link between two adjacent links.
+ */
+static inline void insert_between_intrusive_list(ListLink* link, ListLink* prev, ListLink* next) {
+    link->prev = prev;
+    link->next = next;
+    prev->next = link;
+    next->prev = link;
+}
+
+/**
+ * Inserts an unlinked link at the front.
+ *
+ * @param list Pointer to the list
+ * @param link Link to insert, must not be in any list
+ */
+static inline void push_front_intrusive_list(IntrusiveList* list, ListLink* link) {
+    insert_between_intrusive_list(link, &list->sentinel, list->sentinel.next);
+}
+
+/**
+ * Inserts an unlinked link at the back.
+ *
+ * @param list Pointer to the list
+ * @param link Link to insert, must not be in any list
+ */
+static inline void push_back_intrusive_list(IntrusiveList* list, ListLink* link) {
+    insert_between_intrusive_list(link, list->sentinel.prev, &list->sentinel);
+}
+
+/**
+ * Removes a link from whatever list it is in, in O(1).
+ *
+ * @param link Link to remove, must be in a list
+ */
+static inline void unlink_intrusive_list(ListLink* link) {
+    link->prev->next = link->next;
+    link->next->prev = link->prev;
+    link->prev = NULL;
+    link->next = NULL;
+}
+
+/**
+ * Moves a link that is already in the list to the front.
+ *
+ * @param list Pointer to the list containing link
+ * @param link Link to move
+ */
+static inline void move_to_front_intrusive_list(IntrusiveList* list, ListLink* link) {
+    if (list->sentinel.next == link) {
+        return;
+    }
+    unlink_intrusive_list(link);
+    push_front_intrusive_list(list, link);
+}
+
+/**
+ * Moves a link that is already in the list to the back.
+ *
+ * @param list Pointer to the list containing link
+ * @param link Link to move
+ */
+static inline void move_to_back_intrusive_list(IntrusiveList* list, ListLink* link) {
+    if (list->sentinel.prev == link) {
+        return;
+    }
+    unlink_intrusive_list(link);
+    push_back_intrusive_list(list, link);
+}
+
+/**
+ * Moves every element of src to the back of dst in O(1), preserving order.
+ *
+ * @param dst List to append to
+ * @param src List to take the elements from, empty afterwards
+ */
+static inline void splice_intrusive_list(IntrusiveList* dst, IntrusiveList* src) {
+    if (is_empty_intrusive_list(src)) {
+        return;
+    }
+    ListLink* first = src->sentinel.next;
+    ListLink* last = src->sentinel.prev;
+    first->prev = dst->sentinel.prev;
+    dst->sentinel.prev->next = first;
+    last->next = &dst->sentinel;
+    dst->sentinel.prev = last;
+    init_intrusive_list(src);
+}
+
+/**
+ * Repairs the neighbours of a link whose element was moved in memory (e.g.
+ * by memcpy into another slot of an array), so they point to its new address.
+ *
+ * @param link Link at its new address, still holding its old prev/next
+ */
+static inline void relocate_intrusive_list(ListLink* link) {
+    link->prev->next = link;
+    link->next->prev = link;
+}
+
+/**
+ * Returns the first link, or NULL if the list is empty.
+ */
+static inline ListLink* front_intrusive_list(const IntrusiveList* list) {
+    return is_empty_intrusive_list(list) ? NULL : list->sentinel.next;
+}
+
+/**
+ * Returns the last link, or NULL if the list is empty.
+ */
+static inline ListLink* back_intrusive_list(const IntrusiveList* list) {
+    return is_empty_intrusive_list(list) ? NULL : list->sentinel.prev;
+}
+
+/**
+ * Iterates link over every element, front to back. The current link must not
+ * be unlinked in the loop body.
+ */
+#define INTRUSIVE_LIST_FOR_EACH(link, list)                                     \
+    for (ListLink* link = (list)->sentinel.next; link != &(list)->sentinel; link = link->next)
+
+#endif /* DS_INTRUSIVE_LIST_H */
@@ -5,68 +5,27 @@
  * with proper memory management and function pointers. The implementation supports:
  *
  * - Creating and adding nodes to a linked list
- * - Traversing the list with recursive functions
+ * - Traversing the list iteratively, with optional early exit
  * - Function pointer usage for customizable node processing
  * - Proper handling of head/tail pointers
+ * - An unrolled variant that packs several values per cache-line sized node
  *
  * Key concepts demonstrated:
  * - Self-referential structures
  * - Function pointers for flexible node processing
  * - Proper struct initialization
  * - Dynamic memory allocation
- * - Recursive list traversal
+ * - Pool/slab allocation of nodes with a free list for reuse
+ * - Iterative list traversal with caller context (no globals)
+ * - Batched traversal with software prefetching, and linearizing into a DynArray
+ *
+ * The implementation lives in linked_list.h (header-only) so other programs,
+ * such as the benchmarks in bench/, can reuse it; this file is the demo.
  */
 
-#include <stddef.h>
 #include <stdio.h>
-#include <stdlib.h>
-
-/**
- * Node structure for the linked list.
- * Uses self-referential structure definition for the next pointer.
- */
-typedef struct IntNode {
-    struct IntNode* next;  /* Pointer to next node, NULL if last node */
-    int value;            /* Integer value stored in this node */
-} IntNode;
-
-/**
- * List control structure that maintains pointers to both ends.
- * Tracking both head and tail allows O(1) insertions at either end.
- */
-typedef struct {
-    IntNode* head;  /* Pointer to first node, NULL if list is empty */
-    IntNode* tail;  /* Pointer to last node, NULL if list is empty */
-} IntList;
-
-/**
- * Function pointer type for node processing functions.
- * Allows customizable operations on nodes during traversal.
- */
-typedef void (*NodeFn)(IntNode* node);
 
-/**
- * Adds a new node to the end of the list.
- * Handles both empty and non-empty list cases.
- * 
- * @param list Pointer to the list control structure
- * @param node_val Value to store in the new node
- */
-void push_node(IntList* list, int node_val) {
-    /* Allocate and initialize new node */
-    IntNode* node = malloc(sizeof(IntNode));
-    node->value = node_val;
-    node->next = NULL;
-
-    /* Handle empty list case */
-    if (list->head == NULL) {
-        list->head = node;
-    } else {
-        /* Append to existing list */
-        list->tail->next = node;
-    }
-    list->tail = node;
-}
+#include "linked_list.h"
 
 /**
  * Simple node printing function.
@@ -79,19 +38,32 @@ void print_node(IntNode* node) {
 }
 
 /**
- * Recursively walks the list, applying the provided function to each node.
- * 
- * @param node Starting node for the walk
- * @param pfn Function to apply to each node
+ * Example visitor: stops at the first node whose value exceeds *threshold.
+ * Can be passed as a NodeVisitFn function pointer.
+ *
+ * @param node Pointer to the current node
+ * @param ctx Pointer to the int threshold
+ * @return NODE_VISIT_STOP on a match, NODE_VISIT_CONTINUE otherwise
  */
-void process_list(IntNode* node, NodeFn nfn) {
-    /* Process current node */
-    nfn(node);
-    
-    /* Recursively process remaining nodes */
-    if (node->next != NULL) {
-        process_list(node->next, nfn);
+int find_greater_than(IntNode* node, void* ctx) {
+    int threshold = *(int*)ctx;
+    return node->value > threshold ? NODE_VISIT_STOP : NODE_VISIT_CONTINUE;
+}
+
+/**
+ * Example batch callback: adds a batch of values to the long long sum in ctx.
+ * Can be passed as a ValueBatchFn function pointer.
+ *
+ * @param values Contiguous values of the current batch
+ * @param n Number of values in the batch
+ * @param ctx Pointer to the running long long sum
+ */
+void sum_values(const int* values, size_t n, void* ctx) {
+    long long sum = 0;
+    for (size_t i = 0; i < n; ++i) {
+        sum += values[i];
     }
+    *(long long*)ctx += sum;
 }
 
 /**
@@ -113,7 +85,7 @@ void some_fn(IntList* list) {
  */
 int main(void) {
     /* Initialize empty list */
-    IntList numbers = {NULL, NULL};
+    IntList numbers = {NULL, NULL, NULL};
     
     /* Add some numbers to the list */
     push_node(&numbers, 5);
@@ -127,6 +99,58 @@ int main(void) {
     /* Walk and print the entire list */
     process_list(numbers.head, print_node);
 
-    /* Memory cleanup would go here */
+    /* Search with early exit, passing the threshold through the context */
+    int threshold = 15;
+    IntNode* found = visit_list(numbers.head, find_greater_than, &threshold);
+    if (found != NULL) {
+        printf("First value > %d: %d\n", threshold, found->value);
+    }
+
+    /* Batched traversal: one callback per batch of values instead of per node */
+    long long sum = 0;
+    process_list_values(numbers.head, sum_values, &sum);
+    printf("Sum of values: %lld\n", sum);
+
+    /* Linearize for repeated scans over contiguous memory */
+    DynArray values;
+    new_dyn_array(sizeof(int), &values);
+    if (linearize_list(&numbers, &values) && values.count > 0) {
+        printf("Linearized %zu values, last: %d\n", values.count, ((int*)values.items)[values.count - 1]);
+    }
+    free_dyn_array(&values);
+
+    /* Build a list from the node pool, then hand it back in O(1) */
+    IntNodePool pool;
+    init_int_node_pool(&pool, 0);
+    IntList pooled = {NULL, NULL, NULL};
+    for (int i = 1; i <= 3; ++i) {
+        push_node_pooled(&pool, &pooled, i * 100);
+    }
+    process_list(pooled.head, print_node);
+    release_list_pooled(&pool, &pooled);
+    free_int_node_pool(&pool);
+
+    /* Unrolled list: fill a few nodes, drop the odd values, print the rest */
+    UnrolledIntList unrolled = {NULL, NULL, 0, NULL};
+    for (int i = 0; i < 30; ++i) {
+        push_unrolled(&unrolled, i);
+    }
+    UnrolledIntIter it = begin_unrolled_iter(&unrolled);
+    while (it.node != NULL) {
+        if (it.node->values[it.idx] % 2 != 0) {
+            remove_unrolled_iter(&unrolled, &it);
+        } else {
+            next_unrolled_iter(&it);
+        }
+    }
+    printf("Unrolled list (%zu values):", unrolled.count);
+    for (it = begin_unrolled_iter(&unrolled); it.node != NULL; next_unrolled_iter(&it)) {
+        printf(" %d", it.node->values[it.idx]);
+    }
+    printf("\n");
+    free_unrolled_list(&unrolled);
+
+    /* Release the heap-allocated nodes */
+    free_list(&numbers);
     return 0;
 }
@@ -0,0 +1,564 @@
+/*
+ * Singly-Linked List
+ *
+ * Header-only implementation of IntList, the IntNodePool slab allocator and
+ * UnrolledIntList. All functions are static inline so that any program can
+ * include this header directly; see linked_list.c for a walkthrough and demo.
+ */
+
+#ifndef DS_LINKED_LIST_H
+#define DS_LINKED_LIST_H
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "allocator.h"
+#include "container_stats.h"
+#include "dyn_array.h"
+
+/**
+ * Node structure for the linked list.
+ * Uses self-referential structure definition for the next pointer.
+ */
+typedef struct IntNode {
+    struct IntNode* next;  /* Pointer to next node, NULL if last node */
+    int value;            /* Integer value stored in this node */
+} IntNode;
+
+/**
+ * List control structure that maintains pointers to both ends.
+ * Tracking both head and tail allows O(1) insertions at either end.
+ */
+typedef struct {
+    IntNode* head;  /* Pointer to first node, NULL if list is empty */
+    IntNode* tail;  /* Pointer to last node, NULL if list is empty */
+    const Allocator* allocator;  /* Where push_node gets nodes from, NULL for malloc/free */
+} IntList;
+
+/**
+ * Function pointer type for node processing functions.
+ * Allows customizable operations on nodes during traversal.
+ */
+typedef void (*NodeFn)(IntNode* node);
+
+/**
+ * Function pointer type for stateful, stoppable traversals.
+ * Receives the caller's context and returns whether to keep walking.
+ */
+typedef int (*NodeVisitFn)(IntNode* node, void* ctx);
+
+#define NODE_VISIT_CONTINUE 1
+#define NODE_VISIT_STOP 0
+
+/**
+ * Batch callbacks for process_list_batched and process_list_values: receive
+ * up to LIST_BATCH_SIZE nodes or values at a time instead of one per call,
+ * so the loop over the batch can be inlined and vectorized.
+ */
+typedef void (*NodeBatchFn)(IntNode** nodes, size_t n, void* ctx);
+typedef void (*ValueBatchFn)(const int* values, size_t n, void* ctx);
+
+#define LIST_BATCH_SIZE 64
+
+/**
+ * Adds a new node to the end of the list.
+ * Handles both empty and non-empty list cases.
+ * 
+ * @param list Pointer to the list control structure
+ * @param node_val Value to store in the new node
+ */
+static inline void push_node(IntList* list, int node_val) {
+    /* Allocate and initialize new node */
+    IntNode* node = allocate(list->allocator, sizeof(IntNode), 0);
+    node->value = node_val;
+    node->next = NULL;
+
+    /* Handle empty list case */
+    if (list->head == NULL) {
+        list->head = node;
+    } else {
+        /* Append to existing list */
+        list->tail->next = node;
+    }
+    list->tail = node;
+}
+
+/**
+ * Frees every node of a push_node-built list and resets it to empty.
+ * Not for pooled lists, use release_list_pooled for those.
+ *
+ * @param list Pointer to the list control structure
+ */
+static inline void free_list(IntList* list) {
+    IntNode* node = list->head;
+    while (node != NULL) {
+        IntNode* next = node->next;
+        deallocate(list->allocator, node, sizeof(IntNode));
+        node = next;
+    }
+    list->head = NULL;
+    list->tail = NULL;
+}
+
+/**
+ * Slab of nodes carved out of one contiguous allocation.
+ * Slabs are chained so the pool can free them all at the end.
+ */
+typedef struct IntNodeSlab {
+    struct IntNodeSlab* next;  /* Previously allocated slab, NULL if first */
+    size_t used;               /* Number of nodes handed out from this slab */
+    size_t cap;                /* Number of nodes in this slab */
+    IntNode nodes[];           /* Node storage (flexible array member) */
+} IntNodeSlab;
+
+/**
+ * Pool allocator for IntNode.
+ * Hands out nodes from large contiguous slabs (good traversal locality,
+ * no per-node allocator metadata) and recycles released nodes through a free list.
+ */
+typedef struct {
+    IntNodeSlab* slabs;   /* Most recently allocated slab, NULL if none */
+    IntNode* free_list;   /* Released nodes, chained through their next pointers */
+    size_t slab_nodes;    /* Number of nodes per slab */
+    const Allocator* allocator;  /* Where slabs come from, NULL for malloc/free */
+} IntNodePool;
+
+#define INT_NODE_POOL_DEFAULT_SLAB 4096
+
+/**
+ * Initializes an empty pool. No memory is allocated until the first node is requested.
+ * Slabs come from malloc; set pool->allocator before the first allocation to change that.
+ *
+ * @param pool Pointer to caller-allocated pool structure
+ * @param slab_nodes Number of nodes per slab (0 = INT_NODE_POOL_DEFAULT_SLAB)
+ */
+static inline void init_int_node_pool(IntNodePool* pool, size_t slab_nodes) {
+    pool->slabs = NULL;
+    pool->free_list = NULL;
+    pool->slab_nodes = slab_nodes ? slab_nodes : INT_NODE_POOL_DEFAULT_SLAB;
+    pool->allocator = NULL;
+}
+
+/**
+ * Takes a node from the pool: recycled nodes first, then the current slab,
+ * allocating a new slab only when both are exhausted.
+ *
+ * @param pool Pointer to the pool
+ * @return Uninitialized node, or NULL if a new slab could not be allocated
+ */
+static inline IntNode* alloc_pooled_node(IntNodePool* pool) {
+    /* Reuse a released node if there is one */
+    if (pool->free_list != NULL) {
+        IntNode* node = pool->free_list;
+        pool->free_list = node->next;
+        CONTAINER_STATS_POOL(pool_free_list_hits);
+        return node;
+    }
+
+    /* Start a new slab when the current one is full */
+    if (pool->slabs == NULL || pool->slabs->used == pool->slabs->cap) {
+        IntNodeSlab* slab = allocate(pool->allocator,
+                                     sizeof(IntNodeSlab) + pool->slab_nodes * sizeof(IntNode), 0);
+        if (slab == NULL) {
+            return NULL;
+        }
+        slab->next = pool->slabs;
+        slab->used = 0;
+        slab->cap = pool->slab_nodes;
+        pool->slabs = slab;
+        CONTAINER_STATS_POOL(pool_new_slabs);
+    }
+
+    /* Bump-allocate from the current slab */
+    CONTAINER_STATS_POOL(pool_slab_hits);
+    return &pool->slabs->nodes[pool->slabs->used++];
+}
+
+/**
+ * Returns a single node to the pool's free list.
+ *
+ * @param pool Pointer to the pool the node was allocated from
+ * @param node Node to release
+ */
+static inline void release_pooled_node(IntNodePool* pool, IntNode* node) {
+    node->next = pool->free_list;
+    pool->free_list = node;
+}
+
+/**
+ * Takes n contiguous nodes from the pool in one step, for bulk loads.
+ * Comes from the current slab if it has room, otherwise from a new slab of at
+ * least n nodes; the old slab's unused nodes go to the free list so nothing is lost.
+ *
+ * @param pool Pointer to the pool
+ * @param n Number of nodes needed (must be > 0)
+ * @return First of n uninitialized, adjacent nodes, or NULL if a slab could not be allocated
+ */
+static inline IntNode* alloc_pooled_nodes(IntNodePool* pool, size_t n) {
+    if (pool->slabs != NULL && pool->slabs->cap - pool->slabs->used >= n) {
+        IntNode* nodes = &pool->slabs->nodes[pool->slabs->used];
+        pool->slabs->used += n;
+        CONTAINER_STATS_POOL(pool_slab_hits);
+        return nodes;
+    }
+
+    size_t cap = n > pool->slab_nodes ? n : pool->slab_nodes;
+    if (cap > ((size_t)-1 - sizeof(IntNodeSlab)) / sizeof(IntNode)) {
+        return NULL;
+    }
+    IntNodeSlab* slab = allocate(pool->allocator, sizeof(IntNodeSlab) + cap * sizeof(IntNode), 0);
+    if (slab == NULL) {
+        return NULL;
+    }
+
+    /* Retire the remainder of the current slab */
+    if (pool->slabs != NULL) {
+        while (pool->slabs->used < pool->slabs->cap) {
+            release_pooled_node(pool, &pool->slabs->nodes[pool->slabs->used++]);
+        }
+    }
+    slab->next = pool->slabs;
+    slab->used = n;
+    slab->cap = cap;
+    pool->slabs = slab;
+    CONTAINER_STATS_POOL(pool_new_slabs);
+    return slab->nodes;
+}
+
+/**
+ * Adds a new node taken from the pool to the end of the list.
+ *
+ * @param pool Pointer to the pool to allocate from
+ * @param list Pointer to the list control structure
+ * @param node_val Value to store in the new node
+ * @return 1 on success, 0 if the pool could not allocate a node
+ */
+static inline int push_node_pooled(IntNodePool* pool, IntList* list, int node_val) {
+    IntNode* node = alloc_pooled_node(pool);
+    if (node == NULL) {
+        return 0;
+    }
+    node->value = node_val;
+    node->next = NULL;
+
+    if (list->head == NULL) {
+        list->head = node;
+    } else {
+        list->tail->next = node;
+    }
+    list->tail = node;
+    return 1;
+}
+
+/**
+ * Gives every node of a pooled list back to the pool in O(1).
+ * The list is already chained through next pointers, so it is spliced
+ * onto the free list as a whole instead of being walked node by node.
+ *
+ * @param pool Pointer to the pool the nodes were allocated from
+ * @param list Pointer to the list, reset to empty afterwards
+ */
+static inline void release_list_pooled(IntNodePool* pool, IntList* list) {
+    if (list->head == NULL) {
+        return;
+    }
+    list->tail->next = pool->free_list;
+    pool->free_list = list->head;
+    list->head = NULL;
+    list->tail = NULL;
+}
+
+/**
+ * Frees all slabs owned by the pool. Every node from the pool becomes invalid.
+ *
+ * @param pool Pointer to the pool
+ */
+static inline void free_int_node_pool(IntNodePool* pool) {
+    IntNodeSlab* slab = pool->slabs;
+    while (slab != NULL) {
+        IntNodeSlab* next = slab->next;
+        deallocate(pool->allocator, slab, sizeof(IntNodeSlab) + slab->cap * sizeof(IntNode));
+        slab = next;
+    }
+    pool->slabs = NULL;
+    pool->free_list = NULL;
+}
+
+/**
+ * Walks the list, applying the provided function to each node.
+ * Iterative, so list length is not limited by stack depth.
+ * 
+ * @param node Starting node for the walk (NULL for an empty list)
+ * @param nfn Function to apply to each node
+ */
+static inline void process_list(IntNode* node, NodeFn nfn) {
+    CONTAINER_STATS_COUNTER(visited);
+    while (node != NULL) {
+        /* Read next first so the callback may release or relink the node */
+        IntNode* next = node->next;
+        nfn(node);
+        node = next;
+        CONTAINER_STATS_INC(visited);
+    }
+    CONTAINER_STATS_TRAVERSAL(visited);
+}
+
+/**
+ * Walks the list, handing the callback batches of up to LIST_BATCH_SIZE nodes.
+ * The walk itself is a tight pointer-chasing loop that prefetches the node
+ * after next, and the indirect call is paid once per batch.
+ *
+ * @param node Starting node for the walk (NULL for an empty list)
+ * @param bfn Callback receiving each batch of nodes in list order; it may
+ *            modify or release the nodes, which have all been read already
+ * @param ctx Opaque caller state passed through to every call
+ */
+static inline void process_list_batched(IntNode* node, NodeBatchFn bfn, void* ctx) {
+    IntNode* batch[LIST_BATCH_SIZE];
+    while (node != NULL) {
+        size_t n = 0;
+        while (node != NULL && n < LIST_BATCH_SIZE) {
+            IntNode* next = node->next;
+            if (next != NULL) {
+                __builtin_prefetch(next->next);
+            }
+            batch[n++] = node;
+            node = next;
+        }
+        bfn(batch, n, ctx);
+    }
+}
+
+/**
+ * Walks the list, handing the callback its values in contiguous batches of up
+ * to LIST_BATCH_SIZE ints, for read-only scans such as sums and filters.
+ *
+ * @param node Starting node for the walk (NULL for an empty list)
+ * @param bfn Callback receiving each batch of values in list order
+ * @param ctx Opaque caller state passed through to every call
+ */
+static inline void process_list_values(const IntNode* node, ValueBatchFn bfn, void* ctx) {
+    int batch[LIST_BATCH_SIZE];
+    while (node != NULL) {
+        size_t n = 0;
+        while (node != NULL && n < LIST_BATCH_SIZE) {
+            const IntNode* next = node->next;
+            if (next != NULL) {
+                __builtin_prefetch(next->next);
+            }
+            batch[n++] = node->value;
+            node = next;
+        }
+        bfn(batch, n, ctx);
+    }
+}
+
+/**
+ * Copies the list's values into a DynArray of int in one pass, for workloads
+ * that scan the same data repeatedly. Values are appended in batches, so the
+ * array grows at most once per LIST_BATCH_SIZE values.
+ *
+ * @param list Pointer to the list
+ * @param out Array of int (element size sizeof(int)) the values are appended to
+ * @return 1 on success, 0 if out has the wrong element size or could not grow
+ *         (out then holds a prefix of the values)
+ */
+static inline int linearize_list(const IntList* list, DynArray* out) {
+    if (out->size != sizeof(int)) {
+        return 0;
+    }
+    int batch[LIST_BATCH_SIZE];
+    const IntNode* node = list->head;
+    while (node != NULL) {
+        size_t n = 0;
+        while (node != NULL && n < LIST_BATCH_SIZE) {
+            const IntNode* next = node->next;
+            if (next != NULL) {
+                __builtin_prefetch(next->next);
+            }
+            batch[n++] = node->value;
+            node = next;
+        }
+        if (!push_many_dyn_array(out, batch, n)) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/**
+ * Walks the list with a stateful callback that can stop early.
+ * The context pointer carries the caller's state, so searches and
+ * accumulations need no globals.
+ *
+ * @param node Starting node for the walk (NULL for an empty list)
+ * @param vfn Callback, returns NODE_VISIT_CONTINUE or NODE_VISIT_STOP
+ * @param ctx Opaque caller state passed through to every call
+ * @return Node at which the walk stopped, or NULL if it reached the end
+ */
+static inline IntNode* visit_list(IntNode* node, NodeVisitFn vfn, void* ctx) {
+    CONTAINER_STATS_COUNTER(visited);
+    while (node != NULL) {
+        IntNode* next = node->next;
+        CONTAINER_STATS_INC(visited);
+        if (vfn(node, ctx) == NODE_VISIT_STOP) {
+            CONTAINER_STATS_TRAVERSAL(visited);
+            return node;
+        }
+        node = next;
+    }
+    CONTAINER_STATS_TRAVERSAL(visited);
+    return NULL;
+}
+
+/**
+ * Number of values per unrolled node, chosen so that one node
+ * (next pointer + count + values) fills a 64-byte cache line.
+ */
+#define UNROLLED_NODE_BYTES 64
+#define UNROLLED_NODE_VALUES ((UNROLLED_NODE_BYTES - sizeof(void*) - sizeof(int)) / sizeof(int))
+
+/**
+ * Node of an unrolled list: a small array of values per next pointer,
+ * so traversal touches one cache line per UNROLLED_NODE_VALUES elements.
+ */
+typedef struct UnrolledIntNode {
+    struct UnrolledIntNode* next;        /* Pointer to next node, NULL if last node */
+    int count;                           /* Number of values used in this node */
+    int values[UNROLLED_NODE_VALUES];    /* Values, packed from index 0 */
+} UnrolledIntNode;
+
+_Static_assert(sizeof(UnrolledIntNode) == UNROLLED_NODE_BYTES, "UnrolledIntNode must fill one cache line");
+
+/**
+ * Unrolled list control structure, mirroring IntList's head/tail shape.
+ */
+typedef struct {
+    UnrolledIntNode* head;  /* Pointer to first node, NULL if list is empty */
+    UnrolledIntNode* tail;  /* Pointer to last node, NULL if list is empty */
+    size_t count;           /* Total number of values in the list */
+    const Allocator* allocator;  /* Where nodes come from, NULL for the C library */
+} UnrolledIntList;
+
+/**
+ * Position within an unrolled list.
+ * Keeps the previous node so that emptied nodes can be unlinked in O(1).
+ */
+typedef struct {
+    UnrolledIntNode* prev;  /* Node before node, NULL if node is the head */
+    UnrolledIntNode* node;  /* Current node, NULL once past the end */
+    int idx;                /* Index of the current value in node->values */
+} UnrolledIntIter;
+
+/**
+ * Appends a value to the end of the unrolled list.
+ * Fills the tail node first and only allocates when it is full.
+ *
+ * @param list Pointer to the list control structure
+ * @param value Value to append
+ * @return 1 on success, 0 if a new node could not be allocated
+ */
+static inline int push_unrolled(UnrolledIntList* list, int value) {
+    if (list->tail == NULL || list->tail->count == (int)UNROLLED_NODE_VALUES) {
+        /* Cache-line aligned so each node spans exactly one line */
+        UnrolledIntNode* node = allocate(list->allocator, sizeof(UnrolledIntNode), UNROLLED_NODE_BYTES);
+        if (node == NULL) {
+            return 0;
+        }
+        node->next = NULL;
+        node->count = 0;
+
+        if (list->head == NULL) {
+            list->head = node;
+        } else {
+            list->tail->next = node;
+        }
+        list->tail = node;
+    }
+
+    list->tail->values[list->tail->count++] = value;
+    list->count++;
+    return 1;
+}
+
+/**
+ * Returns an iterator positioned at the first value of the list.
+ *
+ * @param list Pointer to the list
+ * @return Iterator, with node == NULL if the list is empty
+ */
+static inline UnrolledIntIter begin_unrolled_iter(UnrolledIntList* list) {
+    UnrolledIntIter it = {NULL, list->head, 0};
+    return it;
+}
+
+/**
+ * Advances the iterator to the next value.
+ *
+ * @param it Pointer to a valid iterator (it->node != NULL)
+ */
+static inline void next_unrolled_iter(UnrolledIntIter* it) {
+    if (++it->idx >= it->node->count) {
+        it->prev = it->node;
+        it->node = it->node->next;
+        it->idx = 0;
+    }
+}
+
+/**
+ * Removes the value under the iterator and moves the iterator to the next value.
+ * Values after it within the node are shifted down; a node left empty is unlinked and freed.
+ *
+ * @param list Pointer to the list
+ * @param it Pointer to a valid iterator (it->node != NULL)
+ */
+static inline void remove_unrolled_iter(UnrolledIntList* list, UnrolledIntIter* it) {
+    UnrolledIntNode* node = it->node;
+
+    /* Close the gap inside the node */
+    memmove(&node->values[it->idx], &node->values[it->idx + 1],
+            (size_t)(node->count - it->idx - 1) * sizeof(int));
+    node->count--;
+    list->count--;
+
+    if (node->count == 0) {
+        /* Unlink the empty node, fixing up head/tail as needed */
+        UnrolledIntNode* next = node->next;
+        if (it->prev == NULL) {
+            list->head = next;
+        } else {
+            it->prev->next = next;
+        }
+        if (list->tail == node) {
+            list->tail = it->prev;
+        }
+        deallocate(list->allocator, node, sizeof(UnrolledIntNode));
+        it->node = next;
+        it->idx = 0;
+    } else if (it->idx >= node->count) {
+        /* Removed the last value of this node, continue with the next one */
+        it->prev = node;
+        it->node = node->next;
+        it->idx = 0;
+    }
+}
+
+/**
+ * Frees all nodes of the unrolled list and resets it to empty.
+ *
+ * @param list Pointer to the list
+ */
+static inline void free_unrolled_list(UnrolledIntList* list) {
+    UnrolledIntNode* node = list->head;
+    while (node != NULL) {
+        UnrolledIntNode* next = node->next;
+        deallocate(list->allocator, node, sizeof(UnrolledIntNode));
+        node = next;
+    }
+    list->head = NULL;
+    list->tail = NULL;
+    list->count = 0;
+}
+
+#endif /* DS_LINKED_LIST_H */
@@ -0,0 +1,57 @@
+/*
+ * LRU Cache Example
+ *
+ * This file demonstrates caching User records by id in a fixed-capacity
+ * least-recently-used cache. The implementation supports:
+ *
+ * - O(1) get, put and remove by 64-bit key
+ * - Evicting the least recently used entry once the cache is full
+ * - No allocations after initialization
+ *
+ * Key concepts demonstrated:
+ * - Combining containers: a DynArray for storage, a HashIndex for lookup
+ *   and an intrusive list for recency order
+ * - Reusing an evicted entry's slot in place
+ * - Repairing intrusive links after an element moves in memory
+ */
+
+#include <stdio.h>
+
+#include "lru_cache.h"
+#include "user.h"
+
+int main(void) {
+    LruCache cache;
+    if (!init_lru_cache(&cache, 3, sizeof(User), NULL)) {
+        fprintf(stderr, "could not allocate the cache\n");
+        return 1;
+    }
+
+    User users[] = {{"meg", 1}, {"bobo", 2}, {"rigby", 3}, {"mordecai", 4}};
+    for (size_t i = 0; i < 3; ++i) {
+        put_lru_cache(&cache, (uint64_t)users[i].id, &users[i]);
+    }
+
+    /* Touch id 1 so id 2 becomes the least recently used, then overflow */
+    get_lru_cache(&cache, 1);
+    put_lru_cache(&cache, (uint64_t)users[3].id, &users[3]);
+    printf("After inserting id 4: id 2 %s, %zu entries, %zu eviction(s)\n",
+           peek_lru_cache(&cache, 2) != NULL ? "cached" : "evicted", count_lru_cache(&cache), cache.evictions);
+
+    User* user = get_lru_cache(&cache, 3);
+    printf("Get id 3: %s\n", user != NULL ? user->name : "miss");
+
+    remove_lru_cache(&cache, 1);
+    printf("After removing id 1: %zu entries, get id 1: %s\n", count_lru_cache(&cache),
+           get_lru_cache(&cache, 1) != NULL ? "hit" : "miss");
+
+    /* Recency order from most to least recent */
+    printf("Recency order:");
+    INTRUSIVE_LIST_FOR_EACH(link, &cache.order) {
+        printf(" %s", ((User*)CONTAINER_OF(link, LruEntry, link)->value)->name);
+    }
+    printf("\nHits: %zu, misses: %zu\n", cache.hits, cache.misses);
+
+    free_lru_cache(&cache);
+    return 0;
+}
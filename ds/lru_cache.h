@@ -0,0 +1,207 @@
+/*
+ * Fixed-Capacity LRU Cache
+ *
+ * Maps 64-bit keys to fixed-size values and evicts the least recently used
+ * entry once full. All entries live in one DynArray reserved to the full
+ * capacity up front, so the cache never allocates after initialization and
+ * entries never move because of growth:
+ *
+ * - a HashIndex over the entries' key field finds an entry in O(1),
+ * - an IntrusiveList threaded through the entries keeps them in recency
+ *   order (front = most recent), so promoting and evicting are O(1).
+ *
+ * An evicted entry's slot is reused in place for the new key. Removing a key
+ * swap-removes its entry; the entry moved into the hole has its list
+ * neighbours repaired and its index slot renumbered.
+ */
+
+#ifndef DS_LRU_CACHE_H
+#define DS_LRU_CACHE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "allocator.h"
+#include "dyn_array.h"
+#include "hash_index.h"
+#include "intrusive_list.h"
+
+/**
+ * Header of every cache entry; value_size bytes of value follow it.
+ */
+typedef struct {
+    ListLink link;   /* Position in the recency list */
+    uint64_t key;    /* Key of the entry */
+    _Alignas(16) unsigned char value[];  /* Value storage (flexible array member) */
+} LruEntry;
+
+/**
+ * LRU cache state.
+ */
+typedef struct {
+    DynArray entries;     /* Entry storage, reserved to capacity and never regrown */
+    HashIndex index;      /* key -> position in entries */
+    IntrusiveList order;  /* Entries from most to least recently used */
+    size_t capacity;      /* Maximum number of entries */
+    size_t value_size;    /* Size of each value in bytes */
+    size_t hits;          /* Successful get_lru_cache calls */
+    size_t misses;        /* Unsuccessful get_lru_cache calls */
+    size_t evictions;     /* Entries evicted to make room */
+} LruCache;
+
+/**
+ * Initializes an empty cache and allocates all of its memory.
+ * The cache must not be moved afterwards (its entries link to its list).
+ *
+ * @param cache Pointer to caller-allocated cache
+ * @param capacity Maximum number of entries (must be > 0)
+ * @param value_size Size of each value in bytes
+ * @param allocator Allocator for the entries and the index, or NULL for the C library
+ * @return 1 on success, 0 if capacity is 0 or the memory could not be allocated
+ */
+static inline int init_lru_cache(LruCache* cache, size_t capacity, size_t value_size, const Allocator* allocator) {
+    if (capacity == 0) {
+        return 0;
+    }
+    /* Round entries up to the header's alignment so every value stays aligned */
+    size_t entry_size = (sizeof(LruEntry) + value_size + _Alignof(LruEntry) - 1) / _Alignof(LruEntry) * _Alignof(LruEntry);
+
+    DynArrayOptions options = DYN_ARRAY_DEFAULT_OPTIONS;
+    options.initial_cap = 0;
+    options.allocator = allocator;
+    init_dyn_array(entry_size, &options, &cache->entries);
+    init_hash_index(&cache->index, &cache->entries, offsetof(LruEntry, key), sizeof(uint64_t), allocator);
+    init_intrusive_list(&cache->order);
+    cache->capacity = capacity;
+    cache->value_size = value_size;
+    cache->hits = 0;
+    cache->misses = 0;
+    cache->evictions = 0;
+
+    if (!reserve_dyn_array(&cache->entries, capacity) || !reserve_hash_index(&cache->index, capacity)) {
+        free_hash_index(&cache->index);
+        free_dyn_array(&cache->entries);
+        return 0;
+    }
+    return 1;
+}
+
+/**
+ * Returns the entry at position idx of the entry array.
+ */
+static inline LruEntry* entry_lru_cache(const LruCache* cache, size_t idx) {
+    return (LruEntry*)((char*)cache->entries.items + idx * cache->entries.size);
+}
+
+/**
+ * Looks up a key without changing its recency.
+ *
+ * @param cache Pointer to the cache
+ * @param key Key to look up
+ * @return Pointer to the value (value_size bytes), or NULL if the key is absent
+ */
+static inline void* peek_lru_cache(const LruCache* cache, uint64_t key) {
+    LruEntry* entry = lookup_hash_index(&cache->index, key);
+    return entry != NULL ? entry->value : NULL;
+}
+
+/**
+ * Looks up a key and marks it most recently used.
+ *
+ * @param cache Pointer to the cache
+ * @param key Key to look up
+ * @return Pointer to the value (value_size bytes, valid until the next put or
+ *         remove), or NULL if the key is absent
+ */
+static inline void* get_lru_cache(LruCache* cache, uint64_t key) {
+    LruEntry* entry = lookup_hash_index(&cache->index, key);
+    if (entry == NULL) {
+        cache->misses++;
+        return NULL;
+    }
+    cache->hits++;
+    move_to_front_intrusive_list(&cache->order, &entry->link);
+    return entry->value;
+}
+
+/**
+ * Inserts or updates a key and marks it most recently used.
+ * When the cache is full, the least recently used entry is evicted and its
+ * slot reused.
+ *
+ * @param cache Pointer to the cache
+ * @param key Key to store
+ * @param value Pointer to value_size bytes to copy into the cache
+ * @return 1 on success (the cache never allocates here, so this cannot fail)
+ */
+static inline int put_lru_cache(LruCache* cache, uint64_t key, const void* value) {
+    LruEntry* entry = lookup_hash_index(&cache->index, key);
+    if (entry != NULL) {
+        memcpy(entry->value, value, cache->value_size);
+        move_to_front_intrusive_list(&cache->order, &entry->link);
+        return 1;
+    }
+
+    size_t idx;
+    if (cache->entries.count < cache->capacity) {
+        /* Room left: take the next slot, already reserved */
+        idx = cache->entries.count++;
+        entry = entry_lru_cache(cache, idx);
+    } else {
+        /* Full: reuse the least recently used entry's slot */
+        entry = CONTAINER_OF(back_intrusive_list(&cache->order), LruEntry, link);
+        idx = (size_t)((char*)entry - (char*)cache->entries.items) / cache->entries.size;
+        erase_hash_index(&cache->index, idx);
+        unlink_intrusive_list(&entry->link);
+        cache->evictions++;
+    }
+
+    entry->key = key;
+    memcpy(entry->value, value, cache->value_size);
+    insert_hash_index(&cache->index, idx);   /* Reserved to capacity, cannot fail */
+    push_front_intrusive_list(&cache->order, &entry->link);
+    return 1;
+}
+
+/**
+ * Removes a key from the cache.
+ *
+ * @param cache Pointer to the cache
+ * @param key Key to remove
+ * @return 1 if the key was removed, 0 if it was absent
+ */
+static inline int remove_lru_cache(LruCache* cache, uint64_t key) {
+    size_t idx = find_hash_index(&cache->index, key);
+    if (idx == HASH_INDEX_NOT_FOUND) {
+        return 0;
+    }
+    size_t last = cache->entries.count - 1;
+    unlink_intrusive_list(&entry_lru_cache(cache, idx)->link);
+    swap_remove_hash_index(&cache->index, idx, NULL);
+    /* The last entry was copied into the hole; point its neighbours at its new address */
+    if (idx != last) {
+        relocate_intrusive_list(&entry_lru_cache(cache, idx)->link);
+    }
+    return 1;
+}
+
+/**
+ * Returns the number of entries in the cache.
+ */
+static inline size_t count_lru_cache(const LruCache* cache) {
+    return cache->entries.count;
+}
+
+/**
+ * Frees all memory owned by the cache.
+ *
+ * @param cache Pointer to the cache
+ */
+static inline void free_lru_cache(LruCache* cache) {
+    free_hash_index(&cache->index);
+    free_dyn_array(&cache->entries);
+    init_intrusive_list(&cache->order);
+}
+
+#endif /* DS_LRU_CACHE_H */
@@ -0,0 +1,58 @@
+/*
+ * Memory-Mapped DynArray Example
+ *
+ * This file demonstrates persisting a DynArray of User records in a file
+ * and reopening it instantly through mmap. The implementation supports:
+ *
+ * - Creating a file-backed array and pushing to it like any DynArray
+ * - Growing the file with ftruncate + mremap instead of heap copies
+ * - Reopening the file with a single mmap, without parsing records
+ *
+ * Key concepts demonstrated:
+ * - Plugging a custom Allocator into a DynArray
+ * - Shared file mappings as persistent storage
+ * - Self-describing binary headers (magic, version, element size, count)
+ */
+
+#define _GNU_SOURCE     /* mremap */
+#include <stdio.h>
+
+#include "mapped_array.h"
+#include "user.h"
+
+int main(void) {
+    const char* path = "/tmp/ds_mapped_users.bin";
+    remove(path);
+
+    /* Create the file and fill it through the regular DynArray API */
+    MappedArrayFile file;
+    DynArray users;
+    if (!open_mapped_dyn_array(path, sizeof(User), NULL, &file, &users)) {
+        perror("open_mapped_dyn_array");
+        return 1;
+    }
+    for (short i = 0; i < 1000; ++i) {
+        User user = {"user", i};
+        snprintf(user.name, sizeof(user.name), "user-%d", i);
+        push_dyn_array(&users, &user);
+    }
+    printf("Created %s with %zu users (capacity %zu)\n", path, users.count, users.cap);
+    close_mapped_dyn_array(&file, &users);
+
+    /* Reopen: the records are available right away, nothing is read or parsed */
+    if (!open_mapped_dyn_array(path, sizeof(User), NULL, &file, &users)) {
+        perror("open_mapped_dyn_array");
+        return 1;
+    }
+    User* last = (User*)((char*)users.items + users.size * (users.count - 1));
+    printf("Reopened %zu users, last: name: %s, id: %d\n", users.count, last->name, last->id);
+
+    /* Appending after a reopen keeps growing the same file */
+    User extra = {"benson", 1000};
+    push_dyn_array(&users, &extra);
+    printf("After push: %zu users\n", users.count);
+    close_mapped_dyn_array(&file, &users);
+
+    remove(path);
+    return 0;
+}
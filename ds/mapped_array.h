@@ -0,0 +1,256 @@
+/*
+ * Memory-Mapped, File-Backed DynArray
+ *
+ * Lets a DynArray keep its items in an mmap of a file instead of the heap.
+ * The mapping is exposed to the array as an Allocator whose realloc grows the
+ * file with ftruncate and the mapping with mremap (Linux) or munmap + mmap
+ * elsewhere, so push_dyn_array, reserve_dyn_array and the growth policy work
+ * unchanged and never copy elements through the heap.
+ *
+ * The file starts with a fixed-size header (magic, version, element size,
+ * count) followed by the raw elements, so reopening a file is a single mmap:
+ * no parsing or per-element work, regardless of the file size.
+ *
+ * Only suitable for plain-data element types (no pointers), such as User.
+ * POSIX only: define _POSIX_C_SOURCE 200809L (or _GNU_SOURCE on Linux, to get
+ * mremap) before any #include in the translation unit using this header.
+ */
+
+#ifndef DS_MAPPED_ARRAY_H
+#define DS_MAPPED_ARRAY_H
+
+#include <fcntl.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "allocator.h"
+#include "dyn_array.h"
+#include "serialize.h"
+
+/* The file format is the DynArray serialization format from serialize.h */
+#define MAPPED_ARRAY_MAGIC SERIAL_DYN_ARRAY_MAGIC
+#define MAPPED_ARRAY_VERSION SERIAL_VERSION
+
+/**
+ * On-disk header, 64 bytes so the elements that follow are cache-line
+ * aligned within the page-aligned mapping.
+ */
+typedef SerialHeader MappedArrayHeader;
+
+/**
+ * State of one mapped file. Its base Allocator is plugged into the DynArray.
+ */
+typedef struct {
+    Allocator base;       /* Interface handed to the DynArray, ctx points back here */
+    int fd;               /* Open file descriptor, -1 once closed */
+    void* map;            /* Start of the mapping (the header), NULL if unmapped */
+    size_t map_len;       /* Length of the mapping in bytes */
+} MappedArrayFile;
+
+/**
+ * Maps (or remaps) the file so that it holds the header plus bytes of element data.
+ * Grows or shrinks the file to match first.
+ *
+ * @return 1 on success, 0 on failure (the previous mapping is kept)
+ */
+static inline int remap_mapped_file(MappedArrayFile* file, size_t bytes) {
+    size_t new_len = sizeof(MappedArrayHeader) + bytes;
+    if (ftruncate(file->fd, (off_t)new_len) != 0) {
+        return 0;
+    }
+
+    void* new_map;
+    if (file->map == NULL) {
+        new_map = mmap(NULL, new_len, PROT_READ | PROT_WRITE, MAP_SHARED, file->fd, 0);
+    } else {
+#ifdef MREMAP_MAYMOVE
+        /* Let the kernel move the page table entries, no data is copied */
+        new_map = mremap(file->map, file->map_len, new_len, MREMAP_MAYMOVE);
+#else
+        new_map = mmap(NULL, new_len, PROT_READ | PROT_WRITE, MAP_SHARED, file->fd, 0);
+        if (new_map != MAP_FAILED) {
+            munmap(file->map, file->map_len);
+        }
+#endif
+    }
+    if (new_map == MAP_FAILED) {
+        return 0;
+    }
+
+    file->map = new_map;
+    file->map_len = new_len;
+    return 1;
+}
+
+static inline void* mapped_alloc(void* ctx, size_t size, size_t align) {
+    MappedArrayFile* file = ctx;
+    /* One array per file, and elements are 64-byte aligned at most */
+    if (file->map != NULL || align > sizeof(MappedArrayHeader)) {
+        return NULL;
+    }
+    return remap_mapped_file(file, size) ? (char*)file->map + sizeof(MappedArrayHeader) : NULL;
+}
+
+static inline void* mapped_realloc(void* ctx, void* ptr, size_t old_size, size_t new_size) {
+    MappedArrayFile* file = ctx;
+    (void)ptr;
+    (void)old_size;
+    return remap_mapped_file(file, new_size) ? (char*)file->map + sizeof(MappedArrayHeader) : NULL;
+}
+
+static inline void mapped_free(void* ctx, void* ptr, size_t size) {
+    MappedArrayFile* file = ctx;
+    (void)ptr;
+    (void)size;
+    /* Only drop the mapping, the file keeps its contents */
+    if (file->map != NULL) {
+        munmap(file->map, file->map_len);
+        file->map = NULL;
+        file->map_len = 0;
+    }
+}
+
+/**
+ * Writes the array's count and element size into the file header.
+ */
+static inline void write_mapped_header(MappedArrayFile* file, const DynArray* array) {
+    init_serial_header(file->map, MAPPED_ARRAY_MAGIC, array->size, array->count,
+                       array->count * array->size);
+}
+
+/**
+ * Opens (or creates) a file-backed dynamic array.
+ * An existing file is mapped as-is: its elements are available immediately,
+ * without reading or parsing them. A new or empty file starts with no elements.
+ *
+ * The array grows like any DynArray (growth policy from options, or pages by default)
+ * but every resize is an ftruncate + remap of the file.
+ *
+ * @param path Path of the backing file
+ * @param size Size of each element in bytes (use sizeof())
+ * @param options Growth policy, or NULL for 2x growth in page-sized steps;
+ *                options->allocator is ignored
+ * @param file Pointer to caller-allocated MappedArrayFile, must outlive the array
+ * @param array Pointer to caller-allocated DynArray structure to initialize
+ * @return 1 on success, 0 if the file could not be opened or mapped, or if it
+ *         holds a different format or element size
+ */
+static inline int open_mapped_dyn_array(const char* path, size_t size, const DynArrayOptions* options,
+                                        MappedArrayFile* file, DynArray* array) {
+    DynArrayOptions opts = options != NULL ? *options : DYN_ARRAY_DEFAULT_OPTIONS;
+    if (options == NULL) {
+        /* Every resize costs a syscall, so grow in whole pages */
+        opts.chunk_size = DYN_ARRAY_PAGE_SIZE;
+    }
+    opts.allocator = &file->base;
+
+    file->base.alloc = mapped_alloc;
+    file->base.realloc = mapped_realloc;
+    file->base.free = mapped_free;
+    file->base.ctx = file;
+    file->map = NULL;
+    file->map_len = 0;
+    file->fd = open(path, O_RDWR | O_CREAT, 0644);
+    if (file->fd < 0) {
+        return 0;
+    }
+
+    /* Start from an empty array; the mapping is set up below, not by init */
+    size_t initial_cap = opts.initial_cap;
+    opts.initial_cap = 0;
+    init_dyn_array(size, &opts, array);
+    array->options.initial_cap = initial_cap;
+
+    struct stat st;
+    if (fstat(file->fd, &st) != 0) {
+        close(file->fd);
+        file->fd = -1;
+        return 0;
+    }
+
+    size_t file_size = (size_t)st.st_size;
+    if (file_size >= sizeof(MappedArrayHeader)) {
+        /* Existing data: map the whole file and validate the header */
+        if (!remap_mapped_file(file, file_size - sizeof(MappedArrayHeader))) {
+            close(file->fd);
+            file->fd = -1;
+            return 0;
+        }
+        MappedArrayHeader* header = file->map;
+        size_t data_bytes = file_size - sizeof(MappedArrayHeader);
+        if (memcmp(header->magic, MAPPED_ARRAY_MAGIC, sizeof(header->magic)) != 0 ||
+            header->version != MAPPED_ARRAY_VERSION ||
+            header->header_size != sizeof(MappedArrayHeader) ||
+            header->elem_size != size || size == 0 ||
+            header->count > data_bytes / size) {
+            mapped_free(file, NULL, 0);
+            close(file->fd);
+            file->fd = -1;
+            return 0;
+        }
+        array->items = (char*)file->map + sizeof(MappedArrayHeader);
+        array->count = (size_t)header->count;
+        array->cap = data_bytes / size;
+    } else {
+        /* New file: write a header so the file is valid even before the first push */
+        if (!remap_mapped_file(file, 0)) {
+            close(file->fd);
+            file->fd = -1;
+            return 0;
+        }
+        array->items = (char*)file->map + sizeof(MappedArrayHeader);
+        write_mapped_header(file, array);
+    }
+    return 1;
+}
+
+/**
+ * Persists the current count into the header and flushes dirty pages to disk.
+ *
+ * @param file Pointer to the mapped file
+ * @param array Pointer to the array opened on it
+ * @return 1 on success, 0 if msync failed
+ */
+static inline int sync_mapped_dyn_array(MappedArrayFile* file, const DynArray* array) {
+    if (file->map == NULL) {
+        return 1;
+    }
+    write_mapped_header(file, array);
+    return msync(file->map, file->map_len, MS_SYNC) == 0;
+}
+
+/**
+ * Syncs the array, trims the file to its elements, and releases the mapping and descriptor.
+ * Use this instead of free_dyn_array for file-backed arrays; the array is reset to empty.
+ *
+ * @param file Pointer to the mapped file
+ * @param array Pointer to the array opened on it
+ * @return 1 on success, 0 if syncing or truncating the file failed
+ */
+static inline int close_mapped_dyn_array(MappedArrayFile* file, DynArray* array) {
+    int ok = 1;
+    if (file->map == NULL && file->fd >= 0) {
+        /* The buffer was released (e.g. shrink_to_fit of an empty array), map a header again */
+        ok = remap_mapped_file(file, 0);
+    }
+    if (file->map != NULL) {
+        ok = sync_mapped_dyn_array(file, array) && ok;
+        mapped_free(file, NULL, 0);
+    }
+    if (file->fd >= 0) {
+        /* Drop the unused capacity so the file holds exactly header + elements */
+        off_t used = (off_t)(sizeof(MappedArrayHeader) + array->count * array->size);
+        ok = ftruncate(file->fd, used) == 0 && ok;
+        close(file->fd);
+        file->fd = -1;
+    }
+    array->items = NULL;
+    array->count = 0;
+    array->cap = 0;
+    return ok;
+}
+
+#endif /* DS_MAPPED_ARRAY_H */
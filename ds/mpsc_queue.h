@@ -0,0 +1,281 @@
+/*
+ * Lock-Free Multi-Producer Single-Consumer Queue
+ *
+ * Vyukov-style intrusive MPSC queue built on the IntList layout: a singly
+ * linked list of int nodes with a head (where producers append) and a tail
+ * (where the consumer removes). Producers enqueue with one atomic exchange
+ * and one store, so enqueue is wait-free; the consumer needs no atomic
+ * read-modify-write at all.
+ *
+ * Nodes come from an MpscNodePool owned by each producer thread. The consumer
+ * hands dequeued nodes back to their pool through a lock-free return stack,
+ * which the owning producer drains all at once, so steady-state enqueue never
+ * takes a lock or calls the allocator.
+ *
+ * Requires C11 atomics.
+ */
+
+#ifndef DS_MPSC_QUEUE_H
+#define DS_MPSC_QUEUE_H
+
+#include <stdatomic.h>
+#include <stddef.h>
+
+#include "allocator.h"
+
+#define MPSC_CACHE_LINE 64
+
+struct MpscNodePool;
+
+/**
+ * Queue node: IntNode with an atomic next pointer and an owning pool.
+ */
+typedef struct MpscNode {
+    _Atomic(struct MpscNode*) next;  /* Pointer to next node, NULL if last node */
+    int value;                       /* Integer value stored in this node */
+    struct MpscNodePool* pool;       /* Pool to return the node to, NULL if caller-owned */
+} MpscNode;
+
+/**
+ * Queue control structure. head and tail live on separate cache lines
+ * so producers and the consumer do not false-share.
+ */
+typedef struct {
+    _Alignas(MPSC_CACHE_LINE) _Atomic(MpscNode*) head;  /* Last enqueued node (producers) */
+    _Alignas(MPSC_CACHE_LINE) MpscNode* tail;           /* Next node to dequeue (consumer) */
+    MpscNode stub;                                      /* Placeholder keeping the list non-empty */
+} MpscQueue;
+
+/**
+ * Slab of queue nodes, chained so the pool can free them all at the end.
+ */
+typedef struct MpscNodeSlab {
+    struct MpscNodeSlab* next;  /* Previously allocated slab, NULL if first */
+    size_t used;                /* Number of nodes handed out from this slab */
+    size_t cap;                 /* Number of nodes in this slab */
+    MpscNode nodes[];           /* Node storage (flexible array member) */
+} MpscNodeSlab;
+
+/**
+ * Per-producer node pool.
+ * Everything except the return stack is only touched by the owning producer.
+ */
+typedef struct MpscNodePool {
+    MpscNodeSlab* slabs;        /* Most recently allocated slab, NULL if none */
+    MpscNode* free_list;        /* Nodes ready for reuse (owner only) */
+    size_t slab_nodes;          /* Number of nodes per slab */
+    const Allocator* allocator; /* Where slabs come from, NULL for the C library */
+    _Alignas(MPSC_CACHE_LINE) _Atomic(MpscNode*) returned;  /* Nodes released by other threads */
+} MpscNodePool;
+
+#define MPSC_NODE_POOL_DEFAULT_SLAB 4096
+
+/**
+ * Initializes an empty queue.
+ *
+ * @param queue Pointer to caller-allocated queue
+ */
+static inline void init_mpsc_queue(MpscQueue* queue) {
+    atomic_init(&queue->stub.next, NULL);
+    queue->stub.value = 0;
+    queue->stub.pool = NULL;
+    atomic_init(&queue->head, &queue->stub);
+    queue->tail = &queue->stub;
+}
+
+/**
+ * Appends a node. Safe to call from any number of threads concurrently; wait-free.
+ *
+ * @param queue Pointer to the queue
+ * @param node Node to append, must not be in any queue
+ */
+static inline void enqueue_mpsc(MpscQueue* queue, MpscNode* node) {
+    atomic_store_explicit(&node->next, NULL, memory_order_relaxed);
+    /* Claim the head slot, then link the previous head to us */
+    MpscNode* prev = atomic_exchange_explicit(&queue->head, node, memory_order_acq_rel);
+    atomic_store_explicit(&prev->next, node, memory_order_release);
+}
+
+/**
+ * Removes the oldest node. Must only be called from the single consumer thread.
+ * May return NULL while a producer is between its exchange and its link store,
+ * even though the queue is not empty; simply try again later.
+ *
+ * @param queue Pointer to the queue
+ * @return Dequeued node, now owned by the caller, or NULL if none is available
+ */
+static inline MpscNode* dequeue_mpsc(MpscQueue* queue) {
+    MpscNode* tail = queue->tail;
+    MpscNode* next = atomic_load_explicit(&tail->next, memory_order_acquire);
+
+    /* Skip over the stub */
+    if (tail == &queue->stub) {
+        if (next == NULL) {
+            return NULL;
+        }
+        queue->tail = next;
+        tail = next;
+        next = atomic_load_explicit(&next->next, memory_order_acquire);
+    }
+
+    if (next != NULL) {
+        queue->tail = next;
+        return tail;
+    }
+
+    /* tail is the last linked node; a producer may be mid-enqueue */
+    if (tail != atomic_load_explicit(&queue->head, memory_order_acquire)) {
+        return NULL;
+    }
+
+    /* Re-insert the stub behind tail so tail can be handed out */
+    enqueue_mpsc(queue, &queue->stub);
+    next = atomic_load_explicit(&tail->next, memory_order_acquire);
+    if (next != NULL) {
+        queue->tail = next;
+        return tail;
+    }
+    return NULL;
+}
+
+/**
+ * Initializes an empty node pool for one producer thread.
+ *
+ * @param pool Pointer to caller-allocated pool
+ * @param slab_nodes Number of nodes per slab (0 = MPSC_NODE_POOL_DEFAULT_SLAB)
+ * @param allocator Allocator for slabs, or NULL for the C library
+ */
+static inline void init_mpsc_node_pool(MpscNodePool* pool, size_t slab_nodes, const Allocator* allocator) {
+    pool->slabs = NULL;
+    pool->free_list = NULL;
+    pool->slab_nodes = slab_nodes ? slab_nodes : MPSC_NODE_POOL_DEFAULT_SLAB;
+    pool->allocator = allocator;
+    atomic_init(&pool->returned, NULL);
+}
+
+/**
+ * Allocates one more slab. Owner thread only.
+ *
+ * @return 1 on success, 0 if the allocation failed
+ */
+static inline int grow_mpsc_node_pool(MpscNodePool* pool) {
+    MpscNodeSlab* slab = allocate(pool->allocator, sizeof(MpscNodeSlab) + pool->slab_nodes * sizeof(MpscNode), 0);
+    if (slab == NULL) {
+        return 0;
+    }
+    slab->next = pool->slabs;
+    slab->used = 0;
+    slab->cap = pool->slab_nodes;
+    pool->slabs = slab;
+    return 1;
+}
+
+/**
+ * Takes a node from the pool. Owner thread only.
+ * Order: local free list, then every node returned by other threads (taken in
+ * one exchange), then the current slab; a new slab is only allocated when all
+ * are exhausted.
+ *
+ * @param pool Pointer to the producer's pool
+ * @return Node owned by the pool, or NULL if a new slab could not be allocated
+ */
+static inline MpscNode* alloc_mpsc_node(MpscNodePool* pool) {
+    if (pool->free_list == NULL) {
+        /* Take the whole return stack at once; a single popper means no ABA problem */
+        pool->free_list = atomic_exchange_explicit(&pool->returned, NULL, memory_order_acquire);
+    }
+    if (pool->free_list != NULL) {
+        MpscNode* node = pool->free_list;
+        pool->free_list = atomic_load_explicit(&node->next, memory_order_relaxed);
+        return node;
+    }
+
+    if ((pool->slabs == NULL || pool->slabs->used == pool->slabs->cap) && !grow_mpsc_node_pool(pool)) {
+        return NULL;
+    }
+    MpscNode* node = &pool->slabs->nodes[pool->slabs->used++];
+    node->pool = pool;
+    return node;
+}
+
+/**
+ * Ensures the pool can hand out n nodes without allocating, so a producer can
+ * pre-size before entering its hot loop. Owner thread only.
+ *
+ * @return 1 on success, 0 if an allocation failed
+ */
+static inline int reserve_mpsc_node_pool(MpscNodePool* pool, size_t n) {
+    size_t available = pool->slabs != NULL ? pool->slabs->cap - pool->slabs->used : 0;
+    for (MpscNode* node = pool->free_list; node != NULL && available < n;
+         node = atomic_load_explicit(&node->next, memory_order_relaxed)) {
+        available++;
+    }
+    while (available < n) {
+        /* Retire the current slab's remainder into the free list, then add a fresh slab */
+        while (pool->slabs != NULL && pool->slabs->used < pool->slabs->cap) {
+            MpscNode* node = &pool->slabs->nodes[pool->slabs->used++];
+            node->pool = pool;
+            atomic_store_explicit(&node->next, pool->free_list, memory_order_relaxed);
+            pool->free_list = node;
+        }
+        if (!grow_mpsc_node_pool(pool)) {
+            return 0;
+        }
+        available += pool->slab_nodes;
+    }
+    return 1;
+}
+
+/**
+ * Returns a dequeued node to the pool it came from. Safe from any thread.
+ *
+ * @param node Node to release (nodes with no pool are ignored)
+ */
+static inline void release_mpsc_node(MpscNode* node) {
+    MpscNodePool* pool = node->pool;
+    if (pool == NULL) {
+        return;
+    }
+    MpscNode* top = atomic_load_explicit(&pool->returned, memory_order_relaxed);
+    do {
+        atomic_store_explicit(&node->next, top, memory_order_relaxed);
+    } while (!atomic_compare_exchange_weak_explicit(&pool->returned, &top, node,
+                                                    memory_order_release, memory_order_relaxed));
+}
+
+/**
+ * Enqueues a value using a node from the producer's pool.
+ *
+ * @param queue Pointer to the queue
+ * @param pool Pointer to the calling producer's pool
+ * @param value Value to enqueue
+ * @return 1 on success, 0 if the pool could not provide a node
+ */
+static inline int enqueue_mpsc_value(MpscQueue* queue, MpscNodePool* pool, int value) {
+    MpscNode* node = alloc_mpsc_node(pool);
+    if (node == NULL) {
+        return 0;
+    }
+    node->value = value;
+    enqueue_mpsc(queue, node);
+    return 1;
+}
+
+/**
+ * Frees all slabs of a pool. No node of the pool may still be queued or in use.
+ *
+ * @param pool Pointer to the pool
+ */
+static inline void free_mpsc_node_pool(MpscNodePool* pool) {
+    MpscNodeSlab* slab = pool->slabs;
+    while (slab != NULL) {
+        MpscNodeSlab* next = slab->next;
+        deallocate(pool->allocator, slab, sizeof(MpscNodeSlab) + slab->cap * sizeof(MpscNode));
+        slab = next;
+    }
+    pool->slabs = NULL;
+    pool->free_list = NULL;
+    atomic_store(&pool->returned, NULL);
+}
+
+#endif /* DS_MPSC_QUEUE_H */
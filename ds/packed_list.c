@@ -0,0 +1,110 @@
+/*
+ * Compressed Integer List Example
+ *
+ * This file demonstrates storing a sorted id list (a posting list) as
+ * delta-encoded varints and reading it back in several ways.
+ * The implementation supports:
+ *
+ * - Append-only pushes, like push_node on an IntList
+ * - A streaming iterator and seeking to the first value >= a target
+ * - Batched scans and NodeVisitFn traversal shared with IntList
+ * - Serializing in the IntList format without re-encoding
+ *
+ * Key concepts demonstrated:
+ * - Delta + zigzag + varint compression of integer sequences
+ * - A sparse block index to make a stream searchable
+ * - Intersecting two posting lists by leapfrogging seeks
+ */
+
+#include <stdio.h>
+
+#include "packed_list.h"
+
+/**
+ * Example visitor: stops at the first value exceeding *threshold.
+ * Can be passed as a NodeVisitFn function pointer.
+ */
+int find_greater_than(IntNode* node, void* ctx) {
+    return node->value > *(int*)ctx ? NODE_VISIT_STOP : NODE_VISIT_CONTINUE;
+}
+
+/**
+ * Example batch callback: adds a batch of values to the long long sum in ctx.
+ * Can be passed as a ValueBatchFn function pointer.
+ */
+void sum_values(const int* values, size_t n, void* ctx) {
+    long long sum = 0;
+    for (size_t i = 0; i < n; ++i) {
+        sum += values[i];
+    }
+    *(long long*)ctx += sum;
+}
+
+int main(void) {
+    /* Two sorted posting lists: multiples of 3 and multiples of 5 */
+    PackedIntList threes;
+    PackedIntList fives;
+    init_packed_list(&threes, NULL);
+    init_packed_list(&fives, NULL);
+    for (int i = 0; i < 100000; ++i) {
+        push_packed_list(&threes, i * 3);
+        push_packed_list(&fives, i * 5);
+    }
+    printf("%zu values in %zu bytes (%.2f bytes/value, IntList: %zu)\n", threes.count,
+           footprint_packed_list(&threes), (double)footprint_packed_list(&threes) / (double)threes.count,
+           sizeof(IntNode));
+
+    /* Stream the first few values */
+    PackedIntIter it = begin_packed_iter(&threes);
+    int value;
+    printf("First values:");
+    for (int i = 0; i < 5 && next_packed_iter(&it, &value); ++i) {
+        printf(" %d", value);
+    }
+    printf("\n");
+
+    /* Intersect: each list seeks to the other's current value */
+    PackedIntIter a = begin_packed_iter(&threes);
+    PackedIntIter b = begin_packed_iter(&fives);
+    int x;
+    int y;
+    size_t common = 0;
+    int ok = next_packed_iter(&a, &x) && next_packed_iter(&b, &y);
+    while (ok) {
+        if (x == y) {
+            common++;
+            ok = next_packed_iter(&a, &x) && next_packed_iter(&b, &y);
+        } else if (x < y) {
+            ok = seek_packed_iter(&threes, &a, y, &x);
+        } else {
+            ok = seek_packed_iter(&fives, &b, x, &y);
+        }
+    }
+    printf("Common values (multiples of 15): %zu\n", common);
+
+    /* The same callbacks as for IntList */
+    int threshold = 1000;
+    size_t pos = visit_packed_list(&threes, find_greater_than, &threshold);
+    printf("First value > %d is at position %zu\n", threshold, pos);
+    long long sum = 0;
+    process_packed_list(&fives, sum_values, &sum);
+    printf("Sum of the multiples of 5: %lld\n", sum);
+
+    /* Serialized form loads back as an ordinary IntList */
+    DynArray bytes;
+    new_dyn_array(1, &bytes);
+    serialize_packed_list(&threes, &bytes);
+    IntNodePool pool;
+    init_int_node_pool(&pool, 0);
+    IntList list = {NULL, NULL, NULL};
+    if (deserialize_int_list(bytes.items, bytes.count, &pool, &list)) {
+        printf("Deserialized as IntList, last value: %d\n", list.tail->value);
+    }
+    release_list_pooled(&pool, &list);
+    free_int_node_pool(&pool);
+    free_dyn_array(&bytes);
+
+    free_packed_list(&threes);
+    free_packed_list(&fives);
+    return 0;
+}
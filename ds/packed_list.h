@@ -0,0 +1,294 @@
+/*
+ * Delta/Varint Compressed Integer List
+ *
+ * Append-only sequence of ints stored as zigzag varints of the difference
+ * between neighbouring values, the same encoding serialize_int_list uses.
+ * Sorted id lists with small gaps take one or two bytes per value, against
+ * 16 bytes per IntNode, and a scan streams through one contiguous buffer.
+ *
+ * Every PACKED_LIST_BLOCK values the byte offset and value are recorded in a
+ * small block index, so a sorted list can be searched (seek_packed_iter) by
+ * binary search over the blocks plus a short decode, as in posting list
+ * intersections.
+ */
+
+#ifndef DS_PACKED_LIST_H
+#define DS_PACKED_LIST_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "allocator.h"
+#include "dyn_array.h"
+#include "linked_list.h"
+#include "serialize.h"
+#include "varint.h"
+
+/* Values per block index entry */
+#define PACKED_LIST_BLOCK 128
+
+/**
+ * Block index entry: where a run of PACKED_LIST_BLOCK values starts.
+ */
+typedef struct {
+    size_t offset;  /* Byte offset of the block's first encoded value */
+    int first;      /* Value of the block's first element */
+    int prev;       /* Value before the block (0 for the first block), its delta base */
+} PackedIntBlock;
+
+/**
+ * Compressed list control structure.
+ */
+typedef struct {
+    DynArray bytes;   /* Encoded deltas (unsigned char elements) */
+    DynArray blocks;  /* PackedIntBlock entries, one per PACKED_LIST_BLOCK values */
+    size_t count;     /* Number of values */
+    int last;         /* Last value appended (0 while empty), the base of the next delta */
+} PackedIntList;
+
+/**
+ * Streaming decoder over a PackedIntList.
+ */
+typedef struct {
+    const unsigned char* pos;  /* Next encoded value */
+    const unsigned char* end;  /* End of the encoded values */
+    int64_t prev;              /* Last decoded value, the base of the next delta */
+} PackedIntIter;
+
+/**
+ * Initializes an empty list. No memory is allocated until the first push.
+ *
+ * @param list Pointer to caller-allocated list
+ * @param allocator Allocator for the buffers, or NULL for the C library
+ */
+static inline void init_packed_list(PackedIntList* list, const Allocator* allocator) {
+    DynArrayOptions options = DYN_ARRAY_DEFAULT_OPTIONS;
+    options.initial_cap = 0;
+    options.allocator = allocator;
+    init_dyn_array(sizeof(unsigned char), &options, &list->bytes);
+    init_dyn_array(sizeof(PackedIntBlock), &options, &list->blocks);
+    list->count = 0;
+    list->last = 0;
+}
+
+/**
+ * Appends a value at the end of the list, like push_node.
+ *
+ * @param list Pointer to the list
+ * @param value Value to append
+ * @return 1 on success, 0 if a buffer could not grow (the list is unchanged)
+ */
+static inline int push_packed_list(PackedIntList* list, int value) {
+    if (!grow_for_dyn_array(&list->bytes, VARINT_MAX_BYTES)) {
+        return 0;
+    }
+    if (list->count % PACKED_LIST_BLOCK == 0) {
+        PackedIntBlock block = {list->bytes.count, value, list->last};
+        if (!push_dyn_array(&list->blocks, &block)) {
+            return 0;
+        }
+    }
+    unsigned char* dest = (unsigned char*)list->bytes.items + list->bytes.count;
+    list->bytes.count += encode_varint(dest, zigzag_encode((int64_t)value - list->last));
+    list->last = value;
+    list->count++;
+    return 1;
+}
+
+/**
+ * Appends every value of an IntList.
+ *
+ * @param packed Pointer to the compressed list
+ * @param list Pointer to the list to copy
+ * @return 1 on success, 0 if a buffer could not grow (a prefix was appended)
+ */
+static inline int append_int_list_to_packed_list(PackedIntList* packed, const IntList* list) {
+    for (const IntNode* node = list->head; node != NULL; node = node->next) {
+        if (!push_packed_list(packed, node->value)) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/**
+ * Returns an iterator positioned before the first value.
+ */
+static inline PackedIntIter begin_packed_iter(const PackedIntList* list) {
+    PackedIntIter it;
+    it.pos = list->bytes.items;
+    it.end = it.pos + list->bytes.count;
+    it.prev = 0;
+    return it;
+}
+
+/**
+ * Decodes the next value.
+ *
+ * @param it Pointer to the iterator
+ * @param value Where the value is stored
+ * @return 1 if a value was decoded, 0 at the end of the list
+ */
+static inline int next_packed_iter(PackedIntIter* it, int* value) {
+    if (it->pos == it->end) {
+        return 0;
+    }
+    uint64_t zz;
+    if (*it->pos < 0x80) {
+        zz = *it->pos++;   /* One-byte delta, the common case for sorted ids */
+    } else if (!decode_varint(&it->pos, it->end, &zz)) {
+        return 0;
+    }
+    it->prev += zigzag_decode(zz);
+    *value = (int)it->prev;
+    return 1;
+}
+
+/**
+ * Positions an iterator at the first value >= target, for lists appended in
+ * non-decreasing order. Binary searches the block index, then decodes at
+ * most one block.
+ *
+ * @param list Pointer to the sorted list
+ * @param it Iterator to reposition; afterwards it continues after the value found
+ * @param target Value to search for
+ * @param value Where the first value >= target is stored
+ * @return 1 if such a value exists, 0 otherwise
+ */
+static inline int seek_packed_iter(const PackedIntList* list, PackedIntIter* it, int target, int* value) {
+    const PackedIntBlock* blocks = list->blocks.items;
+    size_t lo = 0;
+    size_t hi = list->blocks.count;
+    /* Find the last block whose first value is < target; the answer is in it or starts the next */
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (blocks[mid].first < target) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    *it = begin_packed_iter(list);
+    if (lo > 0) {
+        it->pos += blocks[lo - 1].offset;
+        it->prev = blocks[lo - 1].prev;
+    }
+    while (next_packed_iter(it, value)) {
+        if (*value >= target) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * Decodes the list in batches of up to LIST_BATCH_SIZE values, like
+ * process_list_values for an IntList.
+ *
+ * @param list Pointer to the list
+ * @param bfn Callback receiving each batch of values in list order
+ * @param ctx Opaque caller state passed through to every call
+ */
+static inline void process_packed_list(const PackedIntList* list, ValueBatchFn bfn, void* ctx) {
+    int batch[LIST_BATCH_SIZE];
+    PackedIntIter it = begin_packed_iter(list);
+    for (;;) {
+        size_t n = 0;
+        while (n < LIST_BATCH_SIZE && next_packed_iter(&it, &batch[n])) {
+            n++;
+        }
+        if (n == 0) {
+            return;
+        }
+        bfn(batch, n, ctx);
+    }
+}
+
+/**
+ * Walks the list with a NodeVisitFn, so visitors written for IntList work
+ * unchanged. Each value is presented in a temporary IntNode whose next is
+ * NULL; visitors must not keep the pointer or modify the node.
+ *
+ * @param list Pointer to the list
+ * @param vfn Callback invoked per value; return NODE_VISIT_STOP to end early
+ * @param ctx Opaque caller state passed through to every call
+ * @return Position of the value the visit stopped at, or count if it ran to the end
+ */
+static inline size_t visit_packed_list(const PackedIntList* list, NodeVisitFn vfn, void* ctx) {
+    IntNode node = {NULL, 0};
+    PackedIntIter it = begin_packed_iter(list);
+    for (size_t pos = 0; next_packed_iter(&it, &node.value); ++pos) {
+        if (vfn(&node, ctx) == NODE_VISIT_STOP) {
+            return pos;
+        }
+    }
+    return list->count;
+}
+
+/**
+ * Decodes the whole list into a DynArray of int, growing it at most once.
+ *
+ * @param list Pointer to the list
+ * @param out Array of int (element size sizeof(int)) the values are appended to
+ * @return 1 on success, 0 if out has the wrong element size or could not grow
+ */
+static inline int linearize_packed_list(const PackedIntList* list, DynArray* out) {
+    if (out->size != sizeof(int) || !grow_for_dyn_array(out, list->count)) {
+        return 0;
+    }
+    int* dest = (int*)out->items + out->count;
+    PackedIntIter it = begin_packed_iter(list);
+    size_t n = 0;
+    while (next_packed_iter(&it, &dest[n])) {
+        n++;
+    }
+    out->count += n;
+    return 1;
+}
+
+/**
+ * Serializes the list in the format of serialize_int_list, which uses the
+ * same encoding, so the payload is copied rather than re-encoded. The result
+ * loads with deserialize_int_list.
+ *
+ * @param list Pointer to the list
+ * @param out Byte array (element size 1) the serialized form is appended to
+ * @return 1 on success, 0 if out has the wrong element size or could not grow
+ */
+static inline int serialize_packed_list(const PackedIntList* list, DynArray* out) {
+    if (out->size != 1) {
+        return 0;
+    }
+    SerialHeader header;
+    init_serial_header(&header, SERIAL_INT_LIST_MAGIC, sizeof(int), list->count, list->bytes.count);
+    if (!grow_for_dyn_array(out, sizeof(header) + list->bytes.count)) {
+        return 0;
+    }
+    char* dest = (char*)out->items + out->count;
+    memcpy(dest, &header, sizeof(header));
+    memcpy(dest + sizeof(header), list->bytes.items, list->bytes.count);
+    out->count += sizeof(header) + list->bytes.count;
+    return 1;
+}
+
+/**
+ * Returns the number of bytes of memory the list's buffers hold.
+ */
+static inline size_t footprint_packed_list(const PackedIntList* list) {
+    return list->bytes.cap * list->bytes.size + list->blocks.cap * list->blocks.size;
+}
+
+/**
+ * Releases the list's buffers and resets it to empty.
+ *
+ * @param list Pointer to the list
+ */
+static inline void free_packed_list(PackedIntList* list) {
+    free_dyn_array(&list->bytes);
+    free_dyn_array(&list->blocks);
+    list->count = 0;
+    list->last = 0;
+}
+
+#endif /* DS_PACKED_LIST_H */
@@ -0,0 +1,69 @@
+/*
+ * Parallel For-Each Example
+ *
+ * This file demonstrates spreading per-element work over several threads for
+ * a DynArray and for an IntList. The implementation supports:
+ *
+ * - Chunked parallel iteration over a contiguous array
+ * - Parallel list processing after a run-ahead partitioning pass
+ * - Reusing one thread pool across calls
+ *
+ * Key concepts demonstrated:
+ * - Data parallelism over contiguous memory
+ * - Splitting a linked structure into independent segments
+ * - Thread-safe callbacks using atomics instead of locks
+ *
+ * Build with: cc -pthread ds/parallel.c
+ */
+
+#include <stdatomic.h>
+#include <stdio.h>
+
+#include "dyn_array.h"
+#include "linked_list.h"
+#include "parallel.h"
+
+/**
+ * Example transform: squares an int in place.
+ */
+static void square_elem(void* elem, size_t idx, void* ctx) {
+    (void)idx;
+    (void)ctx;
+    int* value = elem;
+    *value = *value * *value;
+}
+
+/* NodeFn carries no context, so the list example accumulates into an atomic */
+static atomic_llong node_sum;
+
+static void sum_node(IntNode* node) {
+    atomic_fetch_add_explicit(&node_sum, node->value, memory_order_relaxed);
+}
+
+int main(void) {
+    /* Square a million ints on 4 threads */
+    DynArray values;
+    new_dyn_array(sizeof(int), &values);
+    for (int i = 0; i < 1000000; ++i) {
+        int value = i % 1000;
+        push_dyn_array(&values, &value);
+    }
+    parallel_for_each_dyn_array(&values, square_elem, NULL, 4);
+    printf("values[999] = %d, values[123456] = %d\n",
+           ((int*)values.items)[999], ((int*)values.items)[123456]);
+
+    /* Sum a pooled list on 4 threads */
+    IntNodePool pool;
+    init_int_node_pool(&pool, 0);
+    IntList list = {NULL, NULL, NULL};
+    for (int i = 0; i < 100000; ++i) {
+        push_node_pooled(&pool, &list, i);
+    }
+    parallel_process_list(list.head, sum_node, 4);
+    printf("List sum: %lld (expected %lld)\n", (long long)atomic_load(&node_sum), 100000LL * 99999 / 2);
+
+    release_list_pooled(&pool, &list);
+    free_int_node_pool(&pool);
+    free_dyn_array(&values);
+    return 0;
+}
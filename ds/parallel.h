@@ -0,0 +1,222 @@
+/*
+ * Parallel For-Each over DynArray and IntList
+ *
+ * Runs a per-element callback on many threads using a shared ThreadPool.
+ *
+ * - DynArray: the contiguous buffer is cut into chunks (several per thread,
+ *   for load balancing) and each chunk is processed by one thread.
+ * - IntList: a list cannot be split without walking it, so one thread first
+ *   runs ahead and records every PARALLEL_LIST_SEGMENT-th node; the segments
+ *   between those nodes are then processed in parallel. This pays off when
+ *   the callback costs more than following a pointer.
+ *
+ * The pool is shared by the whole process. It starts with one thread per
+ * online CPU and grows when a call asks for more threads.
+ *
+ * Callbacks are invoked concurrently and must be thread-safe. A callback may
+ * itself call the parallel operations: the shared pool is busy with the
+ * outer call, so the nested one runs on the calling thread.
+ * Requires POSIX threads and C11 atomics.
+ */
+
+#ifndef DS_PARALLEL_H
+#define DS_PARALLEL_H
+
+#include <pthread.h>
+#include <stddef.h>
+#include <unistd.h>
+
+#include "dyn_array.h"
+#include "linked_list.h"
+#include "thread_pool.h"
+
+/* Chunks per thread, so threads that finish early pick up remaining work */
+#define PARALLEL_CHUNKS_PER_THREAD 4
+/* Elements below which a chunk is not worth a thread */
+#define PARALLEL_MIN_CHUNK 4096
+/* Nodes per list segment recorded by the run-ahead pass */
+#define PARALLEL_LIST_SEGMENT 1024
+
+/**
+ * Element callback for parallel_for_each_dyn_array.
+ */
+typedef void (*ElemFn)(void* elem, size_t idx, void* ctx);
+
+/* Most threads the shared pool grows to, whatever callers ask for */
+#define PARALLEL_MAX_THREADS 1024
+
+/**
+ * Pool shared by the parallel operations, started on first use and kept for
+ * the life of the process.
+ */
+typedef struct {
+    pthread_mutex_t lock;  /* Protects started and threads, serializes growth */
+    ThreadPool pool;
+    int started;           /* Nonzero once pool has been initialized */
+    size_t threads;        /* Threads a batch can use: workers + the caller (0 if the pool failed to start) */
+} ParallelPool;
+
+/* Weak, so every translation unit shares one pool */
+__attribute__((weak)) ParallelPool ds_parallel_pool = {.lock = PTHREAD_MUTEX_INITIALIZER};
+
+/**
+ * Returns the number of threads used when a caller passes nthreads == 0:
+ * PARALLEL_DEFAULT_THREADS if defined before including this header,
+ * otherwise the number of online CPUs.
+ */
+static inline size_t default_parallel_threads(void) {
+#if defined(PARALLEL_DEFAULT_THREADS)
+    return PARALLEL_DEFAULT_THREADS;
+#elif defined(_SC_NPROCESSORS_ONLN)
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    return cpus > 0 ? (size_t)cpus : 1;
+#else
+    return 8;
+#endif
+}
+
+/**
+ * Returns the shared pool, started on first use and grown so that it offers
+ * nthreads threads if possible.
+ *
+ * @param nthreads Threads wanted including the caller (0 = default_parallel_threads())
+ * @param usable Where the number of threads the caller may use is stored (at most nthreads)
+ * @return The pool, or NULL if no pool could be started (run on the calling thread)
+ */
+static inline ThreadPool* get_parallel_pool(size_t nthreads, size_t* usable) {
+    if (nthreads == 0) {
+        nthreads = default_parallel_threads();
+    }
+    if (nthreads > PARALLEL_MAX_THREADS) {
+        nthreads = PARALLEL_MAX_THREADS;
+    }
+    ParallelPool* shared = &ds_parallel_pool;
+    pthread_mutex_lock(&shared->lock);
+    if (!shared->started) {
+        shared->started = 1;
+        size_t want = nthreads > default_parallel_threads() ? nthreads : default_parallel_threads();
+        if (init_thread_pool(&shared->pool, want - 1)) {
+            shared->threads = shared->pool.nworkers + 1;
+        }
+    } else if (shared->threads != 0 && nthreads > shared->threads) {
+        grow_thread_pool(&shared->pool, nthreads - 1);
+        shared->threads = shared->pool.nworkers + 1;
+    }
+    size_t threads = shared->threads;
+    pthread_mutex_unlock(&shared->lock);
+
+    *usable = threads < nthreads ? threads : nthreads;
+    return threads != 0 ? &shared->pool : NULL;
+}
+
+/**
+ * Work description for one parallel_for_each_dyn_array call.
+ */
+typedef struct {
+    DynArray* array;
+    ElemFn fn;
+    void* ctx;
+    size_t chunk;   /* Elements per task */
+} ArrayForEachJob;
+
+static inline void run_array_chunk(void* arg, size_t task) {
+    ArrayForEachJob* job = arg;
+    size_t first = task * job->chunk;
+    size_t last = first + job->chunk < job->array->count ? first + job->chunk : job->array->count;
+    char* elem = (char*)job->array->items + first * job->array->size;
+    for (size_t i = first; i < last; ++i, elem += job->array->size) {
+        job->fn(elem, i, job->ctx);
+    }
+}
+
+/**
+ * Calls fn on every element of the array, spread over up to nthreads threads.
+ * Each thread gets contiguous chunks; small arrays run on the calling thread.
+ *
+ * @param array Pointer to the dynamic array (must not be resized meanwhile)
+ * @param fn Callback receiving each element, its index and ctx; called concurrently
+ * @param ctx Opaque caller state passed to every call
+ * @param nthreads Maximum number of threads including the caller (0 = one per online CPU)
+ */
+static inline void parallel_for_each_dyn_array(DynArray* array, ElemFn fn, void* ctx, size_t nthreads) {
+    ThreadPool* pool = get_parallel_pool(nthreads, &nthreads);
+    if (pool == NULL) {
+        nthreads = 1;
+    }
+
+    ArrayForEachJob job = {array, fn, ctx, 0};
+    size_t tasks = nthreads * PARALLEL_CHUNKS_PER_THREAD;
+    job.chunk = (array->count + tasks - 1) / tasks;
+    if (job.chunk < PARALLEL_MIN_CHUNK) {
+        job.chunk = PARALLEL_MIN_CHUNK;
+    }
+    tasks = (array->count + job.chunk - 1) / job.chunk;
+
+    if (pool == NULL || tasks <= 1) {
+        for (size_t t = 0; t < tasks; ++t) {
+            run_array_chunk(&job, t);
+        }
+        return;
+    }
+    run_thread_pool(pool, run_array_chunk, &job, tasks, nthreads);
+}
+
+/**
+ * Work description for one parallel_process_list call.
+ */
+typedef struct {
+    IntNode** starts;   /* First node of every segment */
+    size_t nsegments;
+    NodeFn fn;
+} ListForEachJob;
+
+static inline void run_list_segment(void* arg, size_t task) {
+    ListForEachJob* job = arg;
+    IntNode* node = job->starts[task];
+    /* Stop where the next segment starts */
+    IntNode* end = task + 1 < job->nsegments ? job->starts[task + 1] : NULL;
+    while (node != end) {
+        IntNode* next = node->next;
+        job->fn(node);
+        node = next;
+    }
+}
+
+/**
+ * Parallel process_list: calls nfn on every node, spread over up to nthreads threads.
+ * One run-ahead pass records segment boundaries, then segments run in parallel.
+ * Nodes are visited in an unspecified order.
+ *
+ * @param node Starting node for the walk (NULL for an empty list)
+ * @param nfn Function to apply to each node; called concurrently,
+ *            must not change next pointers
+ * @param nthreads Maximum number of threads including the caller (0 = one per online CPU)
+ * @return 1 on success, 0 if the segment table could not be allocated
+ *         (the list is then processed on the calling thread)
+ */
+static inline int parallel_process_list(IntNode* node, NodeFn nfn, size_t nthreads) {
+    ThreadPool* pool = get_parallel_pool(nthreads, &nthreads);
+    if (pool == NULL || nthreads == 1) {
+        process_list(node, nfn);
+        return 1;
+    }
+
+    /* Run ahead, recording the first node of every segment */
+    DynArray starts;
+    new_dyn_array(sizeof(IntNode*), &starts);
+    size_t i = 0;
+    for (IntNode* cur = node; cur != NULL; cur = cur->next, ++i) {
+        if (i % PARALLEL_LIST_SEGMENT == 0 && !push_dyn_array(&starts, &cur)) {
+            free_dyn_array(&starts);
+            process_list(node, nfn);
+            return 0;
+        }
+    }
+
+    ListForEachJob job = {starts.items, starts.count, nfn};
+    run_thread_pool(pool, run_list_segment, &job, job.nsegments, nthreads);
+    free_dyn_array(&starts);
+    return 1;
+}
+
+#endif /* DS_PARALLEL_H */
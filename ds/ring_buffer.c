@@ -0,0 +1,74 @@
+/*
+ * Ring Buffer / Deque Example
+ *
+ * This file demonstrates using DynDeque as a FIFO work queue of User
+ * records and as a double-ended queue. The implementation supports:
+ *
+ * - O(1) push and pop at both ends
+ * - Growth through the DynArray growth policy, even while wrapped
+ * - Processing queued elements in bulk through two contiguous spans
+ *
+ * Key concepts demonstrated:
+ * - Circular buffers with head/count indices
+ * - Reusing DynArray storage and growth for another container
+ * - Batch consumption instead of per-element dequeues
+ */
+
+#include <stdio.h>
+
+#include "ring_buffer.h"
+#include "user.h"
+
+/**
+ * Prints the queue front to back.
+ */
+static void print_user_deque(const DynDeque* deque) {
+    printf("Deque state (head %zu, capacity %zu):\n", deque->head, deque->buffer.cap);
+    for (size_t i = 0; i < deque->count; ++i) {
+        User* user = at_dyn_deque(deque, i);
+        printf("Position: [%zu], name: %s, id: %d\n", i, user->name, user->id);
+    }
+    printf("---\n");
+}
+
+int main(void) {
+    DynDeque queue;
+    init_dyn_deque(sizeof(User), NULL, &queue);
+
+    /* FIFO: enqueue at the back, dequeue at the front without moving the rest */
+    for (short i = 0; i < 6; ++i) {
+        User user = {"user", i};
+        snprintf(user.name, sizeof(user.name), "user-%d", i);
+        push_back_dyn_deque(&queue, &user);
+    }
+    User user;
+    pop_front_dyn_deque(&queue, &user);
+    printf("Dequeued %s\n", user.name);
+    pop_front_dyn_deque(&queue, NULL);
+
+    /* Refill past the end of the buffer so the queue wraps, then grow while wrapped */
+    User batch[] = {{"mordecai", 10}, {"rigby", 11}, {"benson", 12}};
+    push_back_many_dyn_deque(&queue, batch, 3);
+    User front = {"pops", 9};
+    push_front_dyn_deque(&queue, &front);
+    print_user_deque(&queue);
+
+    /* Bulk processing: visit each contiguous span, then drop them all at once */
+    DynDequeSpan spans[2];
+    size_t nspans = spans_dyn_deque(&queue, spans);
+    int id_sum = 0;
+    for (size_t s = 0; s < nspans; ++s) {
+        const User* users = spans[s].items;
+        for (size_t i = 0; i < spans[s].count; ++i) {
+            id_sum += users[i].id;
+        }
+    }
+    printf("Processed %zu users in %zu span(s), id sum %d\n", queue.count, nspans, id_sum);
+    drop_front_dyn_deque(&queue, queue.count - 1);
+
+    pop_back_dyn_deque(&queue, &user);
+    printf("Popped back %s, %zu left\n", user.name, queue.count);
+
+    free_dyn_deque(&queue);
+    return 0;
+}
@@ -0,0 +1,265 @@
+/*
+ * Ring Buffer / Deque on DynArray Storage
+ *
+ * DynDeque keeps its elements in a DynArray's buffer used as a circular
+ * buffer: a head index and a count describe the live range, which may wrap
+ * around the end of the buffer. Pushing and popping at either end is O(1),
+ * so using it as a FIFO does not pay a memmove per dequeue like popping the
+ * front of a DynArray would.
+ *
+ * The buffer grows with the DynArray growth policy (DynArrayOptions) and
+ * reallocate, so allocator, growth factor and chunking all apply. After a
+ * resize, the shorter of the two wrapped pieces is moved so the range stays
+ * contiguous modulo the new capacity.
+ *
+ * The live range is exposed as at most two contiguous spans, for batch
+ * processing with memcpy or vectorized loops instead of per-element calls.
+ */
+
+#ifndef DS_RING_BUFFER_H
+#define DS_RING_BUFFER_H
+
+#include <stddef.h>
+#include <string.h>
+
+#include "dyn_array.h"
+
+/**
+ * Double-ended queue over a circular DynArray buffer.
+ * buffer.cap is the ring capacity; buffer.count is not the number of queued
+ * elements (use count), it is set to cap whenever the buffer is resized so
+ * every slot is preserved.
+ */
+typedef struct {
+    DynArray buffer;  /* Ring storage and growth policy */
+    size_t head;      /* Physical index of the first element */
+    size_t count;     /* Number of queued elements */
+} DynDeque;
+
+/**
+ * Contiguous run of queued elements.
+ */
+typedef struct {
+    void* items;    /* First element of the run */
+    size_t count;   /* Number of elements in the run */
+} DynDequeSpan;
+
+/**
+ * Initializes an empty deque.
+ *
+ * @param size Size of each element in bytes (use sizeof())
+ * @param options Growth policy, or NULL for the defaults
+ * @param deque Pointer to caller-allocated deque
+ * @return 1 on success, 0 if the initial allocation failed
+ */
+static inline int init_dyn_deque(size_t size, const DynArrayOptions* options, DynDeque* deque) {
+    deque->head = 0;
+    deque->count = 0;
+    return init_dyn_array(size, options, &deque->buffer);
+}
+
+/**
+ * Maps a logical position (0 = front) to a physical buffer index.
+ */
+static inline size_t phys_dyn_deque(const DynDeque* deque, size_t pos) {
+    size_t idx = deque->head + pos;
+    return idx >= deque->buffer.cap ? idx - deque->buffer.cap : idx;
+}
+
+/**
+ * Returns a pointer to the element at logical position pos (0 = front).
+ *
+ * @param deque Pointer to the deque
+ * @param pos Position, must be < count
+ * @return Pointer to the element, valid until the deque is resized
+ */
+static inline void* at_dyn_deque(const DynDeque* deque, size_t pos) {
+    return (char*)deque->buffer.items + phys_dyn_deque(deque, pos) * deque->buffer.size;
+}
+
+/**
+ * Ensures room for n more elements, growing at most once.
+ * If the live range wraps, the shorter wrapped piece is moved into the new space.
+ *
+ * @param deque Pointer to the deque
+ * @param n Number of elements about to be added
+ * @return 1 on success, 0 on overflow or if growing failed (the deque is unchanged)
+ */
+static inline int grow_for_dyn_deque(DynDeque* deque, size_t n) {
+    DynArray* buffer = &deque->buffer;
+    if (n > (size_t)-1 - deque->count) {
+        return 0;
+    }
+    if (deque->count + n <= buffer->cap) {
+        return 1;
+    }
+
+    size_t old_cap = buffer->cap;
+    size_t new_cap = next_cap_dyn_array(buffer, deque->count + n);
+    buffer->count = old_cap;   /* All slots are data as far as the copy is concerned */
+    if (!resize_dyn_array(buffer, new_cap)) {
+        return 0;
+    }
+
+    if (deque->head + deque->count > old_cap) {
+        char* items = buffer->items;
+        size_t size = buffer->size;
+        size_t front = old_cap - deque->head;             /* Elements in [head, old_cap) */
+        size_t back = deque->count - front;               /* Elements wrapped to [0, back) */
+        if (back <= new_cap - old_cap && back < front) {
+            /* Append the wrapped piece after the old end */
+            memcpy(items + old_cap * size, items, back * size);
+        } else {
+            /* Move the front piece to the end of the new buffer */
+            size_t new_head = new_cap - front;
+            memmove(items + new_head * size, items + deque->head * size, front * size);
+            deque->head = new_head;
+        }
+    }
+    return 1;
+}
+
+/**
+ * Appends an element at the back.
+ *
+ * @param deque Pointer to the deque
+ * @param val Pointer to the element to add
+ * @return 1 on success, 0 if growing failed
+ */
+static inline int push_back_dyn_deque(DynDeque* deque, const void* val) {
+    if (!grow_for_dyn_deque(deque, 1)) {
+        return 0;
+    }
+    memcpy(at_dyn_deque(deque, deque->count), val, deque->buffer.size);
+    deque->count++;
+    return 1;
+}
+
+/**
+ * Prepends an element at the front.
+ *
+ * @param deque Pointer to the deque
+ * @param val Pointer to the element to add
+ * @return 1 on success, 0 if growing failed
+ */
+static inline int push_front_dyn_deque(DynDeque* deque, const void* val) {
+    if (!grow_for_dyn_deque(deque, 1)) {
+        return 0;
+    }
+    deque->head = deque->head == 0 ? deque->buffer.cap - 1 : deque->head - 1;
+    memcpy(at_dyn_deque(deque, 0), val, deque->buffer.size);
+    deque->count++;
+    return 1;
+}
+
+/**
+ * Removes the front element.
+ *
+ * @param deque Pointer to the deque
+ * @param popped Optional pointer where the removed value will be copied
+ * @return 1 on success, 0 if the deque is empty
+ */
+static inline int pop_front_dyn_deque(DynDeque* deque, void* popped) {
+    if (deque->count == 0) {
+        return 0;
+    }
+    if (popped != NULL) {
+        memcpy(popped, at_dyn_deque(deque, 0), deque->buffer.size);
+    }
+    deque->head = phys_dyn_deque(deque, 1);
+    /* An empty deque restarts at slot 0, so the next batch is one contiguous span */
+    if (--deque->count == 0) {
+        deque->head = 0;
+    }
+    return 1;
+}
+
+/**
+ * Removes the back element.
+ *
+ * @param deque Pointer to the deque
+ * @param popped Optional pointer where the removed value will be copied
+ * @return 1 on success, 0 if the deque is empty
+ */
+static inline int pop_back_dyn_deque(DynDeque* deque, void* popped) {
+    if (deque->count == 0) {
+        return 0;
+    }
+    if (popped != NULL) {
+        memcpy(popped, at_dyn_deque(deque, deque->count - 1), deque->buffer.size);
+    }
+    if (--deque->count == 0) {
+        deque->head = 0;
+    }
+    return 1;
+}
+
+/**
+ * Appends n contiguous elements at the back with at most two memcpy calls.
+ *
+ * @param deque Pointer to the deque
+ * @param src Pointer to the first of n elements
+ * @param n Number of elements to append
+ * @return 1 on success, 0 if growing failed
+ */
+static inline int push_back_many_dyn_deque(DynDeque* deque, const void* src, size_t n) {
+    if (n == 0) {
+        return 1;
+    }
+    if (!grow_for_dyn_deque(deque, n)) {
+        return 0;
+    }
+    size_t size = deque->buffer.size;
+    size_t start = phys_dyn_deque(deque, deque->count);
+    size_t first = deque->buffer.cap - start < n ? deque->buffer.cap - start : n;
+    memcpy((char*)deque->buffer.items + start * size, src, first * size);
+    memcpy(deque->buffer.items, (const char*)src + first * size, (n - first) * size);
+    deque->count += n;
+    return 1;
+}
+
+/**
+ * Removes n elements from the front, e.g. after processing them through spans_dyn_deque.
+ *
+ * @param deque Pointer to the deque
+ * @param n Number of elements to drop, at most count
+ * @return 1 on success, 0 if the deque holds fewer than n elements
+ */
+static inline int drop_front_dyn_deque(DynDeque* deque, size_t n) {
+    if (n > deque->count) {
+        return 0;
+    }
+    deque->count -= n;
+    deque->head = deque->count == 0 ? 0 : phys_dyn_deque(deque, n);
+    return 1;
+}
+
+/**
+ * Describes the queued elements, front to back, as at most two contiguous spans.
+ *
+ * @param deque Pointer to the deque
+ * @param spans Filled with the spans; unused entries get count 0
+ * @return Number of non-empty spans (0, 1 or 2)
+ */
+static inline size_t spans_dyn_deque(const DynDeque* deque, DynDequeSpan spans[2]) {
+    size_t size = deque->buffer.size;
+    size_t first = deque->buffer.cap - deque->head < deque->count ? deque->buffer.cap - deque->head : deque->count;
+    spans[0].items = (char*)deque->buffer.items + deque->head * size;
+    spans[0].count = first;
+    spans[1].items = deque->buffer.items;
+    spans[1].count = deque->count - first;
+    return (spans[0].count > 0) + (spans[1].count > 0);
+}
+
+/**
+ * Releases the deque's buffer and resets it to empty.
+ *
+ * @param deque Pointer to the deque
+ */
+static inline void free_dyn_deque(DynDeque* deque) {
+    free_dyn_array(&deque->buffer);
+    deque->head = 0;
+    deque->count = 0;
+}
+
+#endif /* DS_RING_BUFFER_H */
@@ -0,0 +1,92 @@
+/*
+ * Serialization Example
+ *
+ * This file demonstrates checkpointing a DynArray of User records and an
+ * IntList to disk and restoring them. The implementation supports:
+ *
+ * - Saving a DynArray as a header plus raw element bytes
+ * - Restoring it with one read, straight into caller-provided storage
+ * - Viewing a serialized array in a memory buffer without copying it
+ * - Saving an IntList as delta + zigzag varint encoded values
+ * - Restoring an IntList from a single bulk node-pool allocation
+ *
+ * Key concepts demonstrated:
+ * - Self-describing binary headers (magic, version, element size, count)
+ * - Variable-length integer encoding
+ * - Avoiding per-element work when loading
+ */
+
+#include <stdio.h>
+
+#include "serialize.h"
+#include "user.h"
+
+int main(void) {
+    const char* path = "/tmp/ds_serialized.bin";
+
+    /* Some users and a list of slowly increasing values */
+    DynArray users;
+    new_dyn_array(sizeof(User), &users);
+    for (short i = 0; i < 100; ++i) {
+        User user = {"user", i};
+        snprintf(user.name, sizeof(user.name), "user-%d", i);
+        push_dyn_array(&users, &user);
+    }
+    IntNodePool pool;
+    init_int_node_pool(&pool, 0);
+    IntList list = {NULL, NULL, NULL};
+    for (int i = 0; i < 10000; ++i) {
+        push_node_pooled(&pool, &list, 1000 + i * 3 - (i % 7));
+    }
+
+    /* Save both to one checkpoint file */
+    FILE* out = fopen(path, "wb");
+    if (out == NULL || !write_dyn_array(out, &users) || !write_int_list(out, &list)) {
+        perror("write checkpoint");
+        return 1;
+    }
+    long list_offset = (long)serialized_size_dyn_array(&users);
+    printf("Checkpoint: %zu users in %ld bytes, %d list values in %ld bytes (%zu raw)\n",
+           users.count, list_offset, 10000, ftell(out) - list_offset, 10000 * sizeof(int));
+    fclose(out);
+
+    /* Restore into caller-provided storage: one read, no allocation, no per-user work */
+    SMALL_DYN_ARRAY(User, 128) restored;
+    INIT_SMALL_DYN_ARRAY(restored);
+    IntList restored_list = {NULL, NULL, NULL};
+    FILE* in = fopen(path, "rb");
+    if (in == NULL || !read_dyn_array(in, &restored.array) || !read_int_list(in, &pool, &restored_list)) {
+        perror("read checkpoint");
+        return 1;
+    }
+    fclose(in);
+
+    User* last = (User*)restored.array.items + restored.array.count - 1;
+    printf("Restored %zu users (inline: %s), last: %s, id: %d\n", restored.array.count,
+           restored.array.items == restored.storage ? "yes" : "no", last->name, last->id);
+
+    int same = 1;
+    const IntNode* a = list.head;
+    const IntNode* b = restored_list.head;
+    for (; a != NULL && b != NULL; a = a->next, b = b->next) {
+        same = same && a->value == b->value;
+    }
+    printf("Restored list matches: %s\n", same && a == NULL && b == NULL ? "yes" : "no");
+
+    /* An in-memory buffer can be used in place, without copying the users out */
+    DynArray bytes;
+    new_dyn_array(1, &bytes);
+    serialize_dyn_array(&users, &bytes);
+    size_t count = 0;
+    const User* view = view_serialized_dyn_array(bytes.items, bytes.count, sizeof(User), &count);
+    printf("Viewed %zu users in place, first: %s\n", count, view != NULL ? view[0].name : "(invalid)");
+
+    free_dyn_array(&bytes);
+    free_dyn_array(&restored.array);
+    free_dyn_array(&users);
+    release_list_pooled(&pool, &list);
+    release_list_pooled(&pool, &restored_list);
+    free_int_node_pool(&pool);
+    remove(path);
+    return 0;
+}
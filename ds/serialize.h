@@ -0,0 +1,362 @@
+/*
+ * Binary Serialization for DynArray and IntList
+ *
+ * Both containers are stored as a fixed 64-byte SerialHeader (magic, version,
+ * element size, count, payload size) followed by a payload:
+ *
+ * - DynArray: the raw element bytes, so saving is one write and loading is
+ *   one read (or no copy at all, see view_serialized_dyn_array). This is the
+ *   same layout mapped_array.h uses, so a saved array can also be opened
+ *   with open_mapped_dyn_array.
+ * - IntList: the values as zigzag varints of the difference to the previous
+ *   value, which takes one or two bytes per node for sorted or clustered
+ *   data. Loading takes all nodes from the pool in one bulk allocation.
+ *
+ * Data is written in native byte order and element layout, so files are meant
+ * to be read back on the same architecture (checkpoints, local IPC).
+ * DynArray serialization only suits plain-data element types (no pointers).
+ */
+
+#ifndef DS_SERIALIZE_H
+#define DS_SERIALIZE_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "dyn_array.h"
+#include "linked_list.h"
+#include "varint.h"
+
+#define SERIAL_DYN_ARRAY_MAGIC "DYNARRAY"
+#define SERIAL_INT_LIST_MAGIC "INTLISTZ"
+#define SERIAL_VERSION 1u
+
+/**
+ * Header in front of every serialized container, padded to 64 bytes so the
+ * payload that follows is cache-line aligned in an aligned buffer.
+ */
+typedef struct {
+    char magic[8];           /* SERIAL_DYN_ARRAY_MAGIC or SERIAL_INT_LIST_MAGIC, not NUL-terminated */
+    uint32_t version;        /* SERIAL_VERSION */
+    uint32_t header_size;    /* sizeof(SerialHeader), offset of the payload */
+    uint64_t elem_size;      /* Size of each element in bytes (sizeof(int) for lists) */
+    uint64_t count;          /* Number of elements */
+    uint64_t payload_bytes;  /* Size of the payload in bytes */
+    unsigned char reserved[24];
+} SerialHeader;
+
+_Static_assert(sizeof(SerialHeader) == 64, "SerialHeader must be 64 bytes");
+
+/**
+ * Fills in a header for count elements of elem_size bytes.
+ */
+static inline void init_serial_header(SerialHeader* header, const char* magic, size_t elem_size,
+                                      size_t count, size_t payload_bytes) {
+    memset(header, 0, sizeof(*header));
+    memcpy(header->magic, magic, sizeof(header->magic));
+    header->version = SERIAL_VERSION;
+    header->header_size = sizeof(SerialHeader);
+    header->elem_size = elem_size;
+    header->count = count;
+    header->payload_bytes = payload_bytes;
+}
+
+/**
+ * Checks magic, version and header size.
+ *
+ * @return 1 if the header is one this code can read, 0 otherwise
+ */
+static inline int check_serial_header(const SerialHeader* header, const char* magic) {
+    return memcmp(header->magic, magic, sizeof(header->magic)) == 0 &&
+           header->version == SERIAL_VERSION &&
+           header->header_size == sizeof(SerialHeader);
+}
+
+/**
+ * Checks a DynArray header against the element size the caller expects.
+ *
+ * @return 1 if count elements of size bytes make up exactly the payload
+ */
+static inline int check_dyn_array_header(const SerialHeader* header, size_t size) {
+    return check_serial_header(header, SERIAL_DYN_ARRAY_MAGIC) &&
+           size != 0 && header->elem_size == size &&
+           header->count <= SIZE_MAX / size &&
+           header->payload_bytes == header->count * size;
+}
+
+/**
+ * Returns the number of bytes serialize_dyn_array appends for the array.
+ */
+static inline size_t serialized_size_dyn_array(const DynArray* array) {
+    return sizeof(SerialHeader) + array->count * array->size;
+}
+
+/**
+ * Appends the serialized array (header + raw elements) to a byte buffer.
+ *
+ * @param array Pointer to the array to serialize
+ * @param out Byte array (element size 1) the data is appended to
+ * @return 1 on success, 0 if out could not grow
+ */
+static inline int serialize_dyn_array(const DynArray* array, DynArray* out) {
+    SerialHeader header;
+    size_t payload = array->count * array->size;
+    init_serial_header(&header, SERIAL_DYN_ARRAY_MAGIC, array->size, array->count, payload);
+    if (!grow_for_dyn_array(out, sizeof(header) + payload)) {
+        return 0;
+    }
+    push_many_dyn_array(out, &header, sizeof(header));
+    push_many_dyn_array(out, array->items, payload);
+    return 1;
+}
+
+/**
+ * Zero-copy load: validates a serialized array and returns its elements in place.
+ * The elements stay in buf, which must outlive their use and, for element types
+ * with alignment requirements, be suitably aligned (the payload starts 64 bytes in).
+ *
+ * @param buf Serialized data
+ * @param len Length of buf in bytes
+ * @param size Expected size of each element in bytes
+ * @param count Where the number of elements is stored
+ * @return Pointer to the first element, or NULL if buf is not a valid array of
+ *         size-byte elements (an empty array yields a non-NULL pointer and count 0)
+ */
+static inline const void* view_serialized_dyn_array(const void* buf, size_t len, size_t size, size_t* count) {
+    SerialHeader header;
+    if (len < sizeof(header)) {
+        return NULL;
+    }
+    memcpy(&header, buf, sizeof(header));
+    if (!check_dyn_array_header(&header, size) || header.payload_bytes > len - sizeof(header)) {
+        return NULL;
+    }
+    *count = (size_t)header.count;
+    return (const char*)buf + sizeof(header);
+}
+
+/**
+ * Replaces the array's contents with the serialized elements in buf:
+ * at most one allocation and a single memcpy, no per-element work.
+ * An array on inline storage that is large enough is loaded without allocating.
+ *
+ * @param buf Serialized data
+ * @param len Length of buf in bytes
+ * @param array Initialized array whose element size must match the data
+ * @return 1 on success, 0 if buf is invalid or the array could not grow
+ *         (the array is then unchanged)
+ */
+static inline int deserialize_dyn_array(const void* buf, size_t len, DynArray* array) {
+    size_t count;
+    const void* items = view_serialized_dyn_array(buf, len, array->size, &count);
+    if (items == NULL || !reserve_dyn_array(array, count)) {
+        return 0;
+    }
+    if (count > 0) {
+        memcpy(array->items, items, count * array->size);
+    }
+    array->count = count;
+    return 1;
+}
+
+/**
+ * Writes the serialized array to a stream: the header and all elements
+ * in two fwrite calls.
+ *
+ * @param out Stream opened for binary writing
+ * @param array Pointer to the array to write
+ * @return 1 on success, 0 on a write error
+ */
+static inline int write_dyn_array(FILE* out, const DynArray* array) {
+    SerialHeader header;
+    size_t payload = array->count * array->size;
+    init_serial_header(&header, SERIAL_DYN_ARRAY_MAGIC, array->size, array->count, payload);
+    if (fwrite(&header, sizeof(header), 1, out) != 1) {
+        return 0;
+    }
+    return payload == 0 || fwrite(array->items, payload, 1, out) == 1;
+}
+
+/**
+ * Reads a serialized array from a stream, replacing the array's contents.
+ * The elements are read straight into the array's buffer with one fread,
+ * so an array on large enough inline or reserved storage is loaded without allocating.
+ *
+ * @param in Stream opened for binary reading, positioned at a header
+ * @param array Initialized array whose element size must match the data
+ * @return 1 on success, 0 on a read error, invalid data, or failed allocation
+ *         (the array's contents are then unspecified but it stays valid)
+ */
+static inline int read_dyn_array(FILE* in, DynArray* array) {
+    SerialHeader header;
+    if (fread(&header, sizeof(header), 1, in) != 1 || !check_dyn_array_header(&header, array->size)) {
+        return 0;
+    }
+    size_t count = (size_t)header.count;
+    array->count = 0;
+    if (!reserve_dyn_array(array, count)) {
+        return 0;
+    }
+    if (count > 0 && fread(array->items, count * array->size, 1, in) != 1) {
+        return 0;
+    }
+    array->count = count;
+    return 1;
+}
+
+/**
+ * Appends the serialized list (header + delta varints) to a byte buffer.
+ *
+ * @param list Pointer to the list to serialize
+ * @param out Byte array (element size 1) the data is appended to
+ * @return 1 on success, 0 if out could not grow (out is then restored)
+ */
+static inline int serialize_int_list(const IntList* list, DynArray* out) {
+    size_t start = out->count;
+    SerialHeader header;
+    init_serial_header(&header, SERIAL_INT_LIST_MAGIC, sizeof(int), 0, 0);
+    if (!push_many_dyn_array(out, &header, sizeof(header))) {
+        return 0;
+    }
+
+    size_t count = 0;
+    int64_t prev = 0;
+    for (const IntNode* node = list->head; node != NULL; node = node->next) {
+        if (!grow_for_dyn_array(out, VARINT_MAX_BYTES)) {
+            out->count = start;
+            return 0;
+        }
+        unsigned char* dest = (unsigned char*)out->items + out->count;
+        out->count += encode_varint(dest, zigzag_encode((int64_t)node->value - prev));
+        prev = node->value;
+        count++;
+    }
+
+    /* Now that the sizes are known, patch the header (out may have moved) */
+    header.count = count;
+    header.payload_bytes = out->count - start - sizeof(header);
+    memcpy((char*)out->items + start, &header, sizeof(header));
+    return 1;
+}
+
+/**
+ * Decodes a list payload into nodes taken from the pool in one bulk
+ * allocation and appends them to the list.
+ *
+ * @return 1 on success, 0 if the payload is malformed or the pool could not allocate
+ *         (the list is then unchanged)
+ */
+static inline int decode_int_list_payload(const SerialHeader* header, const unsigned char* payload,
+                                          IntNodePool* pool, IntList* list) {
+    size_t count = (size_t)header->count;
+    if (count == 0) {
+        return 1;
+    }
+    /* Every varint takes at least one byte, which bounds count before allocating */
+    if (header->count > header->payload_bytes) {
+        return 0;
+    }
+    IntNode* nodes = alloc_pooled_nodes(pool, count);
+    if (nodes == NULL) {
+        return 0;
+    }
+
+    const unsigned char* in = payload;
+    const unsigned char* end = payload + header->payload_bytes;
+    int64_t prev = 0;
+    for (size_t i = 0; i < count; ++i) {
+        uint64_t delta;
+        int64_t value;
+        /* Consecutive ints differ by less than 2^32, which bounds a valid delta
+           before it is added, so untrusted input cannot overflow the sum */
+        if (!decode_varint(&in, end, &delta) || delta > (uint64_t)UINT32_MAX * 2 ||
+            (value = prev + zigzag_decode(delta)) < INT32_MIN || value > INT32_MAX) {
+            /* Give the nodes back, they are not linked into anything yet */
+            for (size_t j = 0; j < count; ++j) {
+                release_pooled_node(pool, &nodes[j]);
+            }
+            return 0;
+        }
+        nodes[i].value = (int)value;
+        nodes[i].next = &nodes[i + 1];
+        prev = value;
+    }
+    nodes[count - 1].next = NULL;
+
+    if (list->head == NULL) {
+        list->head = nodes;
+    } else {
+        list->tail->next = nodes;
+    }
+    list->tail = &nodes[count - 1];
+    return 1;
+}
+
+/**
+ * Loads a serialized list from buf and appends its values to the list.
+ * The nodes are adjacent in memory, so the loaded list traverses like an array.
+ *
+ * @param buf Serialized data
+ * @param len Length of buf in bytes
+ * @param pool Pool the nodes are taken from (release them with release_list_pooled)
+ * @param list Pointer to the list to append to
+ * @return 1 on success, 0 if buf is invalid or the pool could not allocate
+ *         (the list is then unchanged)
+ */
+static inline int deserialize_int_list(const void* buf, size_t len, IntNodePool* pool, IntList* list) {
+    SerialHeader header;
+    if (len < sizeof(header)) {
+        return 0;
+    }
+    memcpy(&header, buf, sizeof(header));
+    if (!check_serial_header(&header, SERIAL_INT_LIST_MAGIC) || header.elem_size != sizeof(int) ||
+        header.payload_bytes > len - sizeof(header)) {
+        return 0;
+    }
+    return decode_int_list_payload(&header, (const unsigned char*)buf + sizeof(header), pool, list);
+}
+
+/**
+ * Writes the serialized list to a stream with one fwrite.
+ *
+ * @param out Stream opened for binary writing
+ * @param list Pointer to the list to write
+ * @return 1 on success, 0 on a write error or if the encode buffer could not be allocated
+ */
+static inline int write_int_list(FILE* out, const IntList* list) {
+    DynArray bytes;
+    new_dyn_array(1, &bytes);
+    int ok = serialize_int_list(list, &bytes) && fwrite(bytes.items, bytes.count, 1, out) == 1;
+    free_dyn_array(&bytes);
+    return ok;
+}
+
+/**
+ * Reads a serialized list from a stream and appends its values to the list.
+ *
+ * @param in Stream opened for binary reading, positioned at a header
+ * @param pool Pool the nodes are taken from
+ * @param list Pointer to the list to append to
+ * @return 1 on success, 0 on a read error, invalid data, or failed allocation
+ *         (the list is then unchanged)
+ */
+static inline int read_int_list(FILE* in, IntNodePool* pool, IntList* list) {
+    SerialHeader header;
+    if (fread(&header, sizeof(header), 1, in) != 1 ||
+        !check_serial_header(&header, SERIAL_INT_LIST_MAGIC) || header.elem_size != sizeof(int) ||
+        header.payload_bytes > SIZE_MAX) {
+        return 0;
+    }
+
+    DynArray payload;
+    new_dyn_array(1, &payload);
+    size_t bytes = (size_t)header.payload_bytes;
+    int ok = reserve_dyn_array(&payload, bytes) &&
+             (bytes == 0 || fread(payload.items, bytes, 1, in) == 1) &&
+             decode_int_list_payload(&header, payload.items, pool, list);
+    free_dyn_array(&payload);
+    return ok;
+}
+
+#endif /* DS_SERIALIZE_H */
@@ -0,0 +1,84 @@
+/*
+ * SIMD Search Example
+ *
+ * This file demonstrates the vectorized search kernels on a DynArray of int
+ * and on the ids column of UserColumns, and checks every available
+ * implementation against the scalar one. The implementation supports:
+ *
+ * - find_first, count_if_equal and filter_into over short and int columns
+ * - Picking the best implementation for the running CPU
+ * - Forcing a specific implementation to compare them
+ *
+ * Key concepts demonstrated:
+ * - Runtime dispatch between SIMD instruction sets
+ * - Using the scalar implementation as the reference for the vector ones
+ */
+
+#include <stdio.h>
+
+#include "dyn_array.h"
+#include "simd_search.h"
+#include "user.h"
+#include "user_columns.h"
+
+static const char* simd_level_name(SimdLevel level) {
+    switch (level) {
+    case SIMD_LEVEL_SSE2: return "sse2";
+    case SIMD_LEVEL_AVX2: return "avx2";
+    case SIMD_LEVEL_NEON: return "neon";
+    default: return "scalar";
+    }
+}
+
+/**
+ * Runs the int kernels at the current level and prints the results.
+ */
+static void run_int_kernels(const DynArray* values) {
+    DynArray hits;
+    new_dyn_array(sizeof(size_t), &hits);
+    filter_into_dyn_array(values, 10, 12, &hits);
+
+    printf("[%s] first 42 at %zu, count of 7: %zu, values in [10, 12]: %zu (first at %zu)\n",
+           simd_level_name(get_simd_kernels()->level),
+           find_first_dyn_array(values, 42), count_if_equal_dyn_array(values, 7),
+           hits.count, hits.count ? ((size_t*)hits.items)[0] : 0);
+    free_dyn_array(&hits);
+}
+
+int main(void) {
+    /* A column of ints with a pattern that is easy to check by hand */
+    DynArray values;
+    new_dyn_array(sizeof(int), &values);
+    for (int i = 0; i < 1003; ++i) {
+        int value = i % 100;
+        push_dyn_array(&values, &value);
+    }
+
+    printf("Detected: %s\n", simd_level_name(detect_simd_level()));
+    const SimdLevel levels[] = {SIMD_LEVEL_SCALAR, SIMD_LEVEL_SSE2, SIMD_LEVEL_AVX2, SIMD_LEVEL_NEON};
+    for (size_t i = 0; i < sizeof(levels) / sizeof(levels[0]); ++i) {
+        /* Skip levels this build or CPU cannot run (they fall back to scalar) */
+        if (set_simd_level(levels[i]) == levels[i]) {
+            run_int_kernels(&values);
+        }
+    }
+    set_simd_level(detect_simd_level());
+
+    /* The same kernels over the ids column of UserColumns */
+    UserColumns columns;
+    init_user_columns(&columns, NULL);
+    for (short i = 0; i < 500; ++i) {
+        User user = {"user", (short)(i % 50)};
+        push_user_columns(&columns, &user);
+    }
+    DynArray rows;
+    new_dyn_array(sizeof(size_t), &rows);
+    filter_ids_user_columns(&columns, 48, 49, &rows);
+    printf("User id 49 first at row %zu, %zu users with id 3, %zu with id in [48, 49]\n",
+           find_id_user_columns(&columns, 49), count_id_user_columns(&columns, 3), rows.count);
+
+    free_dyn_array(&rows);
+    free_user_columns(&columns);
+    free_dyn_array(&values);
+    return 0;
+}
@@ -0,0 +1,424 @@
+/*
+ * SIMD Search and Filter Kernels
+ *
+ * Vectorized find_first / count_if_equal / filter_into over contiguous
+ * short and int columns: a DynArray of short or int, or the ids column of
+ * UserColumns. Each kernel compares a whole vector of elements at once and
+ * turns the comparison into a bitmask, so the loop runs at close to memory
+ * bandwidth instead of one compare-and-branch per element.
+ *
+ * Implementations: AVX2 (selected at runtime via __builtin_cpu_supports),
+ * SSE2 (baseline on x86-64), NEON (baseline on AArch64) and portable scalar
+ * code, which is also used for the tail of every vector loop. The SIMD paths
+ * need GCC or Clang; other compilers get the scalar kernels.
+ *
+ * Key concepts demonstrated:
+ * - Runtime CPU feature detection and dispatch through a function table
+ * - Per-function target attributes, so one binary carries several ISAs
+ * - Comparison masks (movemask) with count-trailing-zeros and popcount
+ * - Generating near-identical kernels with macros
+ */
+
+#ifndef DS_SIMD_SEARCH_H
+#define DS_SIMD_SEARCH_H
+
+#include <limits.h>
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "dyn_array.h"
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#define DS_SIMD_X86 1
+#include <immintrin.h>
+#elif defined(__GNUC__) && defined(__aarch64__)
+#define DS_SIMD_NEON 1
+#include <arm_neon.h>
+#endif
+
+/**
+ * Available kernel implementations, in increasing order of preference on x86.
+ */
+typedef enum {
+    SIMD_LEVEL_SCALAR,
+    SIMD_LEVEL_SSE2,
+    SIMD_LEVEL_AVX2,
+    SIMD_LEVEL_NEON
+} SimdLevel;
+
+/* ---- Scalar kernels (reference implementation and vector loop tails) ---- */
+
+#define DEFINE_SCALAR_KERNELS(T)                                                \
+    static inline size_t find_first_##T##_scalar(const T* data, size_t n,       \
+                                                 T value) {                     \
+        for (size_t i = 0; i < n; ++i) {                                        \
+            if (data[i] == value) {                                             \
+                return i;                                                       \
+            }                                                                   \
+        }                                                                       \
+        return n;                                                               \
+    }                                                                           \
+                                                                                \
+    static inline size_t count_if_equal_##T##_scalar(const T* data, size_t n,   \
+                                                     T value) {                 \
+        size_t count = 0;                                                       \
+        for (size_t i = 0; i < n; ++i) {                                        \
+            count += data[i] == value;                                          \
+        }                                                                       \
+        return count;                                                           \
+    }                                                                           \
+                                                                                \
+    static inline int filter_into_##T##_scalar(const T* data, size_t n,         \
+                                               T lo, T hi, DynArray* out) {     \
+        for (size_t i = 0; i < n; ++i) {                                        \
+            if (data[i] >= lo && data[i] <= hi && !push_dyn_array(out, &i)) {   \
+                return 0;                                                       \
+            }                                                                   \
+        }                                                                       \
+        return 1;                                                               \
+    }
+
+DEFINE_SCALAR_KERNELS(short)
+DEFINE_SCALAR_KERNELS(int)
+
+/* ---- Vector kernels ----
+ * Each ISA supplies, per element type, two mask functions that compare
+ * LANES elements starting at p and return a bitmask with BITS bits per lane
+ * (all set for a match); PATTERN keeps the lowest bit of every lane, leaving
+ * exactly one bit per matching element. The drivers below are shared. */
+
+#define DEFINE_VECTOR_KERNELS(ISA, T, LANES, BITS, PATTERN, ATTR, EQ_MASK, RANGE_MASK) \
+    ATTR static size_t find_first_##T##_##ISA(const T* data, size_t n, T value) {  \
+        size_t i = 0;                                                           \
+        for (; i + (LANES) <= n; i += (LANES)) {                                \
+            uint64_t mask = EQ_MASK(data + i, value) & (PATTERN);               \
+            if (mask != 0) {                                                    \
+                return i + (size_t)__builtin_ctzll(mask) / (BITS);              \
+            }                                                                   \
+        }                                                                       \
+        return i + find_first_##T##_scalar(data + i, n - i, value);             \
+    }                                                                           \
+                                                                                \
+    ATTR static size_t count_if_equal_##T##_##ISA(const T* data, size_t n,      \
+                                                  T value) {                    \
+        size_t i = 0;                                                           \
+        size_t count = 0;                                                       \
+        for (; i + (LANES) <= n; i += (LANES)) {                                \
+            count += (size_t)__builtin_popcountll(EQ_MASK(data + i, value) & (PATTERN)); \
+        }                                                                       \
+        return count + count_if_equal_##T##_scalar(data + i, n - i, value);     \
+    }                                                                           \
+                                                                                \
+    ATTR static int filter_into_##T##_##ISA(const T* data, size_t n, T lo, T hi, \
+                                            DynArray* out) {                    \
+        size_t i = 0;                                                           \
+        for (; i + (LANES) <= n; i += (LANES)) {                                \
+            uint64_t mask = RANGE_MASK(data + i, lo, hi) & (PATTERN);           \
+            if (mask == 0) {                                                    \
+                continue;                                                       \
+            }                                                                   \
+            /* Room for a full vector of hits, then store them directly */      \
+            if (!grow_for_dyn_array(out, (LANES))) {                            \
+                return 0;                                                       \
+            }                                                                   \
+            size_t* dest = (size_t*)out->items + out->count;                    \
+            while (mask != 0) {                                                 \
+                *dest++ = i + (size_t)__builtin_ctzll(mask) / (BITS);           \
+                mask &= mask - 1;                                               \
+            }                                                                   \
+            out->count = (size_t)(dest - (size_t*)out->items);                  \
+        }                                                                       \
+        size_t first = out->count;                                              \
+        if (!filter_into_##T##_scalar(data + i, n - i, lo, hi, out)) {          \
+            return 0;                                                           \
+        }                                                                       \
+        /* The scalar tail reports indices relative to data + i */              \
+        for (size_t j = first; j < out->count; ++j) {                           \
+            ((size_t*)out->items)[j] += i;                                      \
+        }                                                                       \
+        return 1;                                                               \
+    }
+
+#ifdef DS_SIMD_X86
+
+#define SSE2_ATTR __attribute__((target("sse2")))
+#define AVX2_ATTR __attribute__((target("avx2")))
+
+SSE2_ATTR static inline uint64_t eq_mask_short_sse2(const short* p, short value) {
+    __m128i v = _mm_loadu_si128((const __m128i*)p);
+    return (uint64_t)_mm_movemask_epi8(_mm_cmpeq_epi16(v, _mm_set1_epi16(value)));
+}
+
+SSE2_ATTR static inline uint64_t range_mask_short_sse2(const short* p, short lo, short hi) {
+    __m128i v = _mm_loadu_si128((const __m128i*)p);
+    /* Outside the range if v < lo or v > hi (signed compares) */
+    __m128i out = _mm_or_si128(_mm_cmplt_epi16(v, _mm_set1_epi16(lo)),
+                               _mm_cmpgt_epi16(v, _mm_set1_epi16(hi)));
+    return (uint64_t)(~_mm_movemask_epi8(out) & 0xffff);
+}
+
+SSE2_ATTR static inline uint64_t eq_mask_int_sse2(const int* p, int value) {
+    __m128i v = _mm_loadu_si128((const __m128i*)p);
+    return (uint64_t)_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(v, _mm_set1_epi32(value))));
+}
+
+SSE2_ATTR static inline uint64_t range_mask_int_sse2(const int* p, int lo, int hi) {
+    __m128i v = _mm_loadu_si128((const __m128i*)p);
+    __m128i out = _mm_or_si128(_mm_cmplt_epi32(v, _mm_set1_epi32(lo)),
+                               _mm_cmpgt_epi32(v, _mm_set1_epi32(hi)));
+    return (uint64_t)(~_mm_movemask_ps(_mm_castsi128_ps(out)) & 0xf);
+}
+
+AVX2_ATTR static inline uint64_t eq_mask_short_avx2(const short* p, short value) {
+    __m256i v = _mm256_loadu_si256((const __m256i*)p);
+    return (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi16(v, _mm256_set1_epi16(value)));
+}
+
+AVX2_ATTR static inline uint64_t range_mask_short_avx2(const short* p, short lo, short hi) {
+    __m256i v = _mm256_loadu_si256((const __m256i*)p);
+    __m256i out = _mm256_or_si256(_mm256_cmpgt_epi16(_mm256_set1_epi16(lo), v),
+                                  _mm256_cmpgt_epi16(v, _mm256_set1_epi16(hi)));
+    return (uint32_t)~_mm256_movemask_epi8(out);
+}
+
+AVX2_ATTR static inline uint64_t eq_mask_int_avx2(const int* p, int value) {
+    __m256i v = _mm256_loadu_si256((const __m256i*)p);
+    return (uint64_t)_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(v, _mm256_set1_epi32(value))));
+}
+
+AVX2_ATTR static inline uint64_t range_mask_int_avx2(const int* p, int lo, int hi) {
+    __m256i v = _mm256_loadu_si256((const __m256i*)p);
+    __m256i out = _mm256_or_si256(_mm256_cmpgt_epi32(_mm256_set1_epi32(lo), v),
+                                  _mm256_cmpgt_epi32(v, _mm256_set1_epi32(hi)));
+    return (uint64_t)(~_mm256_movemask_ps(_mm256_castsi256_ps(out)) & 0xff);
+}
+
+/* Byte movemask of 16-bit lanes gives 2 bits per lane */
+DEFINE_VECTOR_KERNELS(sse2, short, 8, 2, 0x5555u, SSE2_ATTR, eq_mask_short_sse2, range_mask_short_sse2)
+DEFINE_VECTOR_KERNELS(sse2, int, 4, 1, 0xfu, SSE2_ATTR, eq_mask_int_sse2, range_mask_int_sse2)
+DEFINE_VECTOR_KERNELS(avx2, short, 16, 2, 0x55555555u, AVX2_ATTR, eq_mask_short_avx2, range_mask_short_avx2)
+DEFINE_VECTOR_KERNELS(avx2, int, 8, 1, 0xffu, AVX2_ATTR, eq_mask_int_avx2, range_mask_int_avx2)
+
+#endif /* DS_SIMD_X86 */
+
+#ifdef DS_SIMD_NEON
+
+#define NEON_ATTR
+
+/* Narrowing the all-ones/all-zeros compare result gives 8 bits per 16-bit lane */
+static inline uint64_t eq_mask_short_neon(const short* p, short value) {
+    uint16x8_t eq = vceqq_s16(vld1q_s16(p), vdupq_n_s16(value));
+    return vget_lane_u64(vreinterpret_u64_u8(vmovn_u16(eq)), 0);
+}
+
+static inline uint64_t range_mask_short_neon(const short* p, short lo, short hi) {
+    int16x8_t v = vld1q_s16(p);
+    uint16x8_t in = vandq_u16(vcgeq_s16(v, vdupq_n_s16(lo)), vcleq_s16(v, vdupq_n_s16(hi)));
+    return vget_lane_u64(vreinterpret_u64_u8(vmovn_u16(in)), 0);
+}
+
+/* ... and 16 bits per 32-bit lane */
+static inline uint64_t eq_mask_int_neon(const int* p, int value) {
+    uint32x4_t eq = vceqq_s32(vld1q_s32(p), vdupq_n_s32(value));
+    return vget_lane_u64(vreinterpret_u64_u16(vmovn_u32(eq)), 0);
+}
+
+static inline uint64_t range_mask_int_neon(const int* p, int lo, int hi) {
+    int32x4_t v = vld1q_s32(p);
+    uint32x4_t in = vandq_u32(vcgeq_s32(v, vdupq_n_s32(lo)), vcleq_s32(v, vdupq_n_s32(hi)));
+    return vget_lane_u64(vreinterpret_u64_u16(vmovn_u32(in)), 0);
+}
+
+DEFINE_VECTOR_KERNELS(neon, short, 8, 8, 0x0101010101010101ull, NEON_ATTR, eq_mask_short_neon, range_mask_short_neon)
+DEFINE_VECTOR_KERNELS(neon, int, 4, 16, 0x0001000100010001ull, NEON_ATTR, eq_mask_int_neon, range_mask_int_neon)
+
+#endif /* DS_SIMD_NEON */
+
+/* ---- Runtime dispatch ---- */
+
+/**
+ * Kernel table for one implementation level.
+ */
+typedef struct {
+    SimdLevel level;
+    size_t (*find_first_short)(const short* data, size_t n, short value);
+    size_t (*count_if_equal_short)(const short* data, size_t n, short value);
+    int (*filter_into_short)(const short* data, size_t n, short lo, short hi, DynArray* out);
+    size_t (*find_first_int)(const int* data, size_t n, int value);
+    size_t (*count_if_equal_int)(const int* data, size_t n, int value);
+    int (*filter_into_int)(const int* data, size_t n, int lo, int hi, DynArray* out);
+} SimdKernels;
+
+#define SIMD_KERNELS(LEVEL, ISA)                                                \
+    {LEVEL, find_first_short_##ISA, count_if_equal_short_##ISA,                 \
+     filter_into_short_##ISA, find_first_int_##ISA, count_if_equal_int_##ISA,   \
+     filter_into_int_##ISA}
+
+/*
+ * Currently selected kernels, NULL until the first call picks the best
+ * available. Weak, so all translation units share one selection; every
+ * table is static and immutable, so any unit may run another unit's.
+ */
+__attribute__((weak)) const SimdKernels* _Atomic ds_simd_kernels;
+
+/**
+ * Returns the highest implementation level this CPU supports.
+ */
+static inline SimdLevel detect_simd_level(void) {
+#if defined(DS_SIMD_X86)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return SIMD_LEVEL_AVX2;
+    }
+    return SIMD_LEVEL_SSE2;
+#elif defined(DS_SIMD_NEON)
+    return SIMD_LEVEL_NEON;
+#else
+    return SIMD_LEVEL_SCALAR;
+#endif
+}
+
+/**
+ * Selects the kernels for a given level, e.g. to compare implementations.
+ * Levels the build or CPU does not support fall back to scalar.
+ *
+ * @param level Requested implementation level
+ * @return Level actually selected
+ */
+static inline SimdLevel set_simd_level(SimdLevel level) {
+    static const SimdKernels scalar = SIMD_KERNELS(SIMD_LEVEL_SCALAR, scalar);
+    const SimdKernels* kernels;
+#if defined(DS_SIMD_X86)
+    static const SimdKernels sse2 = SIMD_KERNELS(SIMD_LEVEL_SSE2, sse2);
+    static const SimdKernels avx2 = SIMD_KERNELS(SIMD_LEVEL_AVX2, avx2);
+    if (level == SIMD_LEVEL_AVX2 && detect_simd_level() == SIMD_LEVEL_AVX2) {
+        kernels = &avx2;
+    } else if (level == SIMD_LEVEL_SSE2 || level == SIMD_LEVEL_AVX2) {
+        kernels = &sse2;
+    } else {
+        kernels = &scalar;
+    }
+#elif defined(DS_SIMD_NEON)
+    static const SimdKernels neon = SIMD_KERNELS(SIMD_LEVEL_NEON, neon);
+    kernels = level == SIMD_LEVEL_NEON ? &neon : &scalar;
+#else
+    (void)level;
+    kernels = &scalar;
+#endif
+    /* Release: a thread that sees the pointer also sees the table it points to */
+    atomic_store_explicit(&ds_simd_kernels, kernels, memory_order_release);
+    return kernels->level;
+}
+
+/**
+ * Returns the active kernel table, detecting the CPU on first use.
+ */
+static inline const SimdKernels* get_simd_kernels(void) {
+    const SimdKernels* kernels = atomic_load_explicit(&ds_simd_kernels, memory_order_acquire);
+    if (kernels == NULL) {
+        /* Racing first calls all detect the same level and store equivalent tables */
+        set_simd_level(detect_simd_level());
+        kernels = atomic_load_explicit(&ds_simd_kernels, memory_order_acquire);
+    }
+    return kernels;
+}
+
+/* ---- Public API on raw columns ---- */
+
+/**
+ * Finds the first element equal to value.
+ *
+ * @return Index of the first match, or n if there is none
+ */
+static inline size_t find_first_short(const short* data, size_t n, short value) {
+    return get_simd_kernels()->find_first_short(data, n, value);
+}
+
+static inline size_t find_first_int(const int* data, size_t n, int value) {
+    return get_simd_kernels()->find_first_int(data, n, value);
+}
+
+/**
+ * Counts the elements equal to value.
+ */
+static inline size_t count_if_equal_short(const short* data, size_t n, short value) {
+    return get_simd_kernels()->count_if_equal_short(data, n, value);
+}
+
+static inline size_t count_if_equal_int(const int* data, size_t n, int value) {
+    return get_simd_kernels()->count_if_equal_int(data, n, value);
+}
+
+/**
+ * Appends the index of every element in [lo, hi] to out, in increasing order.
+ *
+ * @param out DynArray of size_t elements receiving the indices
+ * @return 1 on success, 0 if growing out failed
+ */
+static inline int filter_into_short(const short* data, size_t n, short lo, short hi, DynArray* out) {
+    return get_simd_kernels()->filter_into_short(data, n, lo, hi, out);
+}
+
+static inline int filter_into_int(const int* data, size_t n, int lo, int hi, DynArray* out) {
+    return get_simd_kernels()->filter_into_int(data, n, lo, hi, out);
+}
+
+/* ---- DynArray wrappers (element type picked from array->size) ---- */
+
+/**
+ * Finds the first element equal to value in a DynArray of short or int.
+ *
+ * @return Index of the first match, or array->count if there is none
+ *         (also for element sizes other than short/int, or a value out of range)
+ */
+static inline size_t find_first_dyn_array(const DynArray* array, int value) {
+    if (array->size == sizeof(short) && value >= SHRT_MIN && value <= SHRT_MAX) {
+        return find_first_short(array->items, array->count, (short)value);
+    }
+    if (array->size == sizeof(int)) {
+        return find_first_int(array->items, array->count, value);
+    }
+    return array->count;
+}
+
+/**
+ * Counts the elements equal to value in a DynArray of short or int.
+ *
+ * @return Number of matches (0 for unsupported element sizes)
+ */
+static inline size_t count_if_equal_dyn_array(const DynArray* array, int value) {
+    if (array->size == sizeof(short) && value >= SHRT_MIN && value <= SHRT_MAX) {
+        return count_if_equal_short(array->items, array->count, (short)value);
+    }
+    if (array->size == sizeof(int)) {
+        return count_if_equal_int(array->items, array->count, value);
+    }
+    return 0;
+}
+
+/**
+ * Appends the index of every element in [lo, hi] of a DynArray of short or int to out.
+ *
+ * @param out DynArray of size_t elements receiving the indices
+ * @return 1 on success, 0 for unsupported element sizes or if growing out failed
+ */
+static inline int filter_into_dyn_array(const DynArray* array, int lo, int hi, DynArray* out) {
+    if (out->size != sizeof(size_t)) {
+        return 0;
+    }
+    if (array->size == sizeof(short)) {
+        if (lo > SHRT_MAX || hi < SHRT_MIN || lo > hi) {
+            return 1;   /* Nothing can match */
+        }
+        short lo_s = (short)(lo < SHRT_MIN ? SHRT_MIN : lo);
+        short hi_s = (short)(hi > SHRT_MAX ? SHRT_MAX : hi);
+        return filter_into_short(array->items, array->count, lo_s, hi_s, out);
+    }
+    if (array->size == sizeof(int)) {
+        return filter_into_int(array->items, array->count, lo, hi, out);
+    }
+    return 0;
+}
+
+#endif /* DS_SIMD_SEARCH_H */
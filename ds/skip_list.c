@@ -0,0 +1,89 @@
+/*
+ * Skip List Example
+ *
+ * This file demonstrates keeping integers in order with a skip list whose
+ * nodes come from an IntNodePool. The implementation supports:
+ *
+ * - Ordered insert, lookup and removal in O(log n) expected time
+ * - Range queries through a NodeVisitFn callback
+ * - Walking the whole list with process_list, as for an IntList
+ * - Reusing removed nodes for later inserts
+ *
+ * Key concepts demonstrated:
+ * - Probabilistic balancing with randomized node heights
+ * - Struct embedding: every skip node starts with an IntNode
+ * - Variable-sized nodes carved from a fixed-size node pool
+ */
+
+#include <stdio.h>
+
+#include "skip_list.h"
+
+/**
+ * Simple node printing function.
+ * Can be passed as a NodeFn function pointer.
+ *
+ * @param node Pointer to the node to print
+ */
+void print_node(IntNode* node) {
+    printf(" %d", node->value);
+}
+
+/**
+ * Example range visitor: adds each value to the long long sum in ctx.
+ * Can be passed as a NodeVisitFn function pointer.
+ *
+ * @param node Pointer to the current node
+ * @param ctx Pointer to the running long long sum
+ * @return NODE_VISIT_CONTINUE to visit the whole range
+ */
+int sum_node(IntNode* node, void* ctx) {
+    *(long long*)ctx += node->value;
+    return NODE_VISIT_CONTINUE;
+}
+
+int main(void) {
+    IntNodePool pool;
+    init_int_node_pool(&pool, 0);
+    SkipList list;
+    if (!init_skip_list(&list, &pool, 42)) {
+        return 1;
+    }
+
+    /* Insert out of order; the level-0 chain stays sorted */
+    const int values[] = {42, 7, 19, 3, 88, 19, 56, 1, 64, 27};
+    for (size_t i = 0; i < sizeof(values) / sizeof(values[0]); ++i) {
+        insert_skip_list(&list, values[i]);
+    }
+    printf("Sorted (%zu values):", list.count);
+    process_list(first_skip_list(&list), print_node);
+    printf("\n");
+
+    printf("find 56: %s, find 55: %s\n",
+           find_skip_list(&list, 56) != NULL ? "found" : "absent",
+           find_skip_list(&list, 55) != NULL ? "found" : "absent");
+    IntNode* above = lower_bound_skip_list(&list, 20);
+    printf("First value >= 20: %d\n", above != NULL ? above->value : -1);
+
+    long long sum = 0;
+    range_skip_list(&list, 10, 60, sum_node, &sum);
+    printf("Sum of values in [10, 60]: %lld\n", sum);
+
+    /* Removed nodes go to per-height free lists for later inserts */
+    remove_skip_list(&list, 19);
+    remove_skip_list(&list, 88);
+    remove_skip_list(&list, 1);
+    printf("After removals (%zu values):", list.count);
+    process_list(first_skip_list(&list), print_node);
+    printf("\n");
+
+    /* A larger build, to show the number of levels in use */
+    for (int i = 0; i < 100000; ++i) {
+        insert_skip_list(&list, (int)((i * 7919u) % 100000u));
+    }
+    printf("After bulk insert: %zu values over %u levels\n", list.count, list.level);
+
+    free_skip_list(&list);
+    free_int_node_pool(&pool);
+    return 0;
+}
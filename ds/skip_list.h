@@ -0,0 +1,322 @@
+/*
+ * Skip List of Integers
+ *
+ * Ordered multiset of ints with O(log n) expected insert, lookup and removal,
+ * for data that IntList would otherwise keep sorted at O(n) per operation.
+ *
+ * Every SkipNode starts with an ordinary IntNode, and level 0 links those
+ * IntNodes in ascending order: first_skip_list returns a plain IntNode chain
+ * that process_list, visit_list and process_list_batched walk unchanged. The
+ * higher levels are express lanes over the same nodes, each level keeping a
+ * node with probability 1/4.
+ *
+ * Nodes are carved out of an IntNodePool as runs of adjacent IntNodes, so
+ * they share the pool's slabs (and locality) with the pool's lists. Removed
+ * nodes are kept on per-height free lists and reused by later inserts.
+ */
+
+#ifndef DS_SKIP_LIST_H
+#define DS_SKIP_LIST_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "linked_list.h"
+
+/* Highest node; with levels kept at probability 1/4 this covers 4^32 elements */
+#define SKIP_LIST_MAX_LEVEL 32
+
+/**
+ * Skip list node. Callbacks receive &node->base and may read its value, but
+ * must not change the value or the next pointer.
+ */
+typedef struct SkipNode {
+    IntNode base;                /* Value and level-0 link (next node in ascending order) */
+    unsigned height;             /* Number of levels the node is linked into */
+    struct SkipNode* forward[];  /* forward[i - 1] is the next node at level i, 1 <= i < height */
+} SkipNode;
+
+/**
+ * Skip list control structure.
+ */
+typedef struct {
+    SkipNode* head;      /* Sentinel of full height, holds no value */
+    unsigned level;      /* Number of levels in use, at least 1 */
+    size_t count;        /* Number of values stored */
+    uint64_t rng;        /* xorshift state for node heights */
+    IntNodePool* pool;   /* Where nodes are carved from */
+    SkipNode* free_nodes[SKIP_LIST_MAX_LEVEL];  /* Removed nodes by height - 1, chained through base.next */
+} SkipList;
+
+/**
+ * Returns the number of pool IntNodes a node of the given height occupies.
+ */
+static inline size_t units_skip_node(unsigned height) {
+    size_t bytes = offsetof(SkipNode, forward) + (height - 1) * sizeof(SkipNode*);
+    return (bytes + sizeof(IntNode) - 1) / sizeof(IntNode);
+}
+
+/**
+ * Returns the node after node at the given level, or NULL at the end.
+ */
+static inline SkipNode* next_skip_node(const SkipNode* node, unsigned level) {
+    return level == 0 ? (SkipNode*)node->base.next : node->forward[level - 1];
+}
+
+/**
+ * Sets the node after node at the given level.
+ */
+static inline void link_skip_node(SkipNode* node, unsigned level, SkipNode* next) {
+    if (level == 0) {
+        node->base.next = (IntNode*)next;
+    } else {
+        node->forward[level - 1] = next;
+    }
+}
+
+/**
+ * Takes a node of the given height from the free lists or the pool.
+ *
+ * @return Node with height set and everything else uninitialized, or NULL if
+ *         the pool could not allocate
+ */
+static inline SkipNode* alloc_skip_node(SkipList* list, unsigned height) {
+    SkipNode* node = list->free_nodes[height - 1];
+    if (node != NULL) {
+        list->free_nodes[height - 1] = (SkipNode*)node->base.next;
+    } else {
+        node = (SkipNode*)alloc_pooled_nodes(list->pool, units_skip_node(height));
+        if (node == NULL) {
+            return NULL;
+        }
+    }
+    node->height = height;
+    return node;
+}
+
+/**
+ * Draws the height of a new node: 1 plus one level for every pair of zero bits.
+ */
+static inline unsigned random_height_skip_list(SkipList* list) {
+    uint64_t x = list->rng;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    list->rng = x;
+    uint64_t bits = x * 0x2545F4914F6CDD1Dull;
+
+    unsigned height = 1;
+    while ((bits & 3) == 0 && height < SKIP_LIST_MAX_LEVEL) {
+        height++;
+        bits >>= 2;
+    }
+    return height;
+}
+
+/**
+ * Initializes an empty skip list and allocates its sentinel from the pool.
+ *
+ * @param list Pointer to caller-allocated list
+ * @param pool Pool to carve nodes from; must outlive the list
+ * @param seed Seed for node heights (any value; equal seeds give equal shapes)
+ * @return 1 on success, 0 if the sentinel could not be allocated
+ */
+static inline int init_skip_list(SkipList* list, IntNodePool* pool, uint64_t seed) {
+    list->pool = pool;
+    list->level = 1;
+    list->count = 0;
+    list->rng = seed != 0 ? seed : 0x9E3779B97F4A7C15ull;   /* xorshift must not start at 0 */
+    for (unsigned i = 0; i < SKIP_LIST_MAX_LEVEL; ++i) {
+        list->free_nodes[i] = NULL;
+    }
+
+    list->head = (SkipNode*)alloc_pooled_nodes(pool, units_skip_node(SKIP_LIST_MAX_LEVEL));
+    if (list->head == NULL) {
+        return 0;
+    }
+    list->head->height = SKIP_LIST_MAX_LEVEL;
+    for (unsigned level = 0; level < SKIP_LIST_MAX_LEVEL; ++level) {
+        link_skip_node(list->head, level, NULL);
+    }
+    return 1;
+}
+
+/**
+ * Finds, at every level in use, the last node ordered before value.
+ *
+ * @param list Pointer to the list
+ * @param value Value to search for
+ * @param after_equal Nonzero to place equal values before the position (insert
+ *                    after them), 0 to place them after it
+ * @param update Filled with the predecessor at each level below list->level
+ */
+static inline void find_path_skip_list(const SkipList* list, int value, int after_equal,
+                                       SkipNode* update[SKIP_LIST_MAX_LEVEL]) {
+    SkipNode* node = list->head;
+    for (unsigned level = list->level; level-- > 0;) {
+        SkipNode* next;
+        while ((next = next_skip_node(node, level)) != NULL &&
+               (next->base.value < value || (after_equal && next->base.value == value))) {
+            node = next;
+        }
+        update[level] = node;
+    }
+}
+
+/**
+ * Inserts a value in order. Equal values are kept, the new one after the others.
+ *
+ * @param list Pointer to the list
+ * @param value Value to insert
+ * @return 1 on success, 0 if the pool could not allocate a node
+ */
+static inline int insert_skip_list(SkipList* list, int value) {
+    SkipNode* update[SKIP_LIST_MAX_LEVEL];
+    find_path_skip_list(list, value, 1, update);
+
+    unsigned height = random_height_skip_list(list);
+    SkipNode* node = alloc_skip_node(list, height);
+    if (node == NULL) {
+        return 0;
+    }
+    node->base.value = value;
+
+    while (list->level < height) {
+        update[list->level++] = list->head;
+    }
+    for (unsigned level = 0; level < height; ++level) {
+        link_skip_node(node, level, next_skip_node(update[level], level));
+        link_skip_node(update[level], level, node);
+    }
+    list->count++;
+    return 1;
+}
+
+/**
+ * Returns the first node whose value is >= value.
+ *
+ * @param list Pointer to the list
+ * @param value Value to search for
+ * @return Node in the level-0 chain, or NULL if every value is smaller
+ */
+static inline IntNode* lower_bound_skip_list(const SkipList* list, int value) {
+    SkipNode* node = list->head;
+    for (unsigned level = list->level; level-- > 0;) {
+        SkipNode* next;
+        while ((next = next_skip_node(node, level)) != NULL && next->base.value < value) {
+            node = next;
+        }
+    }
+    return node->base.next;
+}
+
+/**
+ * Looks up a value.
+ *
+ * @param list Pointer to the list
+ * @param value Value to look up
+ * @return First node holding value, or NULL if it is absent
+ */
+static inline IntNode* find_skip_list(const SkipList* list, int value) {
+    IntNode* node = lower_bound_skip_list(list, value);
+    return node != NULL && node->value == value ? node : NULL;
+}
+
+/**
+ * Removes one occurrence of a value; its node goes to the list's free lists.
+ *
+ * @param list Pointer to the list
+ * @param value Value to remove
+ * @return 1 if a node was removed, 0 if the value is absent
+ */
+static inline int remove_skip_list(SkipList* list, int value) {
+    SkipNode* update[SKIP_LIST_MAX_LEVEL];
+    find_path_skip_list(list, value, 0, update);
+
+    SkipNode* node = next_skip_node(update[0], 0);
+    if (node == NULL || node->base.value != value) {
+        return 0;
+    }
+    /* The first equal node is also the first node >= value on each of its levels */
+    for (unsigned level = 0; level < node->height; ++level) {
+        link_skip_node(update[level], level, next_skip_node(node, level));
+    }
+    node->base.next = (IntNode*)list->free_nodes[node->height - 1];
+    list->free_nodes[node->height - 1] = node;
+
+    while (list->level > 1 && next_skip_node(list->head, list->level - 1) == NULL) {
+        list->level--;
+    }
+    list->count--;
+    return 1;
+}
+
+/**
+ * Returns the first node of the level-0 chain, for process_list, visit_list
+ * and process_list_batched.
+ *
+ * @param list Pointer to the list
+ * @return Node with the smallest value, or NULL if the list is empty
+ */
+static inline IntNode* first_skip_list(const SkipList* list) {
+    return list->head->base.next;
+}
+
+/**
+ * Visits, in ascending order, every node whose value is in [lo, hi].
+ *
+ * @param list Pointer to the list
+ * @param lo Smallest value to visit
+ * @param hi Largest value to visit
+ * @param vfn Callback invoked per node; return NODE_VISIT_STOP to end early
+ * @param ctx Opaque caller state passed through to every call
+ * @return The node the visit stopped at, or NULL if the range was exhausted
+ */
+static inline IntNode* range_skip_list(const SkipList* list, int lo, int hi, NodeVisitFn vfn, void* ctx) {
+    for (IntNode* node = lower_bound_skip_list(list, lo); node != NULL && node->value <= hi; node = node->next) {
+        if (vfn(node, ctx) == NODE_VISIT_STOP) {
+            return node;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Gives a node's IntNodes back to the pool's free list.
+ */
+static inline void release_skip_node(IntNodePool* pool, SkipNode* node) {
+    IntNode* units = (IntNode*)node;
+    size_t n = units_skip_node(node->height);
+    for (size_t i = 0; i < n; ++i) {
+        release_pooled_node(pool, &units[i]);
+    }
+}
+
+/**
+ * Gives every node, including the sentinel and removed nodes, back to the pool.
+ * The list must be initialized again before reuse.
+ *
+ * @param list Pointer to the list
+ */
+static inline void free_skip_list(SkipList* list) {
+    SkipNode* node = list->head;
+    while (node != NULL) {
+        SkipNode* next = next_skip_node(node, 0);
+        release_skip_node(list->pool, node);
+        node = next;
+    }
+    for (unsigned i = 0; i < SKIP_LIST_MAX_LEVEL; ++i) {
+        node = list->free_nodes[i];
+        while (node != NULL) {
+            SkipNode* next = (SkipNode*)node->base.next;
+            release_skip_node(list->pool, node);
+            node = next;
+        }
+        list->free_nodes[i] = NULL;
+    }
+    list->head = NULL;
+    list->level = 1;
+    list->count = 0;
+}
+
+#endif /* DS_SKIP_LIST_H */
@@ -0,0 +1,86 @@
+/*
+ * Sorting and Binary Search Example
+ *
+ * This file demonstrates sorting a table of User records and serving
+ * lookups and range queries from it. The implementation supports:
+ *
+ * - Radix sorting by an integer field, without any comparisons
+ * - Comparator-based sorting of the generic DynArray (introsort)
+ * - Sorting the typed UserArray with an inlined comparison
+ * - Binary search by comparator or directly by integer key
+ *
+ * Key concepts demonstrated:
+ * - Radix sort with skipped passes on constant key bytes
+ * - Introsort: quicksort with heapsort fallback and insertion sort for short ranges
+ * - Sorting an index permutation instead of swapping large elements
+ * - Macro-generated, type-specialized algorithms
+ * - Range queries as two lower-bound searches
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "sort.h"
+#include "user.h"
+
+/**
+ * Orders users by name, for the generic comparator-based sort.
+ */
+static int compare_user_names(const void* a, const void* b) {
+    return strcmp(((const User*)a)->name, ((const User*)b)->name);
+}
+
+/**
+ * Orders users by id, for the typed sort.
+ */
+static inline int user_id_less(const User* a, const User* b) {
+    return a->id < b->id;
+}
+
+DEFINE_DYN_ARRAY_SORT(User, user_id_less)
+
+int main(void) {
+    /* A shuffled table of users */
+    DynArray users;
+    new_dyn_array(sizeof(User), &users);
+    for (int i = 0; i < 1000; ++i) {
+        User user;
+        user.id = (short)((i * 7919) % 1000 - 500);
+        snprintf(user.name, sizeof(user.name), "user-%d", user.id);
+        push_dyn_array(&users, &user);
+    }
+
+    /* Radix sort by id: two byte passes, no comparator calls */
+    RADIX_SORT_DYN_ARRAY_BY(&users, User, id);
+    User* sorted = users.items;
+    printf("By id: first %d, last %d\n", sorted[0].id, sorted[users.count - 1].id);
+
+    /* Range query: ids in [-10, 10) */
+    size_t lo = LOWER_BOUND_DYN_ARRAY_BY(&users, User, id, -10);
+    size_t hi = LOWER_BOUND_DYN_ARRAY_BY(&users, User, id, 10);
+    printf("Ids in [-10, 10): %zu users, starting with %s\n", hi - lo, sorted[lo].name);
+
+    /* Comparator-based sort by name, then a lookup with the same comparator */
+    sort_dyn_array(&users, compare_user_names);
+    printf("By name: first %s, last %s\n", sorted[0].name, sorted[users.count - 1].name);
+    User key;
+    strcpy(key.name, "user-42");
+    User* found = bsearch_dyn_array(&users, &key, compare_user_names);
+    printf("Lookup %s: %s\n", key.name, found != NULL ? "found" : "missing");
+
+    /* The typed variant inlines user_id_less into its sort and search */
+    UserArray typed;
+    UserArray_init(&typed);
+    for (size_t i = 0; i < users.count; ++i) {
+        UserArray_push(&typed, sorted[i]);
+    }
+    UserArray_sort(&typed);
+    key.id = 123;
+    size_t idx = UserArray_lower_bound(&typed, &key);
+    printf("Typed sort: first %d, lower bound of %d is %s\n",
+           typed.items[0].id, key.id, typed.items[idx].name);
+
+    UserArray_free(&typed);
+    free_dyn_array(&users);
+    return 0;
+}
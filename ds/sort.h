@@ -0,0 +1,628 @@
+/*
+ * Sorting and Binary Search for DynArray
+ *
+ * Three ways to sort, from most to least specialized:
+ *
+ * - radix_sort_dyn_array: LSD radix sort on an integer key stored at a fixed
+ *   offset in each element (e.g. User.id). No comparisons at all, stable,
+ *   and passes over key bytes that are the same in every element are skipped.
+ * - DEFINE_DYN_ARRAY_SORT(T, LESS): introsort for a DEFINE_DYN_ARRAY array
+ *   with the element type and comparison known at compile time, so the
+ *   compiler inlines LESS and moves elements as plain T assignments.
+ * - sort_dyn_array: introsort with a qsort-style comparator. Elements larger
+ *   than SORT_INDIRECT_MIN_SIZE are not swapped during the sort: an index
+ *   permutation is sorted instead, then every element is moved exactly once.
+ *
+ * Temporary buffers come from the C library, not from the array's allocator,
+ * so arrays on custom allocators (such as file mappings) can be sorted too.
+ * The binary searches assume the array is sorted by the same order.
+ */
+
+#ifndef DS_SORT_H
+#define DS_SORT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "allocator.h"
+#include "dyn_array.h"
+
+/* Ranges up to this many elements are finished with insertion sort */
+#define SORT_INSERTION_MAX 16
+/* Elements above this size are sorted through an index permutation */
+#define SORT_INDIRECT_MIN_SIZE 64
+/* Elements up to this size use stack scratch space for the generic sort */
+#define SORT_STACK_ELEM_MAX 256
+
+/**
+ * qsort-style comparator: negative, zero or positive as a < b, a == b, a > b.
+ */
+typedef int (*SortCmpFn)(const void* a, const void* b);
+
+/**
+ * Returns the introsort depth limit for n elements: 2 * floor(log2(n)).
+ */
+static inline unsigned sort_depth_limit(size_t n) {
+    unsigned depth = 0;
+    while (n > 1) {
+        n >>= 1;
+        depth += 2;
+    }
+    return depth;
+}
+
+/**
+ * Defines name(T* a, size_t n, CtxT ctx), an introsort (quicksort with
+ * median-of-three pivots, heapsort past the depth limit, insertion sort for
+ * short ranges) over T values ordered by LESS(const T* a, const T* b, ctx).
+ * Used for the typed variant and for the index permutation of sort_dyn_array.
+ */
+#define DEFINE_INTROSORT(name, T, CtxT, LESS)                                   \
+    static inline void name##_insertion(T* a, size_t n, CtxT ctx) {             \
+        (void)ctx;                                                              \
+        for (size_t i = 1; i < n; ++i) {                                        \
+            T value = a[i];                                                     \
+            size_t j = i;                                                       \
+            for (; j > 0 && LESS(&value, &a[j - 1], ctx); --j) {                \
+                a[j] = a[j - 1];                                                \
+            }                                                                   \
+            a[j] = value;                                                       \
+        }                                                                       \
+    }                                                                           \
+                                                                                \
+    static inline void name##_sift(T* a, size_t root, size_t n, CtxT ctx) {     \
+        (void)ctx;                                                              \
+        T value = a[root];                                                      \
+        for (size_t child; (child = 2 * root + 1) < n; root = child) {          \
+            if (child + 1 < n && LESS(&a[child], &a[child + 1], ctx)) {         \
+                child++;                                                        \
+            }                                                                   \
+            if (!LESS(&value, &a[child], ctx)) {                                \
+                break;                                                          \
+            }                                                                   \
+            a[root] = a[child];                                                 \
+        }                                                                       \
+        a[root] = value;                                                        \
+    }                                                                           \
+                                                                                \
+    static inline void name##_heapsort(T* a, size_t n, CtxT ctx) {              \
+        for (size_t i = n / 2; i-- > 0;) {                                      \
+            name##_sift(a, i, n, ctx);                                          \
+        }                                                                       \
+        for (size_t i = n; i-- > 1;) {                                          \
+            T top = a[0];                                                       \
+            a[0] = a[i];                                                        \
+            a[i] = top;                                                         \
+            name##_sift(a, 0, i, ctx);                                          \
+        }                                                                       \
+    }                                                                           \
+                                                                                \
+    static inline void name##_loop(T* a, size_t n, unsigned depth, CtxT ctx) {  \
+        while (n > SORT_INSERTION_MAX) {                                        \
+            if (depth-- == 0) {                                                 \
+                name##_heapsort(a, n, ctx);                                     \
+                return;                                                         \
+            }                                                                   \
+            /* Order first, middle and last so the median sits in the middle */ \
+            size_t mid = n / 2;                                                 \
+            T tmp;                                                              \
+            if (LESS(&a[mid], &a[0], ctx)) {                                    \
+                tmp = a[mid]; a[mid] = a[0]; a[0] = tmp;                        \
+            }                                                                   \
+            if (LESS(&a[n - 1], &a[mid], ctx)) {                                \
+                tmp = a[mid]; a[mid] = a[n - 1]; a[n - 1] = tmp;                \
+                if (LESS(&a[mid], &a[0], ctx)) {                                \
+                    tmp = a[mid]; a[mid] = a[0]; a[0] = tmp;                    \
+                }                                                               \
+            }                                                                   \
+            /* Hoare partition around a copy of the median */                   \
+            T pivot = a[mid];                                                   \
+            size_t i = 0;                                                       \
+            size_t j = n - 1;                                                   \
+            for (;;) {                                                          \
+                while (LESS(&a[i], &pivot, ctx)) {                              \
+                    i++;                                                        \
+                }                                                               \
+                while (LESS(&pivot, &a[j], ctx)) {                              \
+                    j--;                                                        \
+                }                                                               \
+                if (i >= j) {                                                   \
+                    break;                                                      \
+                }                                                               \
+                tmp = a[i]; a[i] = a[j]; a[j] = tmp;                            \
+                i++;                                                            \
+                j--;                                                            \
+            }                                                                   \
+            /* [0, j] <= pivot <= [j + 1, n): recurse into the smaller side */  \
+            size_t left = j + 1;                                                \
+            if (left < n - left) {                                              \
+                name##_loop(a, left, depth, ctx);                               \
+                a += left;                                                      \
+                n -= left;                                                      \
+            } else {                                                            \
+                name##_loop(a + left, n - left, depth, ctx);                    \
+                n = left;                                                       \
+            }                                                                   \
+        }                                                                       \
+        name##_insertion(a, n, ctx);                                            \
+    }                                                                           \
+                                                                                \
+    static inline void name(T* a, size_t n, CtxT ctx) {                         \
+        name##_loop(a, n, sort_depth_limit(n), ctx);                            \
+    }
+
+/**
+ * Comparison state for sorting an index permutation of a DynArray.
+ */
+typedef struct {
+    const char* items;
+    size_t size;
+    SortCmpFn cmp;
+} SortIndexCtx;
+
+/* Ties broken by index keep the sort deterministic for equal elements */
+#define SORT_INDEX_LESS(a, b, ctx)                                              \
+    (sort_index_cmp((ctx), *(a), *(b)) < 0)
+
+static inline int sort_index_cmp(const SortIndexCtx* ctx, size_t a, size_t b) {
+    int c = ctx->cmp(ctx->items + a * ctx->size, ctx->items + b * ctx->size);
+    return c != 0 ? c : (a > b) - (a < b);
+}
+
+DEFINE_INTROSORT(introsort_indices, size_t, const SortIndexCtx*, SORT_INDEX_LESS)
+
+/**
+ * Reorders elements so that position k receives the element at perm[k].
+ * Follows each cycle of the permutation, so every element is copied once.
+ * perm is consumed (every entry ends up as its own index).
+ *
+ * @param items Element storage
+ * @param n Number of elements
+ * @param size Size of each element in bytes
+ * @param perm Permutation of [0, n)
+ * @param tmp Scratch space for one element
+ */
+static inline void apply_permutation(char* items, size_t n, size_t size, size_t* perm, void* tmp) {
+    for (size_t start = 0; start < n; ++start) {
+        if (perm[start] == start) {
+            continue;
+        }
+        memcpy(tmp, items + start * size, size);
+        size_t j = start;
+        for (;;) {
+            size_t src = perm[j];
+            perm[j] = j;
+            if (src == start) {
+                memcpy(items + j * size, tmp, size);
+                break;
+            }
+            memcpy(items + j * size, items + src * size, size);
+            j = src;
+        }
+    }
+}
+
+/**
+ * Swaps two elements of size bytes through tmp.
+ */
+static inline void swap_elems(char* a, char* b, size_t size, void* tmp) {
+    memcpy(tmp, a, size);
+    memcpy(a, b, size);
+    memcpy(b, tmp, size);
+}
+
+/**
+ * Moves the element at root down a max-heap of n elements until both children are smaller.
+ */
+static inline void sift_bytes(char* a, size_t root, size_t n, size_t size, SortCmpFn cmp, void* tmp) {
+    for (size_t child; (child = 2 * root + 1) < n; root = child) {
+        if (child + 1 < n && cmp(a + child * size, a + (child + 1) * size) < 0) {
+            child++;
+        }
+        if (cmp(a + root * size, a + child * size) >= 0) {
+            break;
+        }
+        swap_elems(a + root * size, a + child * size, size, tmp);
+    }
+}
+
+/**
+ * Introsort over raw elements of a runtime size; the byte-level counterpart
+ * of DEFINE_INTROSORT for small elements.
+ *
+ * @param a First element
+ * @param n Number of elements
+ * @param size Size of each element in bytes
+ * @param cmp Comparator
+ * @param depth Remaining quicksort depth before switching to heapsort
+ * @param scratch Scratch space for two elements
+ */
+static inline void introsort_bytes(char* a, size_t n, size_t size, SortCmpFn cmp, unsigned depth, char* scratch) {
+    char* tmp = scratch;
+    char* pivot = scratch + size;
+
+    while (n > SORT_INSERTION_MAX) {
+        if (depth-- == 0) {
+            /* Heapsort: build a max-heap, then move the top to the end */
+            for (size_t i = n / 2; i-- > 0;) {
+                sift_bytes(a, i, n, size, cmp, tmp);
+            }
+            for (size_t end = n; end-- > 1;) {
+                swap_elems(a, a + end * size, size, tmp);
+                sift_bytes(a, 0, end, size, cmp, tmp);
+            }
+            return;
+        }
+
+        /* Order first, middle and last so the median sits in the middle */
+        char* first = a;
+        char* mid = a + (n / 2) * size;
+        char* last = a + (n - 1) * size;
+        if (cmp(mid, first) < 0) {
+            swap_elems(mid, first, size, tmp);
+        }
+        if (cmp(last, mid) < 0) {
+            swap_elems(last, mid, size, tmp);
+            if (cmp(mid, first) < 0) {
+                swap_elems(mid, first, size, tmp);
+            }
+        }
+
+        /* Hoare partition around a copy of the median */
+        memcpy(pivot, mid, size);
+        size_t i = 0;
+        size_t j = n - 1;
+        for (;;) {
+            while (cmp(a + i * size, pivot) < 0) {
+                i++;
+            }
+            while (cmp(pivot, a + j * size) < 0) {
+                j--;
+            }
+            if (i >= j) {
+                break;
+            }
+            swap_elems(a + i * size, a + j * size, size, tmp);
+            i++;
+            j--;
+        }
+
+        /* Recurse into the smaller side, loop on the larger */
+        size_t left = j + 1;
+        if (left < n - left) {
+            introsort_bytes(a, left, size, cmp, depth, scratch);
+            a += left * size;
+            n -= left;
+        } else {
+            introsort_bytes(a + left * size, n - left, size, cmp, depth, scratch);
+            n = left;
+        }
+    }
+
+    /* Insertion sort, shifting the sorted prefix with one memmove per element */
+    for (size_t i = 1; i < n; ++i) {
+        size_t j = i;
+        while (j > 0 && cmp(a + i * size, a + (j - 1) * size) < 0) {
+            j--;
+        }
+        if (j != i) {
+            memcpy(tmp, a + i * size, size);
+            memmove(a + (j + 1) * size, a + j * size, (i - j) * size);
+            memcpy(a + j * size, tmp, size);
+        }
+    }
+}
+
+/**
+ * Sorts the array with a qsort-style comparator (introsort, not stable).
+ * Elements larger than SORT_INDIRECT_MIN_SIZE are sorted through an index
+ * permutation, so each element is moved only once at the end.
+ *
+ * @param array Pointer to the dynamic array
+ * @param cmp Comparator over two elements
+ * @return 1 on success, 0 if scratch space could not be allocated
+ *         (the array is then unchanged)
+ */
+static inline int sort_dyn_array(DynArray* array, SortCmpFn cmp) {
+    size_t n = array->count;
+    size_t size = array->size;
+    if (n < 2) {
+        return 1;
+    }
+
+    if (size > SORT_INDIRECT_MIN_SIZE) {
+        size_t* perm = allocate(NULL, n * sizeof(size_t), 0);
+        void* tmp = allocate(NULL, size, 0);
+        if (perm == NULL || tmp == NULL) {
+            deallocate(NULL, perm, n * sizeof(size_t));
+            deallocate(NULL, tmp, size);
+            return 0;
+        }
+        for (size_t i = 0; i < n; ++i) {
+            perm[i] = i;
+        }
+        SortIndexCtx ctx = {array->items, size, cmp};
+        introsort_indices(perm, n, &ctx);
+        apply_permutation(array->items, n, size, perm, tmp);
+        deallocate(NULL, perm, n * sizeof(size_t));
+        deallocate(NULL, tmp, size);
+        return 1;
+    }
+
+    /* Small elements are cheaper to swap than to permute afterwards */
+    char scratch[2 * SORT_STACK_ELEM_MAX];
+    introsort_bytes(array->items, n, size, cmp, sort_depth_limit(n), scratch);
+    return 1;
+}
+
+/**
+ * Reads an integer key of key_size bytes (1, 2, 4 or 8) and maps it to an
+ * unsigned value with the same order; signed keys get their sign bit flipped.
+ */
+static inline uint64_t load_sort_key(const char* elem, size_t key_size, int key_signed) {
+    uint64_t key;
+    switch (key_size) {
+    case 1: { uint8_t k; memcpy(&k, elem, 1); key = k; break; }
+    case 2: { uint16_t k; memcpy(&k, elem, 2); key = k; break; }
+    case 4: { uint32_t k; memcpy(&k, elem, 4); key = k; break; }
+    default: { uint64_t k; memcpy(&k, elem, 8); key = k; break; }
+    }
+    if (key_signed) {
+        key ^= (uint64_t)1 << (key_size * 8 - 1);
+    }
+    return key;
+}
+
+/**
+ * LSD radix sort of n raw elements on an unsigned key, one byte per pass,
+ * using a single histogram pass for all key bytes.
+ *
+ * @param items Elements to sort (sorted in place)
+ * @param scratch Buffer of n * size bytes
+ * @return Always 1
+ */
+static inline int radix_sort_bytes(char* items, char* scratch, size_t n, size_t size,
+                                   size_t key_offset, size_t key_size, int key_signed) {
+    size_t counts[8][256];
+    memset(counts, 0, sizeof(counts[0]) * key_size);
+    for (size_t i = 0; i < n; ++i) {
+        uint64_t key = load_sort_key(items + i * size + key_offset, key_size, key_signed);
+        for (size_t b = 0; b < key_size; ++b) {
+            counts[b][(key >> (b * 8)) & 0xff]++;
+        }
+    }
+
+    char* src = items;
+    char* dst = scratch;
+    for (size_t b = 0; b < key_size; ++b) {
+        /* A byte that is the same in every key does not reorder anything */
+        uint64_t first = load_sort_key(src + key_offset, key_size, key_signed);
+        if (counts[b][(first >> (b * 8)) & 0xff] == n) {
+            continue;
+        }
+
+        size_t offsets[256];
+        size_t sum = 0;
+        for (size_t v = 0; v < 256; ++v) {
+            offsets[v] = sum;
+            sum += counts[b][v];
+        }
+        for (size_t i = 0; i < n; ++i) {
+            const char* elem = src + i * size;
+            uint64_t key = load_sort_key(elem + key_offset, key_size, key_signed);
+            memcpy(dst + offsets[(key >> (b * 8)) & 0xff]++ * size, elem, size);
+        }
+        char* swap = src;
+        src = dst;
+        dst = swap;
+    }
+
+    if (src != items) {
+        memcpy(items, src, n * size);
+    }
+    return 1;
+}
+
+/**
+ * Key and original position of one element, for radix sorting large elements indirectly.
+ */
+typedef struct {
+    uint64_t key;
+    size_t idx;
+} SortKeyIndex;
+
+/**
+ * Sorts the array by an integer key stored in every element, without comparisons.
+ * The sort is stable. Elements larger than SORT_INDIRECT_MIN_SIZE are sorted
+ * as (key, index) pairs and then moved into place once.
+ * See RADIX_SORT_DYN_ARRAY_BY for deriving the key parameters from a struct field.
+ *
+ * @param array Pointer to the dynamic array
+ * @param key_offset Byte offset of the key within each element
+ * @param key_size Size of the key in bytes: 1, 2, 4 or 8
+ * @param key_signed Nonzero if the key is a signed integer
+ * @return 1 on success, 0 if the key does not fit in the element, key_size is
+ *         unsupported, or scratch space could not be allocated (the array is
+ *         then unchanged)
+ */
+static inline int radix_sort_dyn_array(DynArray* array, size_t key_offset, size_t key_size, int key_signed) {
+    size_t n = array->count;
+    size_t size = array->size;
+    if ((key_size != 1 && key_size != 2 && key_size != 4 && key_size != 8) ||
+        key_offset > size || key_size > size - key_offset) {
+        return 0;
+    }
+    if (n < 2) {
+        return 1;
+    }
+
+    if (size <= SORT_INDIRECT_MIN_SIZE) {
+        char* scratch = allocate(NULL, n * size, 0);
+        if (scratch == NULL) {
+            return 0;
+        }
+        radix_sort_bytes(array->items, scratch, n, size, key_offset, key_size, key_signed);
+        deallocate(NULL, scratch, n * size);
+        return 1;
+    }
+
+    /* Move 16-byte pairs during the passes, the elements only once at the end */
+    size_t pair_bytes = n * sizeof(SortKeyIndex);
+    SortKeyIndex* pairs = allocate(NULL, 2 * pair_bytes, 0);
+    void* tmp = allocate(NULL, size, 0);
+    if (pairs == NULL || tmp == NULL) {
+        deallocate(NULL, pairs, 2 * pair_bytes);
+        deallocate(NULL, tmp, size);
+        return 0;
+    }
+    const char* items = array->items;
+    for (size_t i = 0; i < n; ++i) {
+        pairs[i].key = load_sort_key(items + i * size + key_offset, key_size, key_signed);
+        pairs[i].idx = i;
+    }
+    /* The keys are already unsigned-ordered; only their low key_size bytes vary */
+    radix_sort_bytes((char*)pairs, (char*)(pairs + n), n, sizeof(SortKeyIndex),
+                     offsetof(SortKeyIndex, key), key_size, 0);
+
+    size_t* perm = (size_t*)(pairs + n);
+    for (size_t i = 0; i < n; ++i) {
+        perm[i] = pairs[i].idx;
+    }
+    apply_permutation(array->items, n, size, perm, tmp);
+    deallocate(NULL, pairs, 2 * pair_bytes);
+    deallocate(NULL, tmp, size);
+    return 1;
+}
+
+/* Nonzero if the integer field T.field has a signed type */
+#define SORT_FIELD_IS_SIGNED(T, field) ((__typeof__(((T*)0)->field))-1 < 0)
+
+/**
+ * Radix sorts a DynArray of T by the integer field T.field, e.g.
+ * RADIX_SORT_DYN_ARRAY_BY(&users, User, id).
+ */
+#define RADIX_SORT_DYN_ARRAY_BY(array, T, field)                                \
+    radix_sort_dyn_array((array), offsetof(T, field), sizeof(((T*)0)->field),   \
+                         SORT_FIELD_IS_SIGNED(T, field))
+
+/**
+ * Returns the index of the first element not less than key (count if none).
+ *
+ * @param array Pointer to an array sorted by cmp
+ * @param key Pointer to a value laid out like an element (only the fields cmp reads matter)
+ * @param cmp Comparator used to sort the array
+ * @return Index in [0, count]
+ */
+static inline size_t lower_bound_dyn_array(const DynArray* array, const void* key, SortCmpFn cmp) {
+    const char* items = array->items;
+    size_t first = 0;
+    size_t n = array->count;
+    while (n > 0) {
+        size_t half = n / 2;
+        if (cmp(items + (first + half) * array->size, key) < 0) {
+            first += half + 1;
+            n -= half + 1;
+        } else {
+            n = half;
+        }
+    }
+    return first;
+}
+
+/**
+ * Finds an element equal to key, like bsearch(3).
+ *
+ * @param array Pointer to an array sorted by cmp
+ * @param key Pointer to a value laid out like an element
+ * @param cmp Comparator used to sort the array
+ * @return Pointer to the first matching element, or NULL if there is none
+ */
+static inline void* bsearch_dyn_array(const DynArray* array, const void* key, SortCmpFn cmp) {
+    size_t idx = lower_bound_dyn_array(array, key, cmp);
+    if (idx == array->count) {
+        return NULL;
+    }
+    char* elem = (char*)array->items + idx * array->size;
+    return cmp(elem, key) == 0 ? elem : NULL;
+}
+
+/**
+ * Returns the index of the first element whose integer key is not less than
+ * key, without calling a comparator. The loop is branchless, so lookups do
+ * not pay for mispredicted branches.
+ *
+ * @param array Pointer to an array sorted by that key (e.g. by radix_sort_dyn_array)
+ * @param key_offset Byte offset of the key within each element
+ * @param key_size Size of the key in bytes: 1, 2, 4 or 8
+ * @param key_signed Nonzero if the key is a signed integer
+ * @param key Key to search for, converted like the stored keys
+ * @return Index in [0, count]
+ */
+static inline size_t lower_bound_by_key_dyn_array(const DynArray* array, size_t key_offset, size_t key_size,
+                                                  int key_signed, int64_t key) {
+    uint64_t target = (uint64_t)key;
+    if (key_size < 8) {
+        target &= ((uint64_t)1 << (key_size * 8)) - 1;
+    }
+    if (key_signed) {
+        target ^= (uint64_t)1 << (key_size * 8 - 1);
+    }
+
+    const char* base = (const char*)array->items + key_offset;
+    size_t first = 0;
+    size_t n = array->count;
+    while (n > 1) {
+        size_t half = n / 2;
+        uint64_t probe = load_sort_key(base + (first + half - 1) * array->size, key_size, key_signed);
+        first += probe < target ? half : 0;
+        n -= half;
+    }
+    if (n == 1 && load_sort_key(base + first * array->size, key_size, key_signed) < target) {
+        first++;
+    }
+    return first;
+}
+
+/**
+ * lower_bound_by_key_dyn_array on the integer field T.field, e.g.
+ * LOWER_BOUND_DYN_ARRAY_BY(&users, User, id, 42).
+ */
+#define LOWER_BOUND_DYN_ARRAY_BY(array, T, field, key)                          \
+    lower_bound_by_key_dyn_array((array), offsetof(T, field), sizeof(((T*)0)->field), \
+                                 SORT_FIELD_IS_SIGNED(T, field), (key))
+
+/**
+ * DEFINE_DYN_ARRAY_SORT(T, LESS) adds TArray_sort and TArray_lower_bound for
+ * an array declared with DEFINE_DYN_ARRAY(T). LESS is a function (or macro)
+ * taking two const T* and returning nonzero if the first orders before the
+ * second; since it is known at compile time it is inlined into the sort.
+ */
+#define DEFINE_DYN_ARRAY_SORT(T, LESS)                                          \
+    static inline int T##Array_less_(const T* a, const T* b, int unused) {      \
+        (void)unused;                                                           \
+        return LESS(a, b);                                                      \
+    }                                                                           \
+                                                                                \
+    DEFINE_INTROSORT(T##Array_introsort_, T, int, T##Array_less_)               \
+                                                                                \
+    static inline void T##Array_sort(T##Array* array) {                         \
+        T##Array_introsort_(array->items, array->count, 0);                     \
+    }                                                                           \
+                                                                                \
+    static inline size_t T##Array_lower_bound(const T##Array* array, const T* key) { \
+        size_t first = 0;                                                       \
+        size_t n = array->count;                                                \
+        while (n > 0) {                                                         \
+            size_t half = n / 2;                                                \
+            if (LESS(&array->items[first + half], key)) {                       \
+                first += half + 1;                                              \
+                n -= half + 1;                                                  \
+            } else {                                                            \
+                n = half;                                                       \
+            }                                                                   \
+        }                                                                       \
+        return first;                                                           \
+    }
+
+#endif /* DS_SORT_H */
@@ -0,0 +1,183 @@
+/*
+ * Lock-Free Single-Producer Single-Consumer Ring Buffer
+ *
+ * Fixed-capacity circular buffer for handing elements from one thread to
+ * another. The producer only writes tail and the consumer only writes head,
+ * so neither needs a read-modify-write atomic: a release store publishes the
+ * elements, an acquire load observes them. Each side also keeps a private
+ * copy of the other side's index and only reloads it when the ring looks
+ * full (producer) or empty (consumer), so in steady state the shared cache
+ * lines are touched once per batch rather than once per element.
+ *
+ * The capacity is a power of two, so indices grow freely and are masked on
+ * access. Requires C11 atomics.
+ */
+
+#ifndef DS_SPSC_RING_H
+#define DS_SPSC_RING_H
+
+#include <stdatomic.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "allocator.h"
+
+#define SPSC_CACHE_LINE 64
+
+/**
+ * Ring state. The producer's and the consumer's fields live on separate
+ * cache lines so the two threads do not false-share.
+ */
+typedef struct {
+    void* items;                 /* cap elements of size bytes */
+    size_t size;                 /* Size of each element in bytes */
+    size_t mask;                 /* cap - 1 */
+    const Allocator* allocator;  /* Where items comes from, NULL for the C library */
+
+    _Alignas(SPSC_CACHE_LINE) atomic_size_t tail;  /* Next slot to write (producer) */
+    size_t cached_head;                            /* Producer's last view of head */
+
+    _Alignas(SPSC_CACHE_LINE) atomic_size_t head;  /* Next slot to read (consumer) */
+    size_t cached_tail;                            /* Consumer's last view of tail */
+} SpscRing;
+
+/**
+ * Initializes an empty ring. Not thread-safe; call before sharing.
+ *
+ * @param ring Pointer to caller-allocated ring
+ * @param size Size of each element in bytes (use sizeof())
+ * @param cap Capacity, rounded up to a power of two
+ * @param allocator Allocator for the buffer, or NULL for the C library
+ * @return 1 on success, 0 if cap is 0 or the buffer could not be allocated
+ */
+static inline int init_spsc_ring(SpscRing* ring, size_t size, size_t cap, const Allocator* allocator) {
+    if (cap == 0 || cap > ((size_t)-1 >> 1) + 1) {
+        return 0;
+    }
+    size_t pow2 = 1;
+    while (pow2 < cap) {
+        pow2 <<= 1;
+    }
+    if (size != 0 && pow2 > (size_t)-1 / size) {
+        return 0;
+    }
+
+    ring->items = allocate(allocator, pow2 * size, SPSC_CACHE_LINE);
+    if (ring->items == NULL) {
+        return 0;
+    }
+    ring->size = size;
+    ring->mask = pow2 - 1;
+    ring->allocator = allocator;
+    atomic_init(&ring->tail, 0);
+    atomic_init(&ring->head, 0);
+    ring->cached_head = 0;
+    ring->cached_tail = 0;
+    return 1;
+}
+
+/**
+ * Copies n elements into the ring starting at logical index pos, wrapping once if needed.
+ */
+static inline void copy_in_spsc_ring(SpscRing* ring, size_t pos, const void* src, size_t n) {
+    size_t start = pos & ring->mask;
+    size_t first = ring->mask + 1 - start < n ? ring->mask + 1 - start : n;
+    memcpy((char*)ring->items + start * ring->size, src, first * ring->size);
+    memcpy(ring->items, (const char*)src + first * ring->size, (n - first) * ring->size);
+}
+
+/**
+ * Copies n elements out of the ring starting at logical index pos, wrapping once if needed.
+ */
+static inline void copy_out_spsc_ring(const SpscRing* ring, size_t pos, void* dest, size_t n) {
+    size_t start = pos & ring->mask;
+    size_t first = ring->mask + 1 - start < n ? ring->mask + 1 - start : n;
+    memcpy(dest, (const char*)ring->items + start * ring->size, first * ring->size);
+    memcpy((char*)dest + first * ring->size, ring->items, (n - first) * ring->size);
+}
+
+/**
+ * Pushes up to n elements. Producer thread only.
+ *
+ * @param ring Pointer to the ring
+ * @param src Pointer to the first of n elements
+ * @param n Number of elements to push
+ * @return Number of elements pushed (less than n if the ring filled up)
+ */
+static inline size_t push_many_spsc_ring(SpscRing* ring, const void* src, size_t n) {
+    size_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    size_t cap = ring->mask + 1;
+    if (cap - (tail - ring->cached_head) < n) {
+        /* Looks full: refresh our view of the consumer */
+        ring->cached_head = atomic_load_explicit(&ring->head, memory_order_acquire);
+    }
+    size_t room = cap - (tail - ring->cached_head);
+    if (n > room) {
+        n = room;
+    }
+    if (n > 0) {
+        copy_in_spsc_ring(ring, tail, src, n);
+        atomic_store_explicit(&ring->tail, tail + n, memory_order_release);
+    }
+    return n;
+}
+
+/**
+ * Pushes one element. Producer thread only.
+ *
+ * @param ring Pointer to the ring
+ * @param val Pointer to the element
+ * @return 1 on success, 0 if the ring is full
+ */
+static inline int push_spsc_ring(SpscRing* ring, const void* val) {
+    return push_many_spsc_ring(ring, val, 1) == 1;
+}
+
+/**
+ * Pops up to n elements. Consumer thread only.
+ *
+ * @param ring Pointer to the ring
+ * @param dest Where the elements are copied
+ * @param n Maximum number of elements to pop
+ * @return Number of elements popped (0 if the ring is empty)
+ */
+static inline size_t pop_many_spsc_ring(SpscRing* ring, void* dest, size_t n) {
+    size_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    if (ring->cached_tail - head < n) {
+        /* Looks short: refresh our view of the producer */
+        ring->cached_tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+    }
+    size_t available = ring->cached_tail - head;
+    if (n > available) {
+        n = available;
+    }
+    if (n > 0) {
+        copy_out_spsc_ring(ring, head, dest, n);
+        atomic_store_explicit(&ring->head, head + n, memory_order_release);
+    }
+    return n;
+}
+
+/**
+ * Pops one element. Consumer thread only.
+ *
+ * @param ring Pointer to the ring
+ * @param popped Where the element is copied
+ * @return 1 on success, 0 if the ring is empty
+ */
+static inline int pop_spsc_ring(SpscRing* ring, void* popped) {
+    return pop_many_spsc_ring(ring, popped, 1) == 1;
+}
+
+/**
+ * Frees the ring's buffer. Neither thread may be using the ring.
+ *
+ * @param ring Pointer to the ring
+ */
+static inline void free_spsc_ring(SpscRing* ring) {
+    deallocate(ring->allocator, ring->items, (ring->mask + 1) * ring->size);
+    ring->items = NULL;
+    ring->mask = 0;
+}
+
+#endif /* DS_SPSC_RING_H */
@@ -0,0 +1,123 @@
+/*
+ * Streaming Record Loader Example
+ *
+ * This file demonstrates loading a large file of User records while
+ * processing them, instead of reading and pushing one record at a time.
+ * The implementation supports:
+ *
+ * - Large page-aligned block reads on a background thread (double buffering)
+ * - Decoding whole blocks into reserved DynArray capacity with one bulk push
+ * - A consumer callback per filled chunk, running while the next block is read
+ * - Files written by write_dyn_array, raw record streams, pipes and sockets
+ *
+ * Key concepts demonstrated:
+ * - Overlapping I/O with processing
+ * - Amortizing syscalls and per-element overhead over large blocks
+ * - Bounded memory for arbitrarily long streams
+ *
+ * Build with: cc -pthread ds/stream_loader.c
+ */
+
+#define _POSIX_C_SOURCE 200112L
+#include <fcntl.h>
+#include <stdio.h>
+#include <unistd.h>
+
+#include "serialize.h"
+#include "stream_loader.h"
+#include "user.h"
+
+/**
+ * Example chunk callback: tallies the users of a chunk and their id sum.
+ * Can be passed as a StreamChunkFn function pointer.
+ */
+int tally_users(DynArray* chunk, void* ctx) {
+    long long* totals = ctx;
+    const User* users = chunk->items;
+    for (size_t i = 0; i < chunk->count; ++i) {
+        totals[1] += users[i].id;
+    }
+    totals[0] += (long long)chunk->count;
+    totals[2]++;
+    return 1;
+}
+
+/**
+ * Example chunk callback: stops the load once a user with id *ctx is seen.
+ */
+int stop_at_id(DynArray* chunk, void* ctx) {
+    const User* users = chunk->items;
+    for (size_t i = 0; i < chunk->count; ++i) {
+        if (users[i].id == *(short*)ctx) {
+            printf("Found id %d, stopping the load\n", users[i].id);
+            return 0;
+        }
+    }
+    return 1;
+}
+
+int main(void) {
+    const char* path = "/tmp/ds_stream_users.bin";
+
+    /* Write 200000 users in the DynArray serialization format */
+    DynArray users;
+    new_dyn_array(sizeof(User), &users);
+    for (int i = 0; i < 200000; ++i) {
+        User user;
+        snprintf(user.name, sizeof(user.name), "user%d", i);
+        user.id = (short)(i % 30000);
+        push_dyn_array(&users, &user);
+    }
+    FILE* out = fopen(path, "wb");
+    if (out == NULL || !write_dyn_array(out, &users)) {
+        printf("Could not write %s\n", path);
+        return 1;
+    }
+    fclose(out);
+
+    /* Stream it through a callback: memory stays at one 256 KiB block of records */
+    long long totals[3] = {0, 0, 0};
+    DynArray chunk;
+    new_dyn_array(sizeof(User), &chunk);
+    int fd = open(path, O_RDONLY);
+    if (stream_serialized_dyn_array(fd, &chunk, 256 * 1024, tally_users, totals)) {
+        printf("Streamed %lld users in %lld chunks, id sum %lld\n", totals[0], totals[2], totals[1]);
+    }
+    close(fd);
+
+    /* Stop early from the callback */
+    short wanted = 12345;
+    fd = open(path, O_RDONLY);
+    stream_serialized_dyn_array(fd, &chunk, 0, stop_at_id, &wanted);
+    close(fd);
+
+    /* Collect everything: the header's count is reserved up front */
+    DynArray loaded;
+    new_dyn_array(sizeof(User), &loaded);
+    fd = open(path, O_RDONLY);
+    if (stream_serialized_dyn_array(fd, &loaded, 0, NULL, NULL)) {
+        User* last = (User*)loaded.items + loaded.count - 1;
+        printf("Loaded %zu users (capacity %zu), last: %s (%d)\n", loaded.count, loaded.cap, last->name, last->id);
+    }
+    close(fd);
+
+    /* Raw records through a pipe: short reads and split records are handled */
+    int fds[2];
+    if (pipe(fds) == 0) {
+        /* Small enough to fit in the pipe buffer, so one thread can write it all first */
+        ssize_t written = write(fds[1], users.items, 1000 * sizeof(User));
+        close(fds[1]);
+        loaded.count = 0;
+        if (written > 0 && stream_records(fds[0], &loaded, 4096, NULL, NULL)) {
+            printf("Read %zu users from a pipe, last: %s\n", loaded.count,
+                   ((User*)loaded.items)[loaded.count - 1].name);
+        }
+        close(fds[0]);
+    }
+
+    free_dyn_array(&loaded);
+    free_dyn_array(&chunk);
+    free_dyn_array(&users);
+    remove(path);
+    return 0;
+}
@@ -0,0 +1,319 @@
+/*
+ * Streaming, Double-Buffered Record Loader
+ *
+ * Loads fixed-size plain-data records (such as User) from a file descriptor,
+ * a file or a socket, into a DynArray. Instead of one read and one
+ * push_dyn_array per record, a reader thread fills large, page-aligned
+ * blocks with read() while the calling thread turns the previous block into
+ * records: every whole record in a block goes into the array's reserved
+ * capacity with a single push_many_dyn_array, and a record split across two
+ * blocks is stitched together through a one-record carry buffer.
+ *
+ * With two blocks in flight, I/O overlaps with decoding and with a consumer
+ * callback that receives each filled chunk, so the loop is bound by the
+ * slower of the two rather than by their sum, and the syscall count is one
+ * per block instead of one per record.
+ *
+ * stream_records reads raw records to end of file; stream_serialized_dyn_array
+ * reads the format write_dyn_array and serialize_dyn_array produce.
+ *
+ * This uses portable POSIX read() from a helper thread rather than io_uring,
+ * which gives the same overlap for sequential loads without a Linux-only
+ * dependency. Requires POSIX threads.
+ */
+
+#ifndef DS_STREAM_LOADER_H
+#define DS_STREAM_LOADER_H
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "allocator.h"
+#include "dyn_array.h"
+#include "serialize.h"
+
+/* Blocks are aligned (and sized in multiples of) this, a page on common systems */
+#define STREAM_LOADER_ALIGN 4096
+#define STREAM_LOADER_DEFAULT_BLOCK ((size_t)1 << 20)
+
+/**
+ * Chunk callback: receives the records decoded since the previous call.
+ * The array is emptied (its capacity kept) once the callback returns, so the
+ * callback must copy anything it wants to keep.
+ *
+ * @return 1 to keep loading, 0 to stop (the rest of the stream is not read)
+ */
+typedef int (*StreamChunkFn)(DynArray* chunk, void* ctx);
+
+/**
+ * One I/O block, handed back and forth between the reader and the decoder.
+ */
+typedef struct {
+    unsigned char* data;  /* Block buffer, block_size bytes */
+    size_t len;           /* Bytes read into it */
+    int full;             /* 1 while the decoder owns the block, 0 while the reader does */
+    int last;             /* 1 if the stream ends with this block */
+} StreamBlock;
+
+/**
+ * Loader state shared by the reader thread and the decoding thread.
+ */
+typedef struct {
+    int fd;                      /* Source descriptor */
+    uint64_t remaining;          /* Bytes still to read (UINT64_MAX reads to end of file) */
+    size_t block_size;           /* Bytes per read, a multiple of STREAM_LOADER_ALIGN */
+    StreamBlock blocks[2];       /* Double buffer */
+    pthread_mutex_t lock;        /* Protects full, last, len, stop and failed */
+    pthread_cond_t changed;      /* Signalled when a block changes hands or stop is set */
+    int stop;                    /* Set by the decoder to end the reader early */
+    int failed;                  /* Set by the reader on a read error */
+    unsigned char* carry;        /* Bytes of a record split across blocks, one record long */
+    size_t carry_len;            /* Number of bytes in carry */
+    size_t record_size;          /* Size of one record (and of carry) */
+    const Allocator* allocator;  /* Where the blocks and carry come from */
+} StreamLoader;
+
+/**
+ * Reader thread: fills the blocks in turn until the stream ends or the
+ * decoder stops it, reading each block whole (read() may return less,
+ * e.g. on sockets, so it is called until the block is full or the stream ends).
+ */
+static inline void* stream_loader_reader(void* arg) {
+    StreamLoader* loader = arg;
+    for (size_t i = 0;; i ^= 1) {
+        StreamBlock* block = &loader->blocks[i];
+        pthread_mutex_lock(&loader->lock);
+        while (block->full && !loader->stop) {
+            pthread_cond_wait(&loader->changed, &loader->lock);
+        }
+        int stop = loader->stop;
+        pthread_mutex_unlock(&loader->lock);
+        if (stop) {
+            return NULL;
+        }
+
+        size_t want = loader->remaining < loader->block_size ? (size_t)loader->remaining : loader->block_size;
+        size_t len = 0;
+        int failed = 0;
+        while (len < want) {
+            ssize_t got = read(loader->fd, block->data + len, want - len);
+            if (got > 0) {
+                len += (size_t)got;
+            } else if (got < 0 && errno == EINTR) {
+                continue;
+            } else {
+                failed = got < 0;
+                break;
+            }
+        }
+        if (loader->remaining != UINT64_MAX) {
+            loader->remaining -= len;
+        }
+        int last = failed || len < want || loader->remaining == 0;
+
+        pthread_mutex_lock(&loader->lock);
+        block->len = len;
+        block->last = last;
+        block->full = 1;
+        loader->failed |= failed;
+        pthread_cond_broadcast(&loader->changed);
+        pthread_mutex_unlock(&loader->lock);
+        if (last) {
+            return NULL;
+        }
+    }
+}
+
+/**
+ * Appends the records in one block to out, completing the carried partial
+ * record first and carrying the block's trailing partial record.
+ *
+ * @return 1 on success, 0 if out could not grow
+ */
+static inline int decode_stream_block(StreamLoader* loader, DynArray* out, const unsigned char* data, size_t len) {
+    size_t size = out->size;
+    if (loader->carry_len > 0) {
+        size_t take = size - loader->carry_len < len ? size - loader->carry_len : len;
+        memcpy(loader->carry + loader->carry_len, data, take);
+        loader->carry_len += take;
+        data += take;
+        len -= take;
+        if (loader->carry_len < size) {
+            return 1;
+        }
+        if (!push_many_dyn_array(out, loader->carry, 1)) {
+            return 0;
+        }
+        loader->carry_len = 0;
+    }
+    size_t n = len / size;
+    if (n > 0 && !push_many_dyn_array(out, data, n)) {
+        return 0;
+    }
+    loader->carry_len = len - n * size;
+    memcpy(loader->carry, data + n * size, loader->carry_len);
+    return 1;
+}
+
+/**
+ * Releases the loader's buffers.
+ */
+static inline void free_stream_loader(StreamLoader* loader) {
+    for (size_t i = 0; i < 2; ++i) {
+        deallocate(loader->allocator, loader->blocks[i].data, loader->block_size);
+    }
+    deallocate(loader->allocator, loader->carry, loader->record_size);
+    pthread_mutex_destroy(&loader->lock);
+    pthread_cond_destroy(&loader->changed);
+}
+
+/**
+ * Streams limit bytes of records of out->size bytes from fd into out, or
+ * everything up to end of file if limit is UINT64_MAX. See stream_records
+ * for the other parameters.
+ *
+ * @return 1 if all limit bytes (or the whole stream) were read and ended on a
+ *         record boundary, or fn stopped the load; 0 on a read error, a failed
+ *         allocation, a stream shorter than limit or a trailing partial record
+ */
+static inline int stream_record_bytes(int fd, uint64_t limit, DynArray* out, size_t block_size,
+                                      StreamChunkFn fn, void* ctx) {
+    if (out->size == 0) {
+        return 0;
+    }
+    StreamLoader loader;
+    loader.fd = fd;
+    loader.remaining = limit;
+    loader.block_size = (block_size ? block_size : STREAM_LOADER_DEFAULT_BLOCK) + STREAM_LOADER_ALIGN - 1;
+    loader.block_size -= loader.block_size % STREAM_LOADER_ALIGN;
+    loader.stop = 0;
+    loader.failed = 0;
+    loader.carry_len = 0;
+    loader.record_size = out->size;
+    loader.allocator = out->options.allocator;
+    pthread_mutex_init(&loader.lock, NULL);
+    pthread_cond_init(&loader.changed, NULL);
+    loader.carry = allocate(loader.allocator, out->size, 0);
+    for (size_t i = 0; i < 2; ++i) {
+        loader.blocks[i].data = allocate(loader.allocator, loader.block_size, STREAM_LOADER_ALIGN);
+        loader.blocks[i].full = 0;
+        loader.blocks[i].last = 0;
+    }
+    /* With a consumer, out only ever holds one block's records: reserve that once */
+    size_t chunk_cap = loader.block_size / out->size + 1;
+    if (loader.carry == NULL || loader.blocks[0].data == NULL || loader.blocks[1].data == NULL ||
+        (fn != NULL && !grow_for_dyn_array(out, chunk_cap))) {
+        free_stream_loader(&loader);
+        return 0;
+    }
+
+#ifdef POSIX_FADV_SEQUENTIAL
+    /* Ask for aggressive readahead; fails harmlessly on pipes and sockets */
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+
+    pthread_t reader;
+    if (pthread_create(&reader, NULL, stream_loader_reader, &loader) != 0) {
+        free_stream_loader(&loader);
+        return 0;
+    }
+
+    /* 1 while loading, 0 after a failure, -1 once fn asked to stop */
+    int ok = 1;
+    for (size_t i = 0;; i ^= 1) {
+        StreamBlock* block = &loader.blocks[i];
+        pthread_mutex_lock(&loader.lock);
+        while (!block->full) {
+            pthread_cond_wait(&loader.changed, &loader.lock);
+        }
+        pthread_mutex_unlock(&loader.lock);
+
+        /* The reader is filling the other block meanwhile */
+        int last = block->last;
+        ok = decode_stream_block(&loader, out, block->data, block->len);
+        if (ok && fn != NULL && out->count > 0) {
+            ok = fn(out, ctx) ? 1 : -1;
+            out->count = 0;
+        }
+
+        pthread_mutex_lock(&loader.lock);
+        block->full = 0;
+        if (ok != 1) {
+            loader.stop = 1;
+        }
+        pthread_cond_broadcast(&loader.changed);
+        pthread_mutex_unlock(&loader.lock);
+        if (ok != 1 || last) {
+            break;
+        }
+    }
+    pthread_join(reader, NULL);
+
+    int complete = limit == UINT64_MAX || loader.remaining == 0;
+    int result = ok == -1 || (ok == 1 && !loader.failed && complete && loader.carry_len == 0);
+    free_stream_loader(&loader);
+    return result;
+}
+
+/**
+ * Reads records of out->size bytes from fd until end of file, appending them
+ * to out, in blocks of block_size bytes read by a background thread.
+ *
+ * Without a callback, every record ends up in out, which grows about once
+ * per block. With one, fn is called after each block with the records it
+ * completed and out is emptied in between, so memory stays at one block's
+ * worth of records however long the stream is.
+ *
+ * @param fd Descriptor to read from (file, pipe or socket), positioned at the first record
+ * @param out Initialized array whose element size is the record size
+ * @param block_size Bytes per read, rounded up to STREAM_LOADER_ALIGN (0 = STREAM_LOADER_DEFAULT_BLOCK)
+ * @param fn Chunk callback, or NULL to collect every record in out
+ * @param ctx Opaque caller state passed through to every call of fn
+ * @return 1 if the stream ended on a record boundary or fn stopped it,
+ *         0 on a read error, a failed allocation or a trailing partial record
+ *         (out then holds the records decoded before the failure)
+ */
+static inline int stream_records(int fd, DynArray* out, size_t block_size, StreamChunkFn fn, void* ctx) {
+    return stream_record_bytes(fd, UINT64_MAX, out, block_size, fn, ctx);
+}
+
+/**
+ * Reads an array written by write_dyn_array (or serialize_dyn_array) from fd,
+ * appending its elements to out like stream_records. Without a callback the
+ * whole array is reserved up front from the header's count.
+ *
+ * @param fd Descriptor to read from, positioned at the header
+ * @param out Initialized array whose element size must match the data
+ * @param block_size Bytes per read (0 = STREAM_LOADER_DEFAULT_BLOCK)
+ * @param fn Chunk callback, or NULL to collect every element in out
+ * @param ctx Opaque caller state passed through to every call of fn
+ * @return 1 if all elements were read or fn stopped the load, 0 on a read
+ *         error, invalid or truncated data, or a failed allocation
+ */
+static inline int stream_serialized_dyn_array(int fd, DynArray* out, size_t block_size, StreamChunkFn fn,
+                                              void* ctx) {
+    SerialHeader header;
+    size_t len = 0;
+    while (len < sizeof(header)) {
+        ssize_t got = read(fd, (char*)&header + len, sizeof(header) - len);
+        if (got > 0) {
+            len += (size_t)got;
+        } else if (got == 0 || errno != EINTR) {
+            return 0;
+        }
+    }
+    if (!check_dyn_array_header(&header, out->size)) {
+        return 0;
+    }
+    if (fn == NULL && !grow_for_dyn_array(out, (size_t)header.count)) {
+        return 0;
+    }
+    return stream_record_bytes(fd, header.payload_bytes, out, block_size, fn, ctx);
+}
+
+#endif /* DS_STREAM_LOADER_H */
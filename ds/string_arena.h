@@ -0,0 +1,248 @@
+/*
+ * String Arena with Optional Interning
+ *
+ * Stores variable-length strings back to back in one contiguous byte buffer
+ * (a DynArray of char), each followed by a NUL so it can be handed to C string
+ * functions. A string is named by a StringRef, an 8-byte (offset, length)
+ * pair, instead of a pointer: refs stay valid when the buffer grows and
+ * moves, and records holding them stay small and trivially copyable.
+ *
+ * Interning looks a string up before storing it, so equal strings share one
+ * copy and compare equal by ref. The intern table is open addressing over
+ * (hash, ref) slots; it is checked against the stored bytes, so hash
+ * collisions never merge different strings. Strings are never removed.
+ *
+ * Offsets and lengths are 32-bit, so one arena holds up to 4 GiB of text.
+ */
+
+#ifndef DS_STRING_ARENA_H
+#define DS_STRING_ARENA_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "allocator.h"
+#include "dyn_array.h"
+
+/* Largest total size of an arena, so every offset fits in a StringRef */
+#define STRING_ARENA_MAX_BYTES ((size_t)UINT32_MAX)
+#define STRING_ARENA_MIN_SLOTS 16
+/* Marks a free intern slot; no string can start at this offset */
+#define STRING_ARENA_EMPTY UINT32_MAX
+
+/**
+ * Handle to a string stored in an arena.
+ */
+typedef struct {
+    uint32_t offset;  /* Byte offset of the first character in the arena */
+    uint32_t len;     /* Length in bytes, excluding the terminating NUL */
+} StringRef;
+
+/**
+ * One intern table slot: a stored string and its hash.
+ */
+typedef struct {
+    StringRef ref;   /* ref.offset is STRING_ARENA_EMPTY if the slot is free */
+    uint32_t hash;   /* Low 32 bits of the string's hash */
+} StringInternSlot;
+
+/**
+ * Arena control structure.
+ */
+typedef struct {
+    DynArray bytes;              /* Concatenated NUL-terminated strings */
+    StringInternSlot* slots;     /* Power-of-two intern table, NULL until the first intern */
+    size_t mask;                 /* Number of slots - 1 (0 while slots is NULL) */
+    size_t interned;             /* Number of distinct interned strings */
+    const Allocator* allocator;  /* Where the buffer and table come from, NULL for the C library */
+} StringArena;
+
+/**
+ * Initializes an empty arena. No memory is allocated until the first string.
+ *
+ * @param arena Pointer to caller-allocated arena
+ * @param allocator Allocator for the buffer and table, or NULL for the C library
+ */
+static inline void init_string_arena(StringArena* arena, const Allocator* allocator) {
+    DynArrayOptions options = DYN_ARRAY_DEFAULT_OPTIONS;
+    options.initial_cap = 0;
+    options.allocator = allocator;
+    init_dyn_array(sizeof(char), &options, &arena->bytes);
+    arena->slots = NULL;
+    arena->mask = 0;
+    arena->interned = 0;
+    arena->allocator = allocator;
+}
+
+/**
+ * Returns the NUL-terminated string named by ref.
+ *
+ * @param arena Pointer to the arena
+ * @param ref Ref returned by add_string_arena or intern_string_arena
+ * @return Pointer into the arena, valid until the next string is added
+ */
+static inline const char* str_string_arena(const StringArena* arena, StringRef ref) {
+    return (const char*)arena->bytes.items + ref.offset;
+}
+
+/**
+ * Copies a string into the arena without looking for an existing copy.
+ *
+ * @param arena Pointer to the arena
+ * @param s Characters to store (need not be NUL-terminated)
+ * @param len Number of characters
+ * @param out Where the ref of the new string is written
+ * @return 1 on success, 0 if the arena would exceed STRING_ARENA_MAX_BYTES or could not grow
+ */
+static inline int add_string_arena(StringArena* arena, const char* s, size_t len, StringRef* out) {
+    size_t offset = arena->bytes.count;
+    if (len >= STRING_ARENA_MAX_BYTES - offset) {
+        return 0;
+    }
+    if (!grow_for_dyn_array(&arena->bytes, len + 1)) {
+        return 0;
+    }
+    char* dest = (char*)arena->bytes.items + offset;
+    memcpy(dest, s, len);
+    dest[len] = '\0';
+    arena->bytes.count += len + 1;
+    out->offset = (uint32_t)offset;
+    out->len = (uint32_t)len;
+    return 1;
+}
+
+/**
+ * Hashes a string (64-bit FNV-1a).
+ */
+static inline uint64_t hash_string_arena(const char* s, size_t len) {
+    uint64_t hash = 0xcbf29ce484222325u;
+    for (size_t i = 0; i < len; ++i) {
+        hash ^= (unsigned char)s[i];
+        hash *= 0x100000001b3u;
+    }
+    return hash;
+}
+
+/**
+ * Resizes the intern table to nslots (a power of two), rehashing from the stored hashes.
+ *
+ * @return 1 on success, 0 if the allocation failed (the table is unchanged)
+ */
+static inline int rehash_string_arena(StringArena* arena, size_t nslots) {
+    if (nslots > (size_t)-1 / sizeof(StringInternSlot)) {
+        return 0;
+    }
+    StringInternSlot* slots = allocate(arena->allocator, nslots * sizeof(StringInternSlot), 0);
+    if (slots == NULL) {
+        return 0;
+    }
+    for (size_t i = 0; i < nslots; ++i) {
+        slots[i].ref.offset = STRING_ARENA_EMPTY;
+    }
+
+    size_t old_slots = arena->slots != NULL ? arena->mask + 1 : 0;
+    for (size_t i = 0; i < old_slots; ++i) {
+        StringInternSlot slot = arena->slots[i];
+        if (slot.ref.offset != STRING_ARENA_EMPTY) {
+            size_t pos = slot.hash & (nslots - 1);
+            while (slots[pos].ref.offset != STRING_ARENA_EMPTY) {
+                pos = (pos + 1) & (nslots - 1);
+            }
+            slots[pos] = slot;
+        }
+    }
+    deallocate(arena->allocator, arena->slots, old_slots * sizeof(StringInternSlot));
+    arena->slots = slots;
+    arena->mask = nslots - 1;
+    return 1;
+}
+
+/**
+ * Looks for an interned copy of a string.
+ *
+ * @param arena Pointer to the arena
+ * @param s Characters to look for
+ * @param len Number of characters
+ * @param out Where the ref of the existing copy is written, if there is one
+ * @return 1 if the string is interned, 0 otherwise
+ */
+static inline int find_string_arena(const StringArena* arena, const char* s, size_t len, StringRef* out) {
+    if (arena->interned == 0) {
+        return 0;
+    }
+    uint32_t hash = (uint32_t)hash_string_arena(s, len);
+    for (size_t pos = hash & arena->mask;; pos = (pos + 1) & arena->mask) {
+        const StringInternSlot* slot = &arena->slots[pos];
+        if (slot->ref.offset == STRING_ARENA_EMPTY) {
+            return 0;
+        }
+        if (slot->hash == hash && slot->ref.len == len &&
+            memcmp(str_string_arena(arena, slot->ref), s, len) == 0) {
+            *out = slot->ref;
+            return 1;
+        }
+    }
+}
+
+/**
+ * Stores a string unless an equal one was already interned, in which case
+ * that copy's ref is returned and nothing is added.
+ *
+ * @param arena Pointer to the arena
+ * @param s Characters to store (need not be NUL-terminated)
+ * @param len Number of characters
+ * @param out Where the ref of the (new or existing) string is written
+ * @return 1 on success, 0 if the arena or its table could not grow
+ */
+static inline int intern_string_arena(StringArena* arena, const char* s, size_t len, StringRef* out) {
+    if (find_string_arena(arena, s, len, out)) {
+        return 1;
+    }
+    /* Keep the table at most half full so probe runs stay short */
+    size_t nslots = arena->slots != NULL ? arena->mask + 1 : 0;
+    if (arena->interned + 1 > nslots / 2 &&
+        !rehash_string_arena(arena, nslots ? nslots * 2 : STRING_ARENA_MIN_SLOTS)) {
+        return 0;
+    }
+    if (!add_string_arena(arena, s, len, out)) {
+        return 0;
+    }
+
+    StringInternSlot entry = {*out, (uint32_t)hash_string_arena(s, len)};
+    size_t pos = entry.hash & arena->mask;
+    while (arena->slots[pos].ref.offset != STRING_ARENA_EMPTY) {
+        pos = (pos + 1) & arena->mask;
+    }
+    arena->slots[pos] = entry;
+    arena->interned++;
+    return 1;
+}
+
+/**
+ * Compares a stored string with a C string.
+ *
+ * @param arena Pointer to the arena
+ * @param ref Stored string
+ * @param s NUL-terminated string to compare with
+ * @return Nonzero if they are equal
+ */
+static inline int equals_string_arena(const StringArena* arena, StringRef ref, const char* s) {
+    return strlen(s) == ref.len && memcmp(str_string_arena(arena, ref), s, ref.len) == 0;
+}
+
+/**
+ * Releases the buffer and the intern table and resets the arena to empty.
+ * Every ref into the arena becomes invalid.
+ *
+ * @param arena Pointer to the arena
+ */
+static inline void free_string_arena(StringArena* arena) {
+    free_dyn_array(&arena->bytes);
+    deallocate(arena->allocator, arena->slots, arena->slots != NULL ? (arena->mask + 1) * sizeof(StringInternSlot) : 0);
+    arena->slots = NULL;
+    arena->mask = 0;
+    arena->interned = 0;
+}
+
+#endif /* DS_STRING_ARENA_H */
@@ -0,0 +1,596 @@
+/*
+ * Work-Stealing Task Pool with Fork/Join
+ *
+ * ThreadPool (thread_pool.h) runs flat batches of equal tasks. TaskPool is
+ * for nested and irregular parallelism: a task can spawn subtasks and join
+ * them, so divide-and-conquer algorithms (recursive splits of an array,
+ * list segments, sorts, index builds) run on one set of threads without
+ * creating any.
+ *
+ * Every worker owns a Chase-Lev deque of spawned tasks. The owner pushes and
+ * takes at the bottom without read-modify-write atomics in the common case,
+ * idle workers steal the oldest (largest) task from the top of a random
+ * victim, so work spreads by itself and each worker mostly stays in the
+ * memory it was already touching. A worker waiting in a join runs other
+ * tasks instead of blocking.
+ *
+ * Tasks and their groups live in the spawning frame (usually on the stack),
+ * so spawning does not allocate. Workers sleep between runs; during a run,
+ * workers without work keep looking and yield the CPU between attempts.
+ *
+ * On Linux, define _GNU_SOURCE before any #include to be able to pin each
+ * worker to its own CPU (see init_task_pool), which keeps workers and the
+ * pages they first touch on one NUMA node.
+ *
+ * Requires POSIX threads and C11 atomics.
+ */
+
+#ifndef DS_TASK_POOL_H
+#define DS_TASK_POOL_H
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "allocator.h"
+#include "dyn_array.h"
+#include "linked_list.h"
+
+#define TASK_POOL_CACHE_LINE 64
+/* Tasks a deque holds; a spawn into a full deque runs the task inline */
+#define TASK_DEQUE_CAP 1024
+/* Smallest range parallel_for_task_pool hands to one call when grain is 0 */
+#define TASK_POOL_MIN_GRAIN 1024
+/* Nodes per list segment, and segments walked ahead per batch, in process_list_task_pool */
+#define TASK_LIST_SEGMENT 1024
+#define TASK_LIST_BATCH 64
+/* Failed searches for work before a worker starts yielding the CPU */
+#define TASK_POOL_SPINS 64
+
+struct TaskPool;
+
+/**
+ * Task body: runs with the pool it belongs to, so it can spawn and join subtasks.
+ */
+typedef void (*TaskFn)(struct TaskPool* pool, void* ctx);
+
+/**
+ * Set of spawned tasks that are joined together.
+ */
+typedef struct {
+    atomic_size_t pending;  /* Spawned tasks that have not finished */
+} TaskGroup;
+
+/**
+ * A spawned task. Owned by the spawner and must stay valid until its group is joined.
+ */
+typedef struct {
+    TaskFn fn;
+    void* ctx;
+    TaskGroup* group;
+} Task;
+
+/**
+ * Chase-Lev deque. The owner works at the bottom, thieves at the top; the two
+ * indices are on separate cache lines.
+ */
+typedef struct {
+    _Alignas(TASK_POOL_CACHE_LINE) atomic_ptrdiff_t top;     /* Next task to steal */
+    _Alignas(TASK_POOL_CACHE_LINE) atomic_ptrdiff_t bottom;  /* Next free slot, written by the owner */
+    uint64_t rng;                                            /* Owner's victim selection state */
+    _Alignas(TASK_POOL_CACHE_LINE) _Atomic(Task*) slots[TASK_DEQUE_CAP];
+} TaskDeque;
+
+/**
+ * Pool state. Deque 0 belongs to the thread inside run_task_pool, deques
+ * 1..nworkers to the workers.
+ */
+typedef struct TaskPool {
+    TaskDeque* deques;         /* nworkers + 1 deques */
+    size_t ndeques;
+    size_t deques_cap;         /* Deques allocated, can exceed ndeques if workers failed to start */
+    pthread_t* threads;        /* Worker threads */
+    size_t nworkers;           /* Number of worker threads */
+    size_t threads_cap;        /* Thread handles allocated, can exceed nworkers */
+    pthread_mutex_t lock;      /* Protects shutdown and the sleep/wake protocol */
+    pthread_cond_t wake;       /* Signalled when a run starts or the pool shuts down */
+    pthread_mutex_t run_lock;  /* Serializes run_task_pool callers */
+    atomic_int running;        /* Nonzero while a run is in progress */
+    int shutdown;              /* Set by free_task_pool */
+} TaskPool;
+
+/**
+ * Worker start-up data: which pool and which deque.
+ */
+typedef struct {
+    TaskPool* pool;
+    size_t index;
+} TaskPoolWorker;
+
+/* Pool and deque of the calling thread, NULL outside of any run. Weak, so all translation units share them. */
+__attribute__((weak)) _Thread_local TaskPool* task_pool_current;
+__attribute__((weak)) _Thread_local size_t task_pool_current_index;
+
+/**
+ * Pushes a task at the bottom of the owner's deque.
+ *
+ * @return 1 on success, 0 if the deque is full
+ */
+static inline int push_task_deque(TaskDeque* deque, Task* task) {
+    ptrdiff_t b = atomic_load_explicit(&deque->bottom, memory_order_relaxed);
+    ptrdiff_t t = atomic_load_explicit(&deque->top, memory_order_acquire);
+    if (b - t >= TASK_DEQUE_CAP) {
+        return 0;
+    }
+    atomic_store_explicit(&deque->slots[b & (TASK_DEQUE_CAP - 1)], task, memory_order_relaxed);
+    /* Publishes the slot (and the task it points to) to thieves */
+    atomic_store_explicit(&deque->bottom, b + 1, memory_order_release);
+    return 1;
+}
+
+/**
+ * Takes the most recently pushed task, owner only.
+ *
+ * @return The task, or NULL if the deque is empty or a thief got the last one
+ */
+static inline Task* take_task_deque(TaskDeque* deque) {
+    ptrdiff_t b = atomic_load_explicit(&deque->bottom, memory_order_relaxed) - 1;
+    /* Sequentially consistent so the store to bottom is ordered before the load of top */
+    atomic_store_explicit(&deque->bottom, b, memory_order_seq_cst);
+    ptrdiff_t t = atomic_load_explicit(&deque->top, memory_order_seq_cst);
+    if (t > b) {
+        atomic_store_explicit(&deque->bottom, b + 1, memory_order_relaxed);
+        return NULL;
+    }
+    Task* task = atomic_load_explicit(&deque->slots[b & (TASK_DEQUE_CAP - 1)], memory_order_relaxed);
+    if (t == b) {
+        /* Last task: race thieves for it */
+        if (!atomic_compare_exchange_strong_explicit(&deque->top, &t, t + 1, memory_order_seq_cst,
+                                                     memory_order_relaxed)) {
+            task = NULL;
+        }
+        atomic_store_explicit(&deque->bottom, b + 1, memory_order_relaxed);
+    }
+    return task;
+}
+
+/**
+ * Steals the oldest task, from any thread.
+ *
+ * @return The task, or NULL if the deque is empty or another thread won the race
+ */
+static inline Task* steal_task_deque(TaskDeque* deque) {
+    ptrdiff_t t = atomic_load_explicit(&deque->top, memory_order_seq_cst);
+    ptrdiff_t b = atomic_load_explicit(&deque->bottom, memory_order_seq_cst);
+    if (t >= b) {
+        return NULL;
+    }
+    Task* task = atomic_load_explicit(&deque->slots[t & (TASK_DEQUE_CAP - 1)], memory_order_relaxed);
+    if (!atomic_compare_exchange_strong_explicit(&deque->top, &t, t + 1, memory_order_seq_cst,
+                                                 memory_order_relaxed)) {
+        return NULL;
+    }
+    return task;
+}
+
+/**
+ * Runs a task and marks it finished. The task may be gone once its group sees it finish.
+ */
+static inline void execute_task_pool(TaskPool* pool, Task* task) {
+    TaskGroup* group = task->group;
+    task->fn(pool, task->ctx);
+    atomic_fetch_sub_explicit(&group->pending, 1, memory_order_release);
+}
+
+/**
+ * Looks for a task: the caller's own deque first, then one steal attempt
+ * from every other deque, starting at a random victim.
+ *
+ * @return A task to run, or NULL if none was found
+ */
+static inline Task* find_task_pool(TaskPool* pool, size_t self) {
+    TaskDeque* own = &pool->deques[self];
+    Task* task = take_task_deque(own);
+    if (task != NULL || pool->ndeques == 1) {
+        return task;
+    }
+    own->rng ^= own->rng << 13;
+    own->rng ^= own->rng >> 7;
+    own->rng ^= own->rng << 17;
+    size_t start = (size_t)(own->rng % pool->ndeques);
+    for (size_t i = 0; i < pool->ndeques; ++i) {
+        size_t victim = (start + i) % pool->ndeques;
+        if (victim != self && (task = steal_task_deque(&pool->deques[victim])) != NULL) {
+            return task;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Backs off after a failed search for work: a few immediate retries, then yielding the CPU.
+ */
+static inline void idle_task_pool(unsigned* misses) {
+    if (++*misses > TASK_POOL_SPINS) {
+        sched_yield();
+    }
+}
+
+static inline void* task_pool_worker(void* arg) {
+    TaskPoolWorker* worker = arg;
+    TaskPool* pool = worker->pool;
+    size_t self = worker->index;
+    deallocate(NULL, worker, sizeof(*worker));
+    task_pool_current = pool;
+    task_pool_current_index = self;
+
+    for (;;) {
+        pthread_mutex_lock(&pool->lock);
+        while (!pool->shutdown && !atomic_load_explicit(&pool->running, memory_order_relaxed)) {
+            pthread_cond_wait(&pool->wake, &pool->lock);
+        }
+        int shutdown = pool->shutdown;
+        pthread_mutex_unlock(&pool->lock);
+        if (shutdown) {
+            return NULL;
+        }
+
+        unsigned misses = 0;
+        while (atomic_load_explicit(&pool->running, memory_order_relaxed)) {
+            Task* task = find_task_pool(pool, self);
+            if (task != NULL) {
+                execute_task_pool(pool, task);
+                misses = 0;
+            } else {
+                idle_task_pool(&misses);
+            }
+        }
+    }
+}
+
+/**
+ * Pins a worker thread to the index-th CPU the process may run on (Linux with _GNU_SOURCE only).
+ */
+static inline void pin_task_pool_worker(pthread_t thread, size_t index) {
+#if defined(__linux__) && defined(_GNU_SOURCE)
+    cpu_set_t allowed;
+    if (pthread_getaffinity_np(pthread_self(), sizeof(allowed), &allowed) != 0 || CPU_COUNT(&allowed) == 0) {
+        return;
+    }
+    size_t target = index % (size_t)CPU_COUNT(&allowed);
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+        if (CPU_ISSET(cpu, &allowed) && target-- == 0) {
+            cpu_set_t one;
+            CPU_ZERO(&one);
+            CPU_SET(cpu, &one);
+            pthread_setaffinity_np(thread, sizeof(one), &one);
+            return;
+        }
+    }
+#else
+    (void)thread;
+    (void)index;
+#endif
+}
+
+/**
+ * Starts a pool with nworkers threads (0 is valid: the caller does all the work).
+ *
+ * @param pool Pointer to caller-allocated pool
+ * @param nworkers Number of worker threads to start
+ * @param pin Nonzero to pin each worker to its own CPU, in the order of the
+ *            CPUs the process may use, skipping the first (left to the thread
+ *            calling run_task_pool), so consecutive workers share a NUMA node
+ *            and stay there; ignored unless built on Linux with _GNU_SOURCE
+ * @return 1 on success, 0 if memory could not be obtained
+ */
+static inline int init_task_pool(TaskPool* pool, size_t nworkers, int pin) {
+    if (nworkers > ((size_t)-1 / sizeof(TaskDeque)) - 1) {
+        return 0;
+    }
+    pool->ndeques = pool->deques_cap = nworkers + 1;
+    pool->threads_cap = nworkers;
+    pool->deques = allocate(NULL, pool->deques_cap * sizeof(TaskDeque), _Alignof(TaskDeque));
+    pool->threads = nworkers ? allocate(NULL, pool->threads_cap * sizeof(pthread_t), 0) : NULL;
+    if (pool->deques == NULL || (nworkers && pool->threads == NULL)) {
+        deallocate(NULL, pool->deques, pool->deques_cap * sizeof(TaskDeque));
+        deallocate(NULL, pool->threads, pool->threads_cap * sizeof(pthread_t));
+        return 0;
+    }
+    for (size_t i = 0; i < pool->ndeques; ++i) {
+        atomic_init(&pool->deques[i].top, 0);
+        atomic_init(&pool->deques[i].bottom, 0);
+        pool->deques[i].rng = 0x9e3779b97f4a7c15u * (i + 1);
+    }
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_mutex_init(&pool->run_lock, NULL);
+    pthread_cond_init(&pool->wake, NULL);
+    atomic_init(&pool->running, 0);
+    pool->shutdown = 0;
+
+    for (pool->nworkers = 0; pool->nworkers < nworkers; ++pool->nworkers) {
+        TaskPoolWorker* worker = allocate(NULL, sizeof(*worker), 0);
+        if (worker == NULL) {
+            break;   /* Run with the workers we have */
+        }
+        worker->pool = pool;
+        worker->index = pool->nworkers + 1;
+        if (pthread_create(&pool->threads[pool->nworkers], NULL, task_pool_worker, worker) != 0) {
+            deallocate(NULL, worker, sizeof(*worker));
+            break;
+        }
+        if (pin) {
+            pin_task_pool_worker(pool->threads[pool->nworkers], pool->nworkers + 1);
+        }
+    }
+    /* Deques of workers that did not start would never be drained (they stay allocated) */
+    pool->ndeques = pool->nworkers + 1;
+    return 1;
+}
+
+/**
+ * Starts a group with no tasks, before the first spawn into it.
+ */
+static inline void init_task_group(TaskGroup* group) {
+    atomic_init(&group->pending, 0);
+}
+
+/**
+ * Spawns fn(pool, ctx) as a task of group, to be run by this thread or
+ * stolen by another. Call from inside a run (a task, or the function passed
+ * to run_task_pool); elsewhere, or when the deque is full, the task runs
+ * immediately on the calling thread.
+ *
+ * @param pool Pointer to the pool
+ * @param group Group the task is joined with
+ * @param task Storage for the task, valid until the group is joined
+ * @param fn Task body
+ * @param ctx Opaque state for fn, valid until the group is joined
+ */
+static inline void spawn_task_pool(TaskPool* pool, TaskGroup* group, Task* task, TaskFn fn, void* ctx) {
+    task->fn = fn;
+    task->ctx = ctx;
+    task->group = group;
+    atomic_fetch_add_explicit(&group->pending, 1, memory_order_relaxed);
+    if (task_pool_current != pool || !push_task_deque(&pool->deques[task_pool_current_index], task)) {
+        execute_task_pool(pool, task);
+    }
+}
+
+/**
+ * Waits until every task spawned into group has finished, running other
+ * tasks (its own first) in the meantime.
+ *
+ * @param pool Pointer to the pool
+ * @param group Group to join
+ */
+static inline void join_task_pool(TaskPool* pool, TaskGroup* group) {
+    unsigned misses = 0;
+    while (atomic_load_explicit(&group->pending, memory_order_acquire) != 0) {
+        Task* task = task_pool_current == pool ? find_task_pool(pool, task_pool_current_index) : NULL;
+        if (task != NULL) {
+            execute_task_pool(pool, task);
+            misses = 0;
+        } else {
+            idle_task_pool(&misses);
+        }
+    }
+}
+
+/**
+ * Runs fn(pool, ctx) as the root of a fork/join computation and returns when
+ * it has returned. fn spawns and joins its subtasks; the workers help from
+ * the start of the run. Independent callers (other threads, or tasks of a
+ * different pool) are serialized on run_lock and wait for the current run
+ * to finish; only a nested call from a task of this pool runs fn in place.
+ *
+ * @param pool Pointer to the pool
+ * @param fn Root function
+ * @param ctx Opaque state for fn
+ */
+static inline void run_task_pool(TaskPool* pool, TaskFn fn, void* ctx) {
+    if (task_pool_current == pool) {
+        fn(pool, ctx);
+        return;
+    }
+    TaskPool* outer = task_pool_current;
+    size_t outer_index = task_pool_current_index;
+
+    pthread_mutex_lock(&pool->run_lock);
+    task_pool_current = pool;
+    task_pool_current_index = 0;
+    pthread_mutex_lock(&pool->lock);
+    atomic_store_explicit(&pool->running, 1, memory_order_relaxed);
+    pthread_cond_broadcast(&pool->wake);
+    pthread_mutex_unlock(&pool->lock);
+
+    fn(pool, ctx);
+
+    /* Every task was joined inside fn, so the deques are empty again */
+    atomic_store_explicit(&pool->running, 0, memory_order_relaxed);
+    task_pool_current = outer;
+    task_pool_current_index = outer_index;
+    pthread_mutex_unlock(&pool->run_lock);
+}
+
+/**
+ * Range callback for parallel_for_task_pool: processes elements [first, last).
+ */
+typedef void (*ArrayRangeFn)(DynArray* array, size_t first, size_t last, void* ctx);
+
+/**
+ * One range of a parallel_for_task_pool call.
+ */
+typedef struct {
+    DynArray* array;
+    size_t first;
+    size_t last;
+    size_t grain;
+    ArrayRangeFn fn;
+    void* ctx;
+} ArrayRangeJob;
+
+/**
+ * Splits the range in halves until it is at most grain elements, spawning
+ * the upper half each time and continuing with the lower one.
+ */
+static inline void run_array_range(TaskPool* pool, void* arg) {
+    ArrayRangeJob job = *(ArrayRangeJob*)arg;
+    if (job.last - job.first <= job.grain) {
+        job.fn(job.array, job.first, job.last, job.ctx);
+        return;
+    }
+    ArrayRangeJob upper = job;
+    upper.first = job.first + (job.last - job.first) / 2;
+    job.last = upper.first;
+
+    TaskGroup group;
+    Task task;
+    init_task_group(&group);
+    spawn_task_pool(pool, &group, &task, run_array_range, &upper);
+    run_array_range(pool, &job);
+    join_task_pool(pool, &group);
+}
+
+/**
+ * Calls fn on disjoint index ranges covering [0, array->count), in parallel.
+ * Ranges are split recursively and stolen by idle workers, so uneven work
+ * balances itself. May be called from inside a task.
+ *
+ * @param pool Pointer to the pool
+ * @param array Pointer to the dynamic array (must not be resized meanwhile)
+ * @param grain Largest range per call (0 = about eight ranges per thread,
+ *              at least TASK_POOL_MIN_GRAIN elements)
+ * @param fn Range callback; called concurrently
+ * @param ctx Opaque caller state passed to every call
+ */
+static inline void parallel_for_task_pool(TaskPool* pool, DynArray* array, size_t grain, ArrayRangeFn fn, void* ctx) {
+    if (array->count == 0) {
+        return;
+    }
+    if (grain == 0) {
+        grain = array->count / (pool->ndeques * 8);
+        if (grain < TASK_POOL_MIN_GRAIN) {
+            grain = TASK_POOL_MIN_GRAIN;
+        }
+    }
+    ArrayRangeJob job = {array, 0, array->count, grain, fn, ctx};
+    run_task_pool(pool, run_array_range, &job);
+}
+
+/**
+ * A batch of list segments found by the walker in process_list_task_pool.
+ */
+typedef struct {
+    IntNode* heads[TASK_LIST_BATCH];  /* First node of each segment */
+    size_t first;                     /* Segments [first, last) of heads to process */
+    size_t last;
+    NodeFn nfn;
+} ListSegmentJob;
+
+/**
+ * Processes a run of segments, splitting it in halves so the segments spread over the workers.
+ */
+static inline void run_list_segments(TaskPool* pool, void* arg) {
+    ListSegmentJob* job = arg;
+    if (job->last - job->first == 1) {
+        IntNode* node = job->heads[job->first];
+        for (size_t i = 0; i < TASK_LIST_SEGMENT && node != NULL; ++i) {
+            IntNode* next = node->next;
+            job->nfn(node);
+            node = next;
+        }
+        return;
+    }
+    ListSegmentJob upper = *job;
+    ListSegmentJob lower = *job;
+    upper.first = job->first + (job->last - job->first) / 2;
+    lower.last = upper.first;
+
+    TaskGroup group;
+    Task task;
+    init_task_group(&group);
+    spawn_task_pool(pool, &group, &task, run_list_segments, &upper);
+    run_list_segments(pool, &lower);
+    join_task_pool(pool, &group);
+}
+
+/**
+ * Root of process_list_task_pool: walks ahead one batch of segment heads at
+ * a time and processes each batch as a task while walking the next, so the
+ * sequential pointer chase overlaps with the parallel work.
+ */
+static inline void run_list_walk(TaskPool* pool, void* arg) {
+    ListSegmentJob* jobs = arg;   /* Two batches, alternating */
+    IntNode* node = jobs[0].heads[0];
+    TaskGroup group;
+    Task task;
+    init_task_group(&group);
+    for (size_t b = 0; node != NULL; b ^= 1) {
+        ListSegmentJob* job = &jobs[b];
+        job->first = 0;
+        job->last = 0;
+        while (node != NULL && job->last < TASK_LIST_BATCH) {
+            job->heads[job->last++] = node;
+            for (size_t i = 0; i < TASK_LIST_SEGMENT && node != NULL; ++i) {
+                node = node->next;
+            }
+        }
+        /* The previous batch must finish before its job is refilled next round */
+        join_task_pool(pool, &group);
+        spawn_task_pool(pool, &group, &task, run_list_segments, job);
+    }
+    join_task_pool(pool, &group);
+}
+
+/**
+ * Parallel process_list: calls nfn on every node. Unlike
+ * parallel_process_list in parallel.h, segments are processed while the list
+ * is still being walked, and no segment table is allocated.
+ * Nodes are visited in an unspecified order.
+ *
+ * @param pool Pointer to the pool
+ * @param node Starting node for the walk (NULL for an empty list)
+ * @param nfn Function to apply to each node; called concurrently,
+ *            must not change next pointers
+ */
+static inline void process_list_task_pool(TaskPool* pool, IntNode* node, NodeFn nfn) {
+    if (node == NULL) {
+        return;
+    }
+    ListSegmentJob jobs[2];
+    jobs[0].heads[0] = node;
+    jobs[0].nfn = nfn;
+    jobs[1].nfn = nfn;
+    run_task_pool(pool, run_list_walk, jobs);
+}
+
+/**
+ * Stops and joins all workers and releases the pool's resources.
+ *
+ * @param pool Pointer to the pool, must be idle
+ */
+static inline void free_task_pool(TaskPool* pool) {
+    pthread_mutex_lock(&pool->lock);
+    pool->shutdown = 1;
+    pthread_cond_broadcast(&pool->wake);
+    pthread_mutex_unlock(&pool->lock);
+
+    for (size_t i = 0; i < pool->nworkers; ++i) {
+        pthread_join(pool->threads[i], NULL);
+    }
+    deallocate(NULL, pool->threads, pool->threads_cap * sizeof(pthread_t));
+    deallocate(NULL, pool->deques, pool->deques_cap * sizeof(TaskDeque));
+    pool->threads = NULL;
+    pool->deques = NULL;
+    pool->nworkers = pool->threads_cap = 0;
+    pool->ndeques = pool->deques_cap = 0;
+
+    pthread_cond_destroy(&pool->wake);
+    pthread_mutex_destroy(&pool->lock);
+    pthread_mutex_destroy(&pool->run_lock);
+}
+
+#endif /* DS_TASK_POOL_H */
@@ -0,0 +1,264 @@
+/*
+ * Minimal Thread Pool
+ *
+ * A fixed set of worker threads that run one batch of numbered tasks at a
+ * time: run_thread_pool(pool, fn, ctx, ntasks, nthreads) calls fn(ctx, i) for
+ * every i in [0, ntasks) using up to nthreads threads (the caller included)
+ * and returns when all tasks are done. Tasks are handed out through an atomic
+ * counter, so uneven tasks balance themselves across threads.
+ *
+ * Workers sleep on a condition variable between batches, so an idle pool
+ * costs nothing. Batches from different threads are serialized; a task that
+ * starts a batch on its own pool runs that batch inline instead of waiting
+ * for the one it is part of.
+ *
+ * Requires POSIX threads and C11 atomics.
+ */
+
+#ifndef DS_THREAD_POOL_H
+#define DS_THREAD_POOL_H
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "allocator.h"
+
+/**
+ * Task callback: runs task number task of the current batch.
+ */
+typedef void (*PoolTaskFn)(void* ctx, size_t task);
+
+/**
+ * Thread pool state. All batch fields are protected by lock except the
+ * atomic counters, which the task loop uses without locking.
+ */
+typedef struct {
+    pthread_t* threads;        /* Worker threads */
+    size_t nworkers;           /* Number of worker threads */
+    size_t threads_cap;        /* Number of entries allocated in threads */
+    pthread_mutex_t lock;      /* Protects the batch fields and the condition variables */
+    pthread_cond_t wake;       /* Signalled when a batch starts or the pool shuts down */
+    pthread_cond_t done;       /* Signalled when the last participant of a batch finishes */
+    pthread_mutex_t run_lock;  /* Serializes run_thread_pool callers */
+    unsigned long generation;  /* Incremented for every batch */
+    int shutdown;              /* Set by free_thread_pool */
+
+    /* Current batch */
+    PoolTaskFn fn;
+    void* ctx;
+    size_t ntasks;
+    atomic_size_t next_task;   /* Next task number to hand out */
+    atomic_int seats;          /* Workers still allowed to join the batch */
+    size_t active;             /* Participants that have not finished yet (under lock) */
+} ThreadPool;
+
+/* Pool whose batch the calling thread takes part in, NULL otherwise. Weak, so all translation units share it. */
+__attribute__((weak)) _Thread_local ThreadPool* thread_pool_current;
+
+/**
+ * Claims and runs tasks of the current batch until none are left.
+ */
+static inline void drain_thread_pool(ThreadPool* pool) {
+    for (;;) {
+        size_t task = atomic_fetch_add_explicit(&pool->next_task, 1, memory_order_relaxed);
+        if (task >= pool->ntasks) {
+            return;
+        }
+        pool->fn(pool->ctx, task);
+    }
+}
+
+static inline void* thread_pool_worker(void* arg) {
+    ThreadPool* pool = arg;
+    unsigned long seen = 0;
+    thread_pool_current = pool;
+
+    pthread_mutex_lock(&pool->lock);
+    for (;;) {
+        while (!pool->shutdown && pool->generation == seen) {
+            pthread_cond_wait(&pool->wake, &pool->lock);
+        }
+        if (pool->shutdown) {
+            break;
+        }
+        seen = pool->generation;
+
+        /* Join the batch only if it still has a seat for us */
+        if (atomic_fetch_sub_explicit(&pool->seats, 1, memory_order_relaxed) <= 0) {
+            continue;
+        }
+        pool->active++;
+        pthread_mutex_unlock(&pool->lock);
+
+        drain_thread_pool(pool);
+
+        pthread_mutex_lock(&pool->lock);
+        if (--pool->active == 0) {
+            pthread_cond_signal(&pool->done);
+        }
+    }
+    pthread_mutex_unlock(&pool->lock);
+    return NULL;
+}
+
+/**
+ * Starts a pool with nworkers threads (0 is valid: the caller does all the work).
+ *
+ * @param pool Pointer to caller-allocated pool
+ * @param nworkers Number of worker threads to start
+ * @return 1 on success, 0 if memory or threads could not be obtained
+ */
+static inline int init_thread_pool(ThreadPool* pool, size_t nworkers) {
+    pool->threads = nworkers ? allocate(NULL, nworkers * sizeof(pthread_t), 0) : NULL;
+    if (nworkers && pool->threads == NULL) {
+        return 0;
+    }
+    pool->threads_cap = nworkers;
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_mutex_init(&pool->run_lock, NULL);
+    pthread_cond_init(&pool->wake, NULL);
+    pthread_cond_init(&pool->done, NULL);
+    pool->generation = 0;
+    pool->shutdown = 0;
+    pool->fn = NULL;
+    pool->ctx = NULL;
+    pool->ntasks = 0;
+    atomic_init(&pool->next_task, 0);
+    atomic_init(&pool->seats, 0);
+    pool->active = 0;
+
+    for (pool->nworkers = 0; pool->nworkers < nworkers; ++pool->nworkers) {
+        if (pthread_create(&pool->threads[pool->nworkers], NULL, thread_pool_worker, pool) != 0) {
+            break;   /* Run with the workers we have */
+        }
+    }
+    return 1;
+}
+
+/**
+ * Adds workers until the pool has nworkers of them. Safe to call while
+ * other threads use the pool; new workers join from the next batch on.
+ * Called from a task of this pool it cannot add workers (that would wait
+ * for the enclosing batch) and returns 0 if more were wanted.
+ *
+ * @param pool Pointer to the pool
+ * @param nworkers Number of worker threads wanted
+ * @return 1 if the pool now has nworkers workers, 0 if memory or threads ran out
+ *         (the pool keeps the workers it has)
+ */
+static inline int grow_thread_pool(ThreadPool* pool, size_t nworkers) {
+    if (thread_pool_current == pool) {
+        return nworkers <= pool->nworkers;
+    }
+    pthread_mutex_lock(&pool->run_lock);
+    if (nworkers <= pool->nworkers) {
+        pthread_mutex_unlock(&pool->run_lock);
+        return 1;
+    }
+    pthread_t* threads = nworkers <= (size_t)-1 / sizeof(pthread_t)
+                             ? allocate(NULL, nworkers * sizeof(pthread_t), 0) : NULL;
+    if (threads == NULL) {
+        pthread_mutex_unlock(&pool->run_lock);
+        return 0;
+    }
+    if (pool->nworkers > 0) {
+        memcpy(threads, pool->threads, pool->nworkers * sizeof(pthread_t));
+    }
+    deallocate(NULL, pool->threads, pool->threads_cap * sizeof(pthread_t));
+    pool->threads = threads;
+    pool->threads_cap = nworkers;
+
+    while (pool->nworkers < nworkers &&
+           pthread_create(&pool->threads[pool->nworkers], NULL, thread_pool_worker, pool) == 0) {
+        pool->nworkers++;
+    }
+    int grown = pool->nworkers == nworkers;
+    pthread_mutex_unlock(&pool->run_lock);
+    return grown;
+}
+
+/**
+ * Runs fn(ctx, i) for every i in [0, ntasks) and waits for all of them.
+ * Called from a task of the same pool, the batch runs on the calling thread:
+ * the pool is busy with the enclosing batch, which cannot finish before it.
+ *
+ * @param pool Pointer to the pool
+ * @param fn Task callback, called concurrently from several threads
+ * @param ctx Opaque caller state passed to every call
+ * @param ntasks Number of tasks in the batch
+ * @param nthreads Maximum number of threads to use, including the caller (0 = all)
+ */
+static inline void run_thread_pool(ThreadPool* pool, PoolTaskFn fn, void* ctx, size_t ntasks, size_t nthreads) {
+    if (ntasks == 0) {
+        return;
+    }
+    if (thread_pool_current == pool) {
+        for (size_t task = 0; task < ntasks; ++task) {
+            fn(ctx, task);
+        }
+        return;
+    }
+    ThreadPool* outer = thread_pool_current;
+
+    pthread_mutex_lock(&pool->run_lock);
+    thread_pool_current = pool;
+    /* nworkers only changes under run_lock (grow_thread_pool) */
+    size_t helpers = nthreads == 0 || nthreads - 1 > pool->nworkers ? pool->nworkers : nthreads - 1;
+    if (helpers > ntasks - 1) {
+        helpers = ntasks - 1;
+    }
+    pthread_mutex_lock(&pool->lock);
+    pool->fn = fn;
+    pool->ctx = ctx;
+    pool->ntasks = ntasks;
+    atomic_store_explicit(&pool->next_task, 0, memory_order_relaxed);
+    atomic_store_explicit(&pool->seats, (int)helpers, memory_order_relaxed);
+    pool->active = 1;   /* The caller */
+    pool->generation++;
+    if (helpers > 0) {
+        pthread_cond_broadcast(&pool->wake);
+    }
+    pthread_mutex_unlock(&pool->lock);
+
+    drain_thread_pool(pool);
+
+    pthread_mutex_lock(&pool->lock);
+    pool->active--;
+    while (pool->active > 0) {
+        pthread_cond_wait(&pool->done, &pool->lock);
+    }
+    /* Close the batch so late wakers do not join it */
+    atomic_store_explicit(&pool->seats, 0, memory_order_relaxed);
+    pthread_mutex_unlock(&pool->lock);
+    thread_pool_current = outer;
+    pthread_mutex_unlock(&pool->run_lock);
+}
+
+/**
+ * Stops and joins all workers and releases the pool's resources.
+ *
+ * @param pool Pointer to the pool, must be idle
+ */
+static inline void free_thread_pool(ThreadPool* pool) {
+    pthread_mutex_lock(&pool->lock);
+    pool->shutdown = 1;
+    pthread_cond_broadcast(&pool->wake);
+    pthread_mutex_unlock(&pool->lock);
+
+    for (size_t i = 0; i < pool->nworkers; ++i) {
+        pthread_join(pool->threads[i], NULL);
+    }
+    deallocate(NULL, pool->threads, pool->threads_cap * sizeof(pthread_t));
+    pool->threads = NULL;
+    pool->nworkers = 0;
+    pool->threads_cap = 0;
+
+    pthread_cond_destroy(&pool->wake);
+    pthread_cond_destroy(&pool->done);
+    pthread_mutex_destroy(&pool->lock);
+    pthread_mutex_destroy(&pool->run_lock);
+}
+
+#endif /* DS_THREAD_POOL_H */
@@ -0,0 +1,26 @@
+/*
+ * Example record type shared by the demos and benchmarks.
+ */
+
+#ifndef DS_USER_H
+#define DS_USER_H
+
+#include "dyn_array.h"
+
+/* Capacity of User.name, including the terminating NUL */
+#define USER_NAME_LEN 50
+
+/**
+ * Simple user structure to demonstrate storing complex types.
+ * The fixed-size character array avoids dynamic memory allocation
+ * for the name, simplifying memory management.
+ */
+typedef struct {
+    char name[USER_NAME_LEN];  /* Fixed-size array for name storage */
+    short id;                  /* Unique identifier */
+} User;
+
+/* Typed array of User: UserArray, UserArray_push, UserArray_at, ... */
+DEFINE_DYN_ARRAY(User)
+
+#endif /* DS_USER_H */
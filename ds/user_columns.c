@@ -0,0 +1,61 @@
+/*
+ * Struct-of-Arrays Example
+ *
+ * This file demonstrates converting an array of User structs into separate
+ * id and name columns and back. The implementation supports:
+ *
+ * - Pushing users into column storage
+ * - Scanning a single column (ids) without touching the others
+ * - Converting to and from a DynArray of User
+ *
+ * Key concepts demonstrated:
+ * - Struct-of-arrays vs array-of-structs layout
+ * - Reducing memory traffic of scans by splitting hot and cold fields
+ * - Pointers to fixed-size arrays (char (*)[N]) for a column of strings
+ */
+
+#include <stdio.h>
+
+#include "dyn_array.h"
+#include "user.h"
+#include "user_columns.h"
+
+int main(void) {
+    User user1 = {"meg", 1};
+    User user2 = {"bobo", 2};
+    User user3 = {"rigby", 3};
+
+    /* Start from an array of structs */
+    DynArray array;
+    new_dyn_array(sizeof(User), &array);
+    push_dyn_array(&array, &user1);
+    push_dyn_array(&array, &user2);
+
+    /* Convert to columns and keep pushing there */
+    UserColumns columns;
+    init_user_columns(&columns, NULL);
+    append_dyn_array_to_user_columns(&columns, &array);
+    push_user_columns(&columns, &user3);
+
+    /* The id lookup only reads the ids column */
+    size_t idx = find_id_user_columns(&columns, 3);
+    if (idx < columns.count) {
+        User found;
+        get_user_columns(&columns, idx, &found);
+        printf("Found id 3 at row %zu, name: %s\n", idx, found.name);
+    }
+
+    /* And back to an array of structs */
+    DynArray back;
+    new_dyn_array(sizeof(User), &back);
+    append_user_columns_to_dyn_array(&back, &columns);
+    for (size_t i = 0; i < back.count; ++i) {
+        User* user = (User*)back.items + i;
+        printf("Index: [%zu], name: %s, id: %d\n", i, user->name, user->id);
+    }
+
+    free_dyn_array(&back);
+    free_user_columns(&columns);
+    free_dyn_array(&array);
+    return 0;
+}
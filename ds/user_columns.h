@@ -0,0 +1,214 @@
+/*
+ * Struct-of-Arrays Container for User Records
+ *
+ * Stores the fields of User in separate contiguous arrays instead of one
+ * array of structs. A scan over ids then touches 2 bytes per user instead of
+ * the 52-byte User (and its padding), so id filters and lookups pull roughly
+ * 25x less memory through the cache. Names are only touched when needed.
+ */
+
+#ifndef DS_USER_COLUMNS_H
+#define DS_USER_COLUMNS_H
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "allocator.h"
+#include "dyn_array.h"
+#include "simd_search.h"
+#include "user.h"
+
+/**
+ * Column-wise storage of User records. Row i is (names[i], ids[i]).
+ */
+typedef struct {
+    short* ids;                   /* Contiguous id column */
+    char (*names)[USER_NAME_LEN]; /* Contiguous name column, one fixed-size slot per row */
+    size_t count;                 /* Number of rows currently stored */
+    size_t cap;                   /* Rows both columns have room for */
+    size_t ids_cap;               /* Rows the id column has room for, >= cap after a failed reserve */
+    const Allocator* allocator;   /* Where the columns come from, NULL for the C library */
+} UserColumns;
+
+/**
+ * Initializes an empty container. No memory is allocated until the first push.
+ *
+ * @param columns Pointer to caller-allocated UserColumns
+ * @param allocator Allocator for the columns, or NULL for the C library
+ */
+static inline void init_user_columns(UserColumns* columns, const Allocator* allocator) {
+    columns->ids = NULL;
+    columns->names = NULL;
+    columns->count = 0;
+    columns->cap = 0;
+    columns->ids_cap = 0;
+    columns->allocator = allocator;
+}
+
+/**
+ * Ensures both columns can hold at least min_cap rows.
+ *
+ * @param columns Pointer to the container
+ * @param min_cap Minimum capacity (in rows)
+ * @return 1 on success, 0 if the allocation failed (the rows are unchanged)
+ */
+static inline int reserve_user_columns(UserColumns* columns, size_t min_cap) {
+    if (min_cap <= columns->cap) {
+        return 1;
+    }
+    if (min_cap > (size_t)-1 / USER_NAME_LEN) {
+        return 0;
+    }
+
+    if (columns->ids_cap < min_cap) {
+        short* ids = reallocate(columns->allocator, columns->ids,
+                                columns->ids_cap * sizeof(short), min_cap * sizeof(short));
+        if (ids == NULL) {
+            return 0;
+        }
+        columns->ids = ids;
+        columns->ids_cap = min_cap;
+    }
+
+    /* If this fails the id column keeps its extra room (nothing to roll back) for the next attempt */
+    char (*names)[USER_NAME_LEN] = reallocate(columns->allocator, columns->names,
+                                              columns->cap * USER_NAME_LEN, min_cap * USER_NAME_LEN);
+    if (names == NULL) {
+        return 0;
+    }
+    columns->names = names;
+    columns->cap = min_cap;
+    return 1;
+}
+
+/**
+ * Appends a user, splitting it into the id and name columns.
+ * Mirrors push_dyn_array: the record is copied, capacity doubles as needed.
+ *
+ * @param columns Pointer to the container
+ * @param user Pointer to the user to add
+ * @return 1 on success, 0 if growing the columns failed
+ */
+static inline int push_user_columns(UserColumns* columns, const User* user) {
+    if (columns->count >= columns->cap &&
+        !reserve_user_columns(columns, columns->cap ? columns->cap * 2 : 2)) {
+        return 0;
+    }
+    columns->ids[columns->count] = user->id;
+    memcpy(columns->names[columns->count], user->name, USER_NAME_LEN);
+    columns->count++;
+    return 1;
+}
+
+/**
+ * Reassembles row idx into a User.
+ *
+ * @param columns Pointer to the container
+ * @param idx Row index, must be < count
+ * @param out Pointer where the user is written
+ */
+static inline void get_user_columns(const UserColumns* columns, size_t idx, User* out) {
+    out->id = columns->ids[idx];
+    memcpy(out->name, columns->names[idx], USER_NAME_LEN);
+}
+
+/**
+ * Finds the first row with the given id, scanning only the id column (vectorized).
+ *
+ * @param columns Pointer to the container
+ * @param id Id to look for
+ * @return Row index, or columns->count if no row matches
+ */
+static inline size_t find_id_user_columns(const UserColumns* columns, short id) {
+    return find_first_short(columns->ids, columns->count, id);
+}
+
+/**
+ * Counts the rows with the given id, scanning only the id column (vectorized).
+ *
+ * @param columns Pointer to the container
+ * @param id Id to count
+ * @return Number of matching rows
+ */
+static inline size_t count_id_user_columns(const UserColumns* columns, short id) {
+    return count_if_equal_short(columns->ids, columns->count, id);
+}
+
+/**
+ * Appends the index of every row whose id is in [lo, hi] to out (vectorized).
+ *
+ * @param columns Pointer to the container
+ * @param lo Smallest matching id
+ * @param hi Largest matching id
+ * @param out DynArray of size_t elements receiving the row indices
+ * @return 1 on success, 0 if out does not hold size_t or growing it failed
+ */
+static inline int filter_ids_user_columns(const UserColumns* columns, short lo, short hi, DynArray* out) {
+    if (out->size != sizeof(size_t)) {
+        return 0;
+    }
+    return filter_into_short(columns->ids, columns->count, lo, hi, out);
+}
+
+/**
+ * Appends every User of a DynArray to the container, reserving once up front.
+ *
+ * @param columns Pointer to the container
+ * @param array Pointer to a DynArray of User elements
+ * @return 1 on success, 0 if the array does not hold Users or growing failed
+ */
+static inline int append_dyn_array_to_user_columns(UserColumns* columns, const DynArray* array) {
+    if (array->size != sizeof(User)) {
+        return 0;
+    }
+    if (array->count > (size_t)-1 - columns->count ||
+        !reserve_user_columns(columns, columns->count + array->count)) {
+        return 0;
+    }
+    const User* users = array->items;
+    for (size_t i = 0; i < array->count; ++i) {
+        columns->ids[columns->count + i] = users[i].id;
+        memcpy(columns->names[columns->count + i], users[i].name, USER_NAME_LEN);
+    }
+    columns->count += array->count;
+    return 1;
+}
+
+/**
+ * Appends every row of the container to a DynArray of User, growing it at most once.
+ *
+ * @param array Pointer to a DynArray of User elements
+ * @param columns Pointer to the container
+ * @return 1 on success, 0 if the array does not hold Users or growing failed
+ */
+static inline int append_user_columns_to_dyn_array(DynArray* array, const UserColumns* columns) {
+    if (array->size != sizeof(User)) {
+        return 0;
+    }
+    if (!grow_for_dyn_array(array, columns->count)) {
+        return 0;
+    }
+    User* users = (User*)array->items + array->count;
+    for (size_t i = 0; i < columns->count; ++i) {
+        get_user_columns(columns, i, &users[i]);
+    }
+    array->count += columns->count;
+    return 1;
+}
+
+/**
+ * Releases both columns and resets the container to empty.
+ *
+ * @param columns Pointer to the container
+ */
+static inline void free_user_columns(UserColumns* columns) {
+    deallocate(columns->allocator, columns->ids, columns->ids_cap * sizeof(short));
+    deallocate(columns->allocator, columns->names, columns->cap * USER_NAME_LEN);
+    columns->ids = NULL;
+    columns->names = NULL;
+    columns->count = 0;
+    columns->cap = 0;
+    columns->ids_cap = 0;
+}
+
+#endif /* DS_USER_COLUMNS_H */
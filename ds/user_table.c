@@ -0,0 +1,60 @@
+/*
+ * Compact User Table Example
+ *
+ * This file demonstrates storing users as small fixed-size records whose
+ * names live in a shared string arena. The implementation supports:
+ *
+ * - Names of any length, stored once each with interning
+ * - 12-byte records in a DynArray instead of 52-byte User structs
+ * - Lookups by id that never touch the name bytes
+ * - Converting to and from User
+ *
+ * Key concepts demonstrated:
+ * - Offset + length handles instead of pointers, so growth never invalidates them
+ * - Interning with an open-addressing table checked against the stored bytes
+ * - Separating hot fixed-size fields from cold variable-size data
+ */
+
+#include <stdio.h>
+
+#include "user_table.h"
+
+int main(void) {
+    UserTable table;
+    init_user_table(&table, 1, NULL);
+
+    const char* names[] = {"meg", "alexandria-montgomery-fitzgerald-worthington-the-third", "bob", "meg", "bob", "ann"};
+    for (size_t i = 0; i < sizeof(names) / sizeof(names[0]); ++i) {
+        push_user_table(&table, names[i], strlen(names[i]), (short)(100 + i));
+    }
+
+    /* Bulk import from a DynArray of User */
+    DynArray users;
+    new_dyn_array(sizeof(User), &users);
+    User legacy[] = {{"meg", 200}, {"zoe", 201}, {"ann", 202}};
+    push_many_dyn_array(&users, legacy, 3);
+    append_dyn_array_to_user_table(&table, &users);
+    free_dyn_array(&users);
+
+    for (size_t i = 0; i < count_user_table(&table); ++i) {
+        const CompactUser* user = at_user_table(&table, i);
+        printf("User %d: %s (name at offset %u)\n", user->id, name_user_table(&table, i), (unsigned)user->name.offset);
+    }
+
+    printf("Record size: %zu bytes (User: %zu bytes)\n", sizeof(CompactUser), sizeof(User));
+    printf("%zu users, %zu distinct names, %zu bytes of names\n",
+           count_user_table(&table), table.names.interned, table.names.bytes.count);
+
+    size_t row = find_id_user_table(&table, 201);
+    printf("Id 201 is %s\n", row != USER_TABLE_NOT_FOUND ? name_user_table(&table, row) : "missing");
+    row = find_name_user_table(&table, "ann");
+    printf("First ann has id %d\n", row != USER_TABLE_NOT_FOUND ? at_user_table(&table, row)->id : -1);
+
+    /* Back to a fixed-size User: long names are truncated to fit */
+    User out;
+    get_user_table(&table, 1, &out);
+    printf("As User: %s (%d)\n", out.name, out.id);
+
+    free_user_table(&table);
+    return 0;
+}
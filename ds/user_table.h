@@ -0,0 +1,219 @@
+/*
+ * Compact User Table with Arena-Backed Names
+ *
+ * Stores users as 12-byte CompactUser records in a DynArray, with names kept
+ * out of line in a StringArena. A short name like "meg" costs 4 bytes of
+ * arena instead of a 50-byte slot, long names are not truncated, and a scan
+ * over the records moves about a quarter of the memory a DynArray of User
+ * does (12 bytes per record instead of 52). With interning enabled, repeated
+ * names are stored once.
+ */
+
+#ifndef DS_USER_TABLE_H
+#define DS_USER_TABLE_H
+
+#include <stddef.h>
+#include <string.h>
+
+#include "allocator.h"
+#include "dyn_array.h"
+#include "string_arena.h"
+#include "user.h"
+
+#define USER_TABLE_NOT_FOUND ((size_t)-1)
+
+/**
+ * User record with its name in the table's arena.
+ */
+typedef struct {
+    StringRef name;  /* Name in UserTable.names */
+    short id;        /* Unique identifier */
+} CompactUser;
+
+/**
+ * Table of users: compact records plus the arena their names live in.
+ */
+typedef struct {
+    DynArray users;     /* CompactUser records */
+    StringArena names;  /* Name bytes */
+    int intern;         /* Nonzero to store each distinct name once */
+} UserTable;
+
+/**
+ * Initializes an empty table. No memory is allocated until the first push.
+ *
+ * @param table Pointer to caller-allocated table
+ * @param intern Nonzero to deduplicate names
+ * @param allocator Allocator for the records and the arena, or NULL for the C library
+ */
+static inline void init_user_table(UserTable* table, int intern, const Allocator* allocator) {
+    DynArrayOptions options = DYN_ARRAY_DEFAULT_OPTIONS;
+    options.initial_cap = 0;
+    options.allocator = allocator;
+    init_dyn_array(sizeof(CompactUser), &options, &table->users);
+    init_string_arena(&table->names, allocator);
+    table->intern = intern;
+}
+
+/**
+ * Returns the record at idx.
+ *
+ * @param table Pointer to the table
+ * @param idx Row index, must be < count
+ * @return Pointer to the record, valid until the table grows
+ */
+static inline CompactUser* at_user_table(const UserTable* table, size_t idx) {
+    return (CompactUser*)table->users.items + idx;
+}
+
+/**
+ * Appends a user.
+ *
+ * @param table Pointer to the table
+ * @param name Name characters (need not be NUL-terminated)
+ * @param len Length of the name in bytes
+ * @param id Id of the user
+ * @return 1 on success, 0 if the records or the arena could not grow
+ */
+static inline int push_user_table(UserTable* table, const char* name, size_t len, short id) {
+    /* Make room for the record first, so a failure leaves no orphaned name */
+    if (!grow_for_dyn_array(&table->users, 1)) {
+        return 0;
+    }
+    CompactUser user;
+    user.id = id;
+    int stored = table->intern ? intern_string_arena(&table->names, name, len, &user.name)
+                               : add_string_arena(&table->names, name, len, &user.name);
+    if (!stored) {
+        return 0;
+    }
+    *at_user_table(table, table->users.count++) = user;
+    return 1;
+}
+
+/**
+ * Appends a User, copying its NUL-terminated name into the arena.
+ *
+ * @param table Pointer to the table
+ * @param user Pointer to the user to add
+ * @return 1 on success, 0 if the records or the arena could not grow
+ */
+static inline int push_user_to_user_table(UserTable* table, const User* user) {
+    const char* end = memchr(user->name, '\0', USER_NAME_LEN);
+    size_t len = end != NULL ? (size_t)(end - user->name) : USER_NAME_LEN;
+    return push_user_table(table, user->name, len, user->id);
+}
+
+/**
+ * Returns the name of row idx.
+ *
+ * @param table Pointer to the table
+ * @param idx Row index, must be < count
+ * @return NUL-terminated name, valid until the next push
+ */
+static inline const char* name_user_table(const UserTable* table, size_t idx) {
+    return str_string_arena(&table->names, at_user_table(table, idx)->name);
+}
+
+/**
+ * Reassembles row idx into a User. Names longer than USER_NAME_LEN - 1 bytes
+ * are truncated.
+ *
+ * @param table Pointer to the table
+ * @param idx Row index, must be < count
+ * @param out Pointer where the user is written
+ */
+static inline void get_user_table(const UserTable* table, size_t idx, User* out) {
+    const CompactUser* user = at_user_table(table, idx);
+    size_t len = user->name.len < USER_NAME_LEN - 1 ? user->name.len : USER_NAME_LEN - 1;
+    memcpy(out->name, str_string_arena(&table->names, user->name), len);
+    memset(out->name + len, 0, USER_NAME_LEN - len);
+    out->id = user->id;
+}
+
+/**
+ * Finds the first row with the given id, touching only the compact records.
+ *
+ * @param table Pointer to the table
+ * @param id Id to look for
+ * @return Row index, or USER_TABLE_NOT_FOUND if no row matches
+ */
+static inline size_t find_id_user_table(const UserTable* table, short id) {
+    const CompactUser* users = table->users.items;
+    for (size_t i = 0; i < table->users.count; ++i) {
+        if (users[i].id == id) {
+            return i;
+        }
+    }
+    return USER_TABLE_NOT_FOUND;
+}
+
+/**
+ * Finds the first row with the given name. With interning enabled the name
+ * is looked up once and rows are compared by ref, without touching the arena.
+ *
+ * @param table Pointer to the table
+ * @param name NUL-terminated name to look for
+ * @return Row index, or USER_TABLE_NOT_FOUND if no row matches
+ */
+static inline size_t find_name_user_table(const UserTable* table, const char* name) {
+    const CompactUser* users = table->users.items;
+    if (table->intern) {
+        StringRef ref;
+        if (!find_string_arena(&table->names, name, strlen(name), &ref)) {
+            return USER_TABLE_NOT_FOUND;
+        }
+        for (size_t i = 0; i < table->users.count; ++i) {
+            if (users[i].name.offset == ref.offset) {
+                return i;
+            }
+        }
+        return USER_TABLE_NOT_FOUND;
+    }
+    for (size_t i = 0; i < table->users.count; ++i) {
+        if (equals_string_arena(&table->names, users[i].name, name)) {
+            return i;
+        }
+    }
+    return USER_TABLE_NOT_FOUND;
+}
+
+/**
+ * Appends every User of a DynArray to the table, reserving the records once up front.
+ *
+ * @param table Pointer to the table
+ * @param array Pointer to a DynArray of User elements
+ * @return 1 on success, 0 if the array does not hold Users or growing failed
+ *         (the table then holds a prefix of the users)
+ */
+static inline int append_dyn_array_to_user_table(UserTable* table, const DynArray* array) {
+    if (array->size != sizeof(User) || !grow_for_dyn_array(&table->users, array->count)) {
+        return 0;
+    }
+    const User* users = array->items;
+    for (size_t i = 0; i < array->count; ++i) {
+        if (!push_user_to_user_table(table, &users[i])) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/**
+ * Returns the number of users in the table.
+ */
+static inline size_t count_user_table(const UserTable* table) {
+    return table->users.count;
+}
+
+/**
+ * Releases the records and the arena and resets the table to empty.
+ *
+ * @param table Pointer to the table
+ */
+static inline void free_user_table(UserTable* table) {
+    free_dyn_array(&table->users);
+    free_string_arena(&table->names);
+}
+
+#endif /* DS_USER_TABLE_H */
@@ -0,0 +1,73 @@
+/*
+ * Variable-Length Integer Encoding
+ *
+ * LEB128-style varints: 7 bits per byte, low bits first, high bit set on
+ * every byte but the last. Small values take one byte, a full 64-bit value
+ * takes VARINT_MAX_BYTES. Signed values go through zigzag encoding first
+ * (0, -1, 1, -2, ... map to 0, 1, 2, 3, ...) so small negative numbers,
+ * such as the deltas between neighbouring list values, stay short too.
+ */
+
+#ifndef DS_VARINT_H
+#define DS_VARINT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define VARINT_MAX_BYTES 10
+
+/**
+ * Maps a signed value to an unsigned one with small magnitudes first.
+ */
+static inline uint64_t zigzag_encode(int64_t value) {
+    return ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+}
+
+/**
+ * Inverse of zigzag_encode.
+ */
+static inline int64_t zigzag_decode(uint64_t value) {
+    return (int64_t)(value >> 1) ^ -(int64_t)(value & 1);
+}
+
+/**
+ * Writes value as a varint.
+ *
+ * @param out Destination, must have room for VARINT_MAX_BYTES
+ * @param value Value to encode
+ * @return Number of bytes written
+ */
+static inline size_t encode_varint(unsigned char* out, uint64_t value) {
+    size_t n = 0;
+    while (value >= 0x80) {
+        out[n++] = (unsigned char)(value | 0x80);
+        value >>= 7;
+    }
+    out[n++] = (unsigned char)value;
+    return n;
+}
+
+/**
+ * Reads one varint and advances *in past it.
+ *
+ * @param in Pointer to the read position, advanced on success
+ * @param end One past the last readable byte
+ * @param value Where the decoded value is stored
+ * @return 1 on success, 0 if the input is truncated or longer than VARINT_MAX_BYTES
+ */
+static inline int decode_varint(const unsigned char** in, const unsigned char* end, uint64_t* value) {
+    const unsigned char* p = *in;
+    uint64_t result = 0;
+    for (unsigned shift = 0; p < end && shift < 7 * VARINT_MAX_BYTES; shift += 7) {
+        unsigned char byte = *p++;
+        result |= (uint64_t)(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) {
+            *in = p;
+            *value = result;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+#endif /* DS_VARINT_H */